@@ -1,6 +1,26 @@
 #pragma once
 
 #include "shared.h"
+#include "geometry/geometry_buffer.h"
+#include "geometry/mesh_loader.h"
+#include "geometry/mesh_simplifier.h"
+#include "render/clustered_lighting.h"
+#include "render/dynamic_resolution.h"
+#include "render/occlusion_culler.h"
+#include "render/particle_system.h"
+#include "render/render_queue.h"
+#include "render/skinning_pass.h"
+#include "resource/frame_arena.h"
+#include "resource/heap_tracker.h"
+#include "scene/culling_system.h"
+#include "scene/instance_buffer.h"
+#include "scene/skeletal_animation.h"
+#include "scene/transform_system.h"
+#include "shader/layout_cache.h"
+#include "shader/pipeline_variants.h"
+#include "shader/shader_library.h"
+#include "shader/shader_watcher.h"
+#include "texture/texture_manager.h"
 #include "wrapper/glfw/window.h"
 #include "wrapper/vk/buffer.h"
 #include "wrapper/vk/command_buffer.h"
@@ -10,55 +30,30 @@
 #include "wrapper/vk/swap_chain.h"
 #define GLM_FORCE_RADIANS
 #include <chrono>
+#include <future>
+#include <random>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <stb_image.h>
 
 namespace eng {
 
-struct Vertex {
-    glm::vec2 pos;
-    glm::vec3 color;
-
-    static VkVertexInputBindingDescription getBindingDescription() {
-        VkVertexInputBindingDescription bindingDescription{
-            .binding = 0,
-            .stride = sizeof(Vertex),
-            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX};
-
-        return bindingDescription;
-    }
-
-    static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions() {
-        std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
-        attributeDescriptions[0].binding = 0;
-        attributeDescriptions[0].location = 0;
-        attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
-        attributeDescriptions[0].offset = offsetof(Vertex, pos);
-
-        attributeDescriptions[1].binding = 0;
-        attributeDescriptions[1].location = 1;
-        attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attributeDescriptions[1].offset = offsetof(Vertex, color);
-
-        return attributeDescriptions;
-    }
-};
+// meshes are drawn as encoded, position, normal, texture coordinate and color at
+// locations 0 to 3
+using Vertex = EncodedVertex;
 
 struct UniformBufferObject {
-    glm::mat4 model;
     glm::mat4 view;
     glm::mat4 proj;
+    ClusterParameters clusters;
+    glm::vec4 ambient;
 };
 
-const std::vector<Vertex> vertices = {
-    {{-0.5f, -0.5f}, {1.0f, 0.0f, 0.0f}},
-    {{0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}},
-    {{0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}},
-    {{-0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}}};
-
-const std::vector<uint16_t> indices = {
-    0, 1, 2, 2, 3, 0};
+// per draw data, pushed straight into the command buffer. the model matrix comes
+// per instance from the instance buffer.
+struct DrawConstants {
+    MeshDequantization dequantization;
+};
 
 class Application {
 public:
@@ -70,6 +65,34 @@ public:
 
 private:
     const int m_MAX_FRAMES_IN_FLIGHT = 2;
+    static constexpr const char* m_VERT_SHADER = "shaders/bin/default_vert.spv";
+    static constexpr const char* m_FRAG_SHADER = "shaders/bin/default_frag.spv";
+    static constexpr uint32_t m_TEXTURED_CONSTANT = 0;  // constant_id of TEXTURED in default.frag
+    static constexpr uint32_t m_GEOMETRY_VERTEX_CAPACITY = 1 << 20;
+    static constexpr uint32_t m_GEOMETRY_INDEX_CAPACITY = 1 << 22;
+    static constexpr uint32_t m_INSTANCE_CAPACITY = 1 << 16;
+    static constexpr uint32_t m_SCENE_GRID = 32;  // spheres per side
+    static constexpr float m_SCENE_SIZE = 4.0f;   // side of the grid, reaching past the view
+    static constexpr float m_OCCLUDER_SIZE = 1.5f;    // a still quad hovering over the middle of the grid
+    static constexpr float m_OCCLUDER_HEIGHT = 0.5f;
+    static constexpr float m_FIELD_OF_VIEW = 45.0f;  // vertical, in degrees
+    static constexpr float m_NEAR_PLANE = 0.1f;
+    static constexpr float m_FAR_PLANE = 10.0f;
+    static constexpr float m_LOD_PIXEL_ERRORS[] = {0.0f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f};  // cycled by ENGINE_LOD_BENCHMARK
+    static constexpr uint32_t m_LIGHT_CAPACITY = 1 << 14;
+    static constexpr uint32_t m_LIGHT_COUNTS[] = {10, 100, 1000, 10000};  // cycled by ENGINE_LIGHT_BENCHMARK
+    static constexpr float m_LIGHT_COVERAGE = 8.0f;  // lights reaching a point of the grid on average, whatever their count
+    static constexpr float m_LIGHT_INTENSITY = 0.5f;
+    static constexpr float m_AMBIENT = 0.1f;
+    static constexpr uint32_t m_PARTICLE_CAPACITY = 1 << 20;
+    static constexpr float m_PARTICLE_RATE = 100000.0f;  // per second, ENGINE_PARTICLE_RATE overrides it
+    static constexpr float m_PARTICLE_SIZE = 0.01f;
+    static constexpr uint32_t m_CHARACTER_COUNT = 256;  // ENGINE_CHARACTER_COUNT overrides it
+    static constexpr uint32_t m_TENTACLE_JOINTS = 8;
+    static constexpr float m_TENTACLE_HEIGHT = 0.3f;
+    static constexpr float m_TENTACLE_RADIUS = 0.02f;
+    static constexpr float m_GPU_BUDGET_MILLISECONDS = 16.0f;  // ENGINE_GPU_BUDGET_MS overrides it, ENGINE_RENDER_SCALE fixes the scale instead
+    static constexpr uint64_t m_STATS_REPORT_FRAMES = 600;  // with ENGINE_STATS or a benchmark running
     uint32_t m_currentFrame = 0;
 
     glfw::Window* m_window;
@@ -77,18 +100,89 @@ private:
     vk::PhysicalDevice* m_physicalDevice;
     vk::Device* m_device;
     vk::SwapChain* m_swapChain;
-
-    vk::Buffer *m_vertexBuffer, *m_indexBuffer;
+    AssetStore* m_assets;
+    ShaderLibrary* m_shaders;
+    MeshLoader* m_meshLoader;
+    ResidencyManager* m_residencyManager;
+
+    GeometryBuffer* m_geometry;
+    MeshRange m_quad;    // the occluder
+    MeshRange m_sphere;  // the grid, simplified into levels of detail
+
+    TransformSystem* m_transforms;
+    InstanceBuffer* m_instances;
+    TransformHandle m_sceneRoot;
+    TransformHandle m_firstSphere;
+    TransformHandle m_occluder;
+    CullingSystem* m_culling;
+    OcclusionCuller* m_occlusionCuller = nullptr;  // null without the device support or with ENGINE_NO_OCCLUSION_CULLING
+    RenderQueue* m_renderQueue;
+    FrameAllocator* m_frameAllocator;
+    uint64_t m_maxFrameHeapAllocations = 0;  // since the last report
+    float m_lodPixelError = 1.0f;            // how far a level of detail may stray on screen
+    uint32_t m_lodSetting = 0;
+    bool m_isLodBenchmark = false;
+    std::array<uint64_t, MAX_MESH_LODS> m_lodObjects{};    // since the last report
+    std::array<uint64_t, MAX_MESH_LODS> m_lodTriangles{};
+    double m_frameMilliseconds = 0.0;
+    uint64_t m_timedFrames = 0;
+    std::optional<std::chrono::high_resolution_clock::time_point> m_frameStart;
+    glm::mat4 m_view{1.0f};
+    glm::mat4 m_viewProjection{1.0f};
     std::vector<vk::Buffer> m_uniformBuffers;
 
+    // point lights orbiting low over the grid
+    ClusteredLighting* m_lighting;
+    std::vector<PointLight> m_lights;
+    std::vector<glm::vec4> m_lightOrbits;  // distance from the grid's center, phase, angular speed and height
+    uint32_t m_lightSetting = 2;
+    bool m_isLightBenchmark = false;
+
+    // a fountain rising from the occluder
+    ParticleSystem* m_particles;
+    ParticleEmitter m_fountain;
+    float m_sceneTime = 0.0f;
+
+    // tentacles swaying over the grid, skinned once per frame for every pass
+    Skeleton m_tentacleSkeleton;
+    AnimationClip m_tentacleSway;
+    AnimationSystem* m_animation;
+    SkinningPass* m_skinning;
+    std::vector<MeshRange> m_characters;  // the skinned copies, quantized alike
+    TransformHandle m_firstCharacter;
+    double m_animationMilliseconds = 0.0;  // since the last report
+
+    SamplerCache* m_samplerCache;
+    TextureManager* m_textureManager;
+    TextureHandle m_texture;
+    std::vector<uint32_t> m_descriptorTextureVersions;
+
+    // the first pass clears, the second draws what the first uncovered and presents
     VkRenderPass m_renderPass;
+    VkRenderPass m_lateRenderPass;
     VkDescriptorPool m_descriptorPool;
     std::vector<VkDescriptorSet> m_descriptorSets;
-    VkDescriptorSetLayout m_descriptorSetLayout;
-    VkPipelineLayout m_pipelineLayout;
-    VkPipeline m_graphicsPipeline;
-
-    std::vector<VkFramebuffer> m_swapChainFramebuffers;
+    LayoutCache* m_layoutCache;
+    const PipelineLayout* m_pipelineLayout = nullptr;
+    PipelineVariants* m_graphicsPipelines;
+    SpecializationConstants m_pipelineConstants;  // selects the variant to draw with
+
+    // hot reload, pipelines are rebuilt in the background and retired per frame
+    ShaderWatcher* m_shaderWatcher = nullptr;
+    std::future<PipelineVariants::Variants> m_pendingPipelines;
+    bool m_isPipelineStale = false;
+    std::vector<std::vector<VkPipeline>> m_retiredPipelines;
+
+    // the scene renders into the top left of targets the size of the swap chain and is
+    // upscaled into the swap chain image, the scale only moves the viewport. where the
+    // swap chain can not be blitted to, the scene renders into it at full resolution.
+    DynamicResolution* m_resolution;
+    VkExtent2D m_renderExtent{};
+    bool m_isUpscaled = false;
+    VkFormat m_depthFormat;
+    vk::Image* m_colorImage = nullptr;
+    vk::Image* m_depthImage = nullptr;
+    std::vector<VkFramebuffer> m_framebuffers;  // one for the color target, or one per swap chain image
     VkCommandPool m_commandPool;
     std::vector<vk::CommandBuffer> m_commandBuffers;
 
@@ -97,128 +191,239 @@ private:
     std::vector<VkFence> m_inFlightFences;
 
     bool m_framebufferResized = false;
+    bool m_isStatsReported = false;
 
 private:
     void _init() {
         glfwInit();
+        m_assets = new AssetStore();
+        m_shaders = new ShaderLibrary(*m_assets, std::getenv("ENGINE_SHADER_OVERRIDE") != nullptr);
+        m_meshLoader = new MeshLoader(*m_assets);
         m_instance = new vk::Instance(true);
         m_window = new glfw::Window(*m_instance);
         m_window->setFramebufferResizeCallback(_framebufferResizeCallback, &m_framebufferResized);
         m_physicalDevice = new vk::PhysicalDevice(*m_instance, m_window->getSurface());
         m_device = new vk::Device(*m_physicalDevice);
+        m_residencyManager = new ResidencyManager(*m_device, *m_physicalDevice);
+        m_layoutCache = new LayoutCache(*m_device);
         m_swapChain = new vk::SwapChain(*m_device, *m_physicalDevice, *m_window);
-        _createRenderPass();
+        m_depthFormat = _findDepthFormat();
+        m_isUpscaled = _canUpscale();
+        m_renderPass = _createRenderPass(false);
+        m_lateRenderPass = _createRenderPass(true);
+        _createRenderTargets();
         _createFramebuffers();
-        _createDescriptorSetLayout();
         _createGraphicsPipeline();
         _createCommandPool();
-        _createVertexBuffer();
-        _createIndexBuffer();
+        _createTextures();
+        _createGeometry();
+        _createScene();
         _createUniformBuffers();
         _createDescriptorPool();
         _createDescriptorSets();
         _createCommandBuffer();
         _createSyncObjects();
+
+        float gpuBudget = m_GPU_BUDGET_MILLISECONDS;
+        if (const char* budget = std::getenv("ENGINE_GPU_BUDGET_MS")) {
+            gpuBudget = std::stof(budget);
+        }
+        m_resolution = new DynamicResolution(*m_device, *m_physicalDevice, m_MAX_FRAMES_IN_FLIGHT, gpuBudget);
+        if (const char* scale = std::getenv("ENGINE_RENDER_SCALE")) {
+            m_resolution->setFixedScale(std::stof(scale));
+        }
+        if (!m_isUpscaled) {
+            m_resolution->setFixedScale(1.0f);
+            std::cout << "the swap chain can not be upscaled into, rendering at full resolution" << std::endl;
+        }
+
+        m_retiredPipelines.resize(m_MAX_FRAMES_IN_FLIGHT);
+        if (std::getenv("ENGINE_SHADER_HOT_RELOAD") != nullptr) {
+            m_shaderWatcher = new ShaderWatcher(*m_shaders);
+        }
+        // the benchmarks move to their next setting when a report is made
+        m_isStatsReported = std::getenv("ENGINE_STATS") != nullptr || m_isLodBenchmark || m_isLightBenchmark;
+
+        m_assets->report();
     }
 
-    void _createRenderPass() {
+    // the late pass loads what the early one stored, both keep the depth readable by
+    // the pyramid build in between and the late one leaves the color to be upscaled or
+    // presented. pipelines built for one work in the other.
+    VkRenderPass _createRenderPass(bool isLate) {
         VkAttachmentDescription colorAttachment{};
         colorAttachment.format = m_swapChain->getImageFormat();
         colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        colorAttachment.loadOp = isLate ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
         colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
         colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        colorAttachment.initialLayout = isLate ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+        colorAttachment.finalLayout = !isLate ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : m_isUpscaled ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+        VkAttachmentDescription depthAttachment{};
+        depthAttachment.format = m_depthFormat;
+        depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        depthAttachment.loadOp = isLate ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.initialLayout = isLate ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED;
+        depthAttachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
         VkAttachmentReference colorAttachmentRef{};
         colorAttachmentRef.attachment = 0;
         colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+        VkAttachmentReference depthAttachmentRef{};
+        depthAttachmentRef.attachment = 1;
+        depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
         VkSubpassDescription subpass{};
         subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
         subpass.colorAttachmentCount = 1;
         subpass.pColorAttachments = &colorAttachmentRef;
+        subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
+        std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
         VkRenderPassCreateInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        renderPassInfo.attachmentCount = 1;
-        renderPassInfo.pAttachments = &colorAttachment;
+        renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        renderPassInfo.pAttachments = attachments.data();
         renderPassInfo.subpassCount = 1;
         renderPassInfo.pSubpasses = &subpass;
 
-        VkSubpassDependency dependency{};
-        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        dependency.dstSubpass = 0;
-        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.srcAccessMask = 0;
-        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        renderPassInfo.dependencyCount = 1;
-        renderPassInfo.pDependencies = &dependency;
-
-        if (vkCreateRenderPass(m_device->get(), &renderPassInfo, nullptr, &m_renderPass) != VK_SUCCESS) {
+        // in: after the previous pass, the pyramid build read the depth and the upscale read
+        // the color, out: before the next build and the upscale
+        std::array<VkSubpassDependency, 2> dependencies{};
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass = 0;
+        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                                       VK_PIPELINE_STAGE_TRANSFER_BIT;
+        dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[1].srcSubpass = 0;
+        dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+        renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        renderPassInfo.pDependencies = dependencies.data();
+
+        VkRenderPass renderPass;
+        if (vkCreateRenderPass(m_device->get(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
             throw std::runtime_error("failed to create render pass!");
         }
+
+        return renderPass;
+    }
+
+    // sampled by the depth pyramid build
+    VkFormat _findDepthFormat() const {
+        for (VkFormat format : {VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D16_UNORM}) {
+            if (m_physicalDevice->isFormatSupported(format, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) {
+                return format;
+            }
+        }
+
+        throw std::runtime_error("failed to find a sampled depth format!");
+    }
+
+    // the upscale blits from a color target in the swap chain's format into the swap chain
+    // image with a linear filter, queried once, the render passes depend on it
+    bool _canUpscale() const {
+        VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        return (m_swapChain->getImageUsage() & VK_IMAGE_USAGE_TRANSFER_DST_BIT) && m_physicalDevice->isFormatSupported(m_swapChain->getImageFormat(), blitFeatures);
+    }
+
+    // at the largest render extent, the swap chain's, so a change of scale reallocates nothing
+    void _createRenderTargets() {
+        VkImageCreateInfo imageInfo = vk::imageCreateInfo();
+        {
+            imageInfo.format = m_swapChain->getImageFormat();
+            imageInfo.extent.width = m_swapChain->getExtent().width;
+            imageInfo.extent.height = m_swapChain->getExtent().height;
+            imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
+        if (m_isUpscaled) {
+            m_colorImage = new vk::Image(*m_device, *m_physicalDevice, imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        }
+
+        imageInfo.format = m_depthFormat;
+        imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        m_depthImage = new vk::Image(*m_device, *m_physicalDevice, imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+        if (m_occlusionCuller != nullptr) {
+            m_occlusionCuller->resize(*m_depthImage);
+        }
     }
 
     void _createFramebuffers() {
-        m_swapChainFramebuffers.resize(m_swapChain->getImageViews().size());
+        std::vector<VkImageView> colorViews = m_isUpscaled ? std::vector<VkImageView>{m_colorImage->getView()} : m_swapChain->getImageViews();
+        m_framebuffers.resize(colorViews.size());
 
-        for (size_t i = 0; i < m_swapChain->getImageViews().size(); i++) {
-            VkImageView attachments[] = {m_swapChain->getImageViews()[i]};
+        for (size_t i = 0; i < colorViews.size(); i++) {
+            std::array<VkImageView, 2> attachments = {colorViews[i], m_depthImage->getView()};
 
             VkFramebufferCreateInfo framebufferInfo{};
             framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
             framebufferInfo.renderPass = m_renderPass;
-            framebufferInfo.attachmentCount = 1;
-            framebufferInfo.pAttachments = attachments;
+            framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+            framebufferInfo.pAttachments = attachments.data();
             framebufferInfo.width = m_swapChain->getExtent().width;
             framebufferInfo.height = m_swapChain->getExtent().height;
             framebufferInfo.layers = 1;
 
-            if (vkCreateFramebuffer(m_device->get(), &framebufferInfo, nullptr, &m_swapChainFramebuffers[i]) != VK_SUCCESS) {
+            if (vkCreateFramebuffer(m_device->get(), &framebufferInfo, nullptr, &m_framebuffers[i]) != VK_SUCCESS) {
                 throw std::runtime_error("failed to create framebuffer!");
             }
         }
     }
 
-    void _createDescriptorSetLayout() {
-        VkDescriptorSetLayoutBinding uboLayoutBinding{};
-        {
-            uboLayoutBinding.binding = 0;
-            uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            uboLayoutBinding.descriptorCount = 1;
-            uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-            uboLayoutBinding.pImmutableSamplers = nullptr;  // Optional
-        }
-
-        VkDescriptorSetLayoutCreateInfo layoutInfo{};
-        {
-            layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-            layoutInfo.bindingCount = 1;
-            layoutInfo.pBindings = &uboLayoutBinding;
-        }
+    void _createGraphicsPipeline() {
+        // the viewport is dynamic state, the extent only has to be valid
+        m_graphicsPipelines = new PipelineVariants(*m_device, [this, extent = m_swapChain->getExtent()](const SpecializationConstants& constants) {
+            return _buildGraphicsPipeline(extent, constants);
+        });
 
-        if (vkCreateDescriptorSetLayout(m_device->get(), &layoutInfo, nullptr, &m_descriptorSetLayout) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create descriptor set layout!");
-        }
+        m_pipelineConstants.set(m_TEXTURED_CONSTANT, true);
+        m_graphicsPipelines->get(m_pipelineConstants);
     }
 
-    void _createGraphicsPipeline() {
-        auto vertShaderCode = help::readResource("shaders/bin/default_vert.spv");
-        auto fragShaderCode = help::readResource("shaders/bin/default_frag.spv");
+    // also runs on a background thread for the hot reload, so it only reads the application state
+    VkPipeline _buildGraphicsPipeline(VkExtent2D extent, const SpecializationConstants& constants) {
+        Asset vertShaderCode = m_shaders->load(m_VERT_SHADER);
+        Asset fragShaderCode = m_shaders->load(m_FRAG_SHADER);
+
+        // descriptor set and push constant layouts come from the shaders themselves
+        std::array<ShaderReflection, 2> reflections = {reflectShader(vertShaderCode.getSpan()), reflectShader(fragShaderCode.getSpan())};
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions = _getVertexAttributeDescriptions();
+        validateVertexInputs(reflections[0], attributeDescriptions);
+
+        const PipelineLayout& layout = m_layoutCache->get(reflections);
+        if (m_pipelineLayout == nullptr) {
+            m_pipelineLayout = &layout;
+        } else if (&layout != m_pipelineLayout) {
+            // the descriptor sets were allocated for the old layout
+            throw std::runtime_error("shader interface changed, restart to pick it up!");
+        }
 
         VkShaderModule vertShaderModule = _createShaderModule(vertShaderCode);
         VkShaderModule fragShaderModule = _createShaderModule(fragShaderCode);
 
+        // ids a stage does not declare are ignored, so both stages share one map
+        VkSpecializationInfo specializationInfo = constants.getInfo();
+
         VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
         {
             vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
             vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
             vertShaderStageInfo.module = vertShaderModule;
             vertShaderStageInfo.pName = "main";
+            vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
         }
 
         VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
@@ -227,6 +432,7 @@ private:
             fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
             fragShaderStageInfo.module = fragShaderModule;
             fragShaderStageInfo.pName = "main";
+            fragShaderStageInfo.pSpecializationInfo = &specializationInfo;
         }
 
         VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
@@ -240,13 +446,15 @@ private:
         dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
         dynamicState.pDynamicStates = dynamicStates.data();
 
-        auto bindingDescription = Vertex::getBindingDescription();
-        auto attributeDescriptions = Vertex::getAttributeDescriptions();
+        // mesh vertices in binding 0, world matrices per instance in binding 1
+        std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {
+            Vertex::getBindingDescription(0),
+            InstanceLayout::getBindingDescription(1, VK_VERTEX_INPUT_RATE_INSTANCE)};
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputInfo.vertexBindingDescriptionCount = 1;
+        vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
         vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-        vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;             // optional
+        vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();      // optional
         vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();  // optional
 
         VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
@@ -257,14 +465,14 @@ private:
         VkViewport viewport{};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
-        viewport.width = (float)m_swapChain->getExtent().width;
-        viewport.height = (float)m_swapChain->getExtent().height;
+        viewport.width = (float)extent.width;
+        viewport.height = (float)extent.height;
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
 
         VkRect2D scissor{};
         scissor.offset = {0, 0};
-        scissor.extent = m_swapChain->getExtent();
+        scissor.extent = extent;
 
         VkPipelineViewportStateCreateInfo viewportState{};
         viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -295,6 +503,14 @@ private:
         multisampling.alphaToCoverageEnable = VK_FALSE;  // optional
         multisampling.alphaToOneEnable = VK_FALSE;       // optional
 
+        VkPipelineDepthStencilStateCreateInfo depthStencil{};
+        depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthStencil.depthTestEnable = VK_TRUE;
+        depthStencil.depthWriteEnable = VK_TRUE;
+        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+        depthStencil.depthBoundsTestEnable = VK_FALSE;
+        depthStencil.stencilTestEnable = VK_FALSE;
+
         VkPipelineColorBlendAttachmentState colorBlendAttachment{};
         colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
         colorBlendAttachment.blendEnable = VK_FALSE;
@@ -316,19 +532,6 @@ private:
         colorBlending.blendConstants[2] = 0.0f;  // optional
         colorBlending.blendConstants[3] = 0.0f;  // optional
 
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-        {
-            pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-            pipelineLayoutInfo.setLayoutCount = 1;
-            pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
-            pipelineLayoutInfo.pushConstantRangeCount = 0;     // optional
-            pipelineLayoutInfo.pPushConstantRanges = nullptr;  // optional
-        }
-
-        if (vkCreatePipelineLayout(m_device->get(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create pipeline layout!");
-        }
-
         VkGraphicsPipelineCreateInfo pipelineInfo{
             .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
             .stageCount = 2,
@@ -338,23 +541,74 @@ private:
             .pViewportState = &viewportState,
             .pRasterizationState = &rasterizer,
             .pMultisampleState = &multisampling,
-            .pDepthStencilState = nullptr,  // optional
+            .pDepthStencilState = &depthStencil,
             .pColorBlendState = &colorBlending,
             .pDynamicState = &dynamicState,
-            .layout = m_pipelineLayout,
+            .layout = layout.layout,
             .renderPass = m_renderPass,
             .subpass = 0,
             .basePipelineHandle = VK_NULL_HANDLE,  // optional to derive new pipeline from the current one
             .basePipelineIndex = -1                // optional to derive new pipeline from the current one
         };
 
-        if (vkCreateGraphicsPipelines(m_device->get(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create graphics pipeline!");
-        }
+        VkPipeline pipeline;
+        VkResult result = vkCreateGraphicsPipelines(m_device->get(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
 
         // free the shader modules
         vkDestroyShaderModule(m_device->get(), fragShaderModule, nullptr);
         vkDestroyShaderModule(m_device->get(), vertShaderModule, nullptr);
+
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to create graphics pipeline!");
+        }
+
+        return pipeline;
+    }
+
+    // runs after the frame's fence was waited on, pipelines retired the last time this
+    // frame was recorded are no longer referenced by any frame in flight
+    void _updatePipelines() {
+        for (VkPipeline pipeline : m_retiredPipelines[m_currentFrame]) {
+            vkDestroyPipeline(m_device->get(), pipeline, nullptr);
+        }
+        m_retiredPipelines[m_currentFrame].clear();
+
+        if (m_shaderWatcher == nullptr) {
+            return;
+        }
+
+        // the other systems build their pipelines once in their constructors
+        for (const std::string& name : m_shaderWatcher->poll()) {
+            if (name == m_VERT_SHADER || name == m_FRAG_SHADER) {
+                m_isPipelineStale = true;
+            } else {
+                std::cerr << name << " is not reloadable, restart to use it" << std::endl;
+            }
+        }
+
+        // one build at a time, changes made during a build start the next one. every variant
+        // in use is rebuilt, variants first requested meanwhile already see the new code.
+        if (m_isPipelineStale && !m_pendingPipelines.valid()) {
+            m_pendingPipelines = std::async(std::launch::async, [this, keys = m_graphicsPipelines->getKeys()] {
+                return m_graphicsPipelines->build(keys);
+            });
+            m_isPipelineStale = false;
+        }
+
+        if (!m_pendingPipelines.valid() || m_pendingPipelines.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+
+        try {
+            PipelineVariants::Variants variants = m_pendingPipelines.get();
+            size_t count = variants.size();
+            for (VkPipeline pipeline : m_graphicsPipelines->replace(std::move(variants))) {
+                m_retiredPipelines[m_currentFrame].push_back(pipeline);
+            }
+            std::cout << "graphics pipeline reloaded (" << count << " variants)" << std::endl;
+        } catch (const std::runtime_error& e) {
+            std::cerr << "keeping the previous pipeline: " << e.what() << std::endl;
+        }
     }
 
     void _createCommandPool() {
@@ -369,75 +623,227 @@ private:
         }
     }
 
-    void _createVertexBuffer() {
-        VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-        // staging buffer
-        VkBufferCreateInfo bufferInfo = vk::bufferCreateInfo();
-        bufferInfo.size = bufferSize;
-        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        vk::Buffer stagingBuffer(*m_device, *m_physicalDevice, bufferInfo,
-                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    void _createTextures() {
+        m_samplerCache = new SamplerCache(*m_device, *m_physicalDevice);
+        m_textureManager = new TextureManager(*m_device, *m_physicalDevice, *m_assets, *m_shaders, *m_layoutCache, *m_residencyManager, *m_samplerCache, m_MAX_FRAMES_IN_FLIGHT);
+        m_texture = m_textureManager->load("textures/texture.png");
+    }
 
-        stagingBuffer.setData(vertices.data());
+    void _createScene() {
+        uint32_t characterCount = m_CHARACTER_COUNT;
+        if (const char* count = std::getenv("ENGINE_CHARACTER_COUNT")) {
+            characterCount = static_cast<uint32_t>(std::stoul(count));
+        }
 
-        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-        m_vertexBuffer = new vk::Buffer(*m_device, *m_physicalDevice, bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        m_transforms = new TransformSystem(m_SCENE_GRID * m_SCENE_GRID + 2 + characterCount);
+        m_instances = new InstanceBuffer(*m_device, *m_physicalDevice, m_INSTANCE_CAPACITY, m_MAX_FRAMES_IN_FLIGHT);
+        m_culling = new CullingSystem();
+        m_renderQueue = new RenderQueue(*m_geometry);
+        m_frameAllocator = new FrameAllocator(m_MAX_FRAMES_IN_FLIGHT);
+        if (std::getenv("ENGINE_NO_OCCLUSION_CULLING") == nullptr && OcclusionCuller::isSupported(*m_device)) {
+            m_occlusionCuller = new OcclusionCuller(*m_device, *m_physicalDevice, *m_shaders, *m_layoutCache, *m_samplerCache, m_INSTANCE_CAPACITY, m_MAX_FRAMES_IN_FLIGHT);
+            m_occlusionCuller->resize(*m_depthImage);
+        }
 
-        // copy
-        VkCommandBufferAllocateInfo allocInfo = vk::commandBufferAllocateInfo();
-        allocInfo.commandPool = m_commandPool;
-        vk::CommandBuffer cmd(*m_device, allocInfo);
+        m_lighting = new ClusteredLighting(*m_device, *m_physicalDevice, *m_shaders, *m_layoutCache, m_LIGHT_CAPACITY, m_MAX_FRAMES_IN_FLIGHT);
+        uint32_t lightCount = m_LIGHT_COUNTS[m_lightSetting];
+        if (const char* count = std::getenv("ENGINE_LIGHT_COUNT")) {
+            lightCount = static_cast<uint32_t>(std::stoul(count));
+        }
+        m_isLightBenchmark = std::getenv("ENGINE_LIGHT_BENCHMARK") != nullptr;
+        if (m_isLightBenchmark) {
+            m_lightSetting = 0;
+            lightCount = m_LIGHT_COUNTS[m_lightSetting];
+        }
+        _createLights(lightCount);
+
+        m_particles = new ParticleSystem(*m_device, *m_physicalDevice, *m_shaders, *m_layoutCache, m_lateRenderPass, m_PARTICLE_CAPACITY, m_MAX_FRAMES_IN_FLIGHT);
+        m_fountain = {
+            .position = glm::vec3(0.0f, 0.0f, m_OCCLUDER_HEIGHT + 0.05f),
+            .radius = 0.02f,
+            .velocity = glm::vec3(0.0f, 0.0f, 1.5f),
+            .spread = 0.5f,
+            .color = glm::vec4(1.0f, 0.55f, 0.2f, 0.5f),
+            .rate = m_PARTICLE_RATE,
+            .lifetime = 2.5f};
+        if (const char* rate = std::getenv("ENGINE_PARTICLE_RATE")) {
+            m_fountain.rate = std::stof(rate);
+        }
 
-        VkCommandBufferBeginInfo beginInfo = vk::commandBufferBeginInfo();
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-        cmd.begin(beginInfo);
+        if (const char* pixelError = std::getenv("ENGINE_LOD_PIXEL_ERROR")) {
+            m_lodPixelError = std::stof(pixelError);
+        }
+        m_isLodBenchmark = std::getenv("ENGINE_LOD_BENCHMARK") != nullptr;
+        if (m_isLodBenchmark) {
+            m_lodPixelError = m_LOD_PIXEL_ERRORS[m_lodSetting];
+        }
 
-        cmd.copyBuffer(stagingBuffer, *m_vertexBuffer, bufferSize);
-        cmd.end();
+        // a grid of spheres spinning as a whole and each on its own, the corners sweep out of view
+        m_sceneRoot = m_transforms->create();
+        m_firstSphere = m_transforms->getCount();  // handles are consecutive, visible runs draw as one instance range
+        Aabb sphereBounds = getPositionBounds(m_sphere.dequantization);
+        float cell = m_SCENE_SIZE / m_SCENE_GRID;
+        for (uint32_t y = 0; y < m_SCENE_GRID; y++) {
+            for (uint32_t x = 0; x < m_SCENE_GRID; x++) {
+                glm::vec3 position((x + 0.5f) * cell - m_SCENE_SIZE * 0.5f, (y + 0.5f) * cell - m_SCENE_SIZE * 0.5f, 0.0f);
+                TransformHandle sphere = m_transforms->create(m_sceneRoot, position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(cell * 0.9f));
+                m_culling->add(*m_transforms, sphere, sphereBounds);
+            }
+        }
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &cmd.get();
+        // hides the spheres passing below it from the camera, the last handle the culling
+        // system knows so it ends the sorted visible list
+        m_occluder = m_transforms->create(NO_PARENT, glm::vec3(0.0f, 0.0f, m_OCCLUDER_HEIGHT), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(m_OCCLUDER_SIZE));
+        m_culling->add(*m_transforms, m_occluder, getPositionBounds(m_quad.dequantization));
 
-        vkQueueSubmit(m_device->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(m_device->getGraphicsQueue());
+        _createCharacters(characterCount);
     }
 
-    void _createIndexBuffer() {
-        VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+    // a grid of tentacles over the spheres, each with a copy of the same skinned mesh
+    // that its own joints pose
+    void _createCharacters(uint32_t count) {
+        Mesh tentacle;
+        std::vector<SkinWeights> weights;
+        _buildTentacle(tentacle, weights);
+        MeshRange mesh = m_geometry->add(MeshData(encodeMesh(tentacle)));
+
+        float segment = m_TENTACLE_HEIGHT / m_TENTACLE_JOINTS;
+        for (uint32_t joint = 0; joint < m_TENTACLE_JOINTS; joint++) {
+            m_tentacleSkeleton.parents.push_back(joint == 0 ? NO_JOINT : joint - 1);
+            m_tentacleSkeleton.translations.push_back(glm::vec3(0.0f, 0.0f, joint == 0 ? 0.0f : segment));
+            m_tentacleSkeleton.rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        }
 
-        VkBufferCreateInfo bufferInfo = vk::bufferCreateInfo();
-        bufferInfo.size = bufferSize;
-        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        vk::Buffer stagingBuffer(*m_device, *m_physicalDevice, bufferInfo,
-                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        // a bend travelling up the tentacle while it circles
+        m_tentacleSway.duration = 2.0f;
+        m_tentacleSway.keyCount = 16;
+        for (uint32_t key = 0; key < m_tentacleSway.keyCount; key++) {
+            for (uint32_t joint = 0; joint < m_TENTACLE_JOINTS; joint++) {
+                float phase = glm::radians(360.0f) * key / m_tentacleSway.keyCount - 0.7f * joint;
+                float amplitude = glm::radians(14.0f);
+                m_tentacleSway.rotations.push_back(glm::angleAxis(amplitude * std::sin(phase), glm::vec3(1.0f, 0.0f, 0.0f)) *
+                                                   glm::angleAxis(amplitude * std::cos(phase), glm::vec3(0.0f, 1.0f, 0.0f)));
+            }
+        }
 
-        stagingBuffer.setData(indices.data());
+        m_animation = new AnimationSystem(m_tentacleSkeleton, count);
+        m_skinning = new SkinningPass(*m_device, *m_physicalDevice, *m_shaders, *m_layoutCache, *m_geometry, mesh.vertexCount, count, count * m_TENTACLE_JOINTS, m_MAX_FRAMES_IN_FLIGHT);
+        SkinnedMesh skinned = m_skinning->addMesh(mesh, weights, m_TENTACLE_JOINTS);
+
+        // the tip never gets further from the root than the tentacle is long
+        float reach = m_TENTACLE_HEIGHT + m_TENTACLE_RADIUS;
+        Aabb poseBounds{glm::vec3(-reach), glm::vec3(reach)};
+
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(count))));
+        float spacing = m_SCENE_SIZE * 0.9f / std::max(side, 1u);
+        m_firstCharacter = m_transforms->getCount();
+        m_characters.reserve(count);
+        for (uint32_t i = 0; i < count; i++) {
+            glm::vec3 position((i % side + 0.5f) * spacing - m_SCENE_SIZE * 0.45f, (i / side + 0.5f) * spacing - m_SCENE_SIZE * 0.45f, 0.0f);
+            glm::quat rotation = glm::angleAxis(unit(random) * glm::radians(360.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+            TransformHandle transform = m_transforms->create(NO_PARENT, position, rotation);
+            m_animation->create(m_tentacleSway, unit(random) * m_tentacleSway.duration, 0.75f + 0.5f * unit(random));
+            m_characters.push_back(m_skinning->addInstance(skinned, poseBounds, transform));
+        }
+    }
 
-        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-        m_indexBuffer = new vk::Buffer(*m_device, *m_physicalDevice, bufferInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    // a tapering tube standing on z = 0 with a pointed tip, the joints evenly up its
+    // height. every ring of vertices follows the two joints closest to it.
+    static void _buildTentacle(Mesh& mesh, std::vector<SkinWeights>& weights) {
+        constexpr uint32_t rings = 33;
+        constexpr uint32_t sides = 12;
+        glm::vec4 color(0.55f, 0.3f, 0.75f, 1.0f);
+        float segment = m_TENTACLE_HEIGHT / m_TENTACLE_JOINTS;
+
+        auto weigh = [&](float z) {
+            float joint = std::clamp(z / segment - 0.5f, 0.0f, static_cast<float>(m_TENTACLE_JOINTS - 1));
+            uint32_t first = static_cast<uint32_t>(joint);
+            uint32_t second = std::min(first + 1, m_TENTACLE_JOINTS - 1);
+            uint8_t weight = static_cast<uint8_t>(std::round((joint - first) * 255.0f));
+            weights.push_back({.joints = glm::u8vec4(first, second, 0, 0), .weights = glm::u8vec4(255 - weight, weight, 0, 0)});
+        };
 
-        // copy
-        VkCommandBufferAllocateInfo allocInfo = vk::commandBufferAllocateInfo();
-        allocInfo.commandPool = m_commandPool;
-        vk::CommandBuffer cmd(*m_device, allocInfo);
+        for (uint32_t ring = 0; ring < rings; ring++) {
+            float height = static_cast<float>(ring) / (rings - 1);
+            float z = height * m_TENTACLE_HEIGHT;
+            float radius = m_TENTACLE_RADIUS * (1.0f - 0.8f * height);
+            for (uint32_t i = 0; i <= sides; i++) {
+                float angle = glm::radians(360.0f) * i / sides;
+                glm::vec3 normal(std::cos(angle), std::sin(angle), 0.0f);
+                mesh.vertices.push_back({
+                    .position = glm::vec3(normal.x * radius, normal.y * radius, z),
+                    .normal = normal,
+                    .uv = glm::vec2(static_cast<float>(i) / sides, height),
+                    .color = color});
+                weigh(z);
+            }
+        }
+        uint32_t tip = static_cast<uint32_t>(mesh.vertices.size());
+        mesh.vertices.push_back({
+            .position = glm::vec3(0.0f, 0.0f, m_TENTACLE_HEIGHT + m_TENTACLE_RADIUS),
+            .normal = glm::vec3(0.0f, 0.0f, 1.0f),
+            .uv = glm::vec2(0.5f, 1.0f),
+            .color = color});
+        weigh(m_TENTACLE_HEIGHT);
+
+        for (uint32_t ring = 0; ring < rings; ring++) {
+            for (uint32_t i = 0; i < sides; i++) {
+                uint32_t a = ring * (sides + 1) + i;
+                if (ring + 1 == rings) {
+                    mesh.indices.insert(mesh.indices.end(), {a, a + 1, tip});
+                } else {
+                    uint32_t c = a + sides + 1;
+                    mesh.indices.insert(mesh.indices.end(), {a, a + 1, c + 1, a, c + 1, c});
+                }
+            }
+        }
+    }
 
-        VkCommandBufferBeginInfo beginInfo = vk::commandBufferBeginInfo();
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-        cmd.begin(beginInfo);
+    // lights of random colors on random orbits around the grid's center, their radius
+    // shrinks with the count so the grid stays as brightly lit
+    void _createLights(uint32_t count) {
+        if (count > m_LIGHT_CAPACITY) {
+            throw std::runtime_error("too many lights!");
+        }
 
-        cmd.copyBuffer(stagingBuffer, *m_indexBuffer, bufferSize);
-        cmd.end();
+        m_lights.resize(count);
+        m_lightOrbits.resize(count);
+        if (count == 0) {
+            return;
+        }
+
+        std::mt19937 random(42);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        float extent = m_SCENE_SIZE * 0.5f;
+        float radius = extent * std::sqrt(m_LIGHT_COVERAGE / count);
+
+        for (uint32_t i = 0; i < count; i++) {
+            glm::vec3 color(unit(random), unit(random), unit(random));
+            m_lights[i] = {
+                .radius = radius,
+                .color = color / std::max({color.x, color.y, color.z, 0.01f}),
+                .intensity = m_LIGHT_INTENSITY};
+            m_lightOrbits[i] = glm::vec4(extent * std::sqrt(unit(random)), unit(random) * glm::radians(360.0f),
+                                         glm::radians(60.0f) * (unit(random) - 0.5f), 0.05f + 0.25f * unit(random));
+        }
+    }
+
+    static std::vector<VkVertexInputAttributeDescription> _getVertexAttributeDescriptions() {
+        auto vertexAttributes = Vertex::getAttributeDescriptions(0);
+        auto instanceAttributes = InstanceLayout::getAttributeDescriptions(1, Vertex::ATTRIBUTE_COUNT);
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &cmd.get();
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions(vertexAttributes.begin(), vertexAttributes.end());
+        attributeDescriptions.insert(attributeDescriptions.end(), instanceAttributes.begin(), instanceAttributes.end());
+        return attributeDescriptions;
+    }
 
-        vkQueueSubmit(m_device->getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(m_device->getGraphicsQueue());
+    void _createGeometry() {
+        m_geometry = new GeometryBuffer(*m_device, *m_physicalDevice, m_commandPool, m_GEOMETRY_VERTEX_CAPACITY, m_GEOMETRY_INDEX_CAPACITY);
+        m_quad = m_geometry->add(m_meshLoader->load("models/quad.obj"));
+        m_sphere = m_geometry->add(m_meshLoader->load("models/sphere.obj"));
+        m_geometry->report();
     }
 
     void _createUniformBuffers() {
@@ -456,17 +862,13 @@ private:
     }
 
     void _createDescriptorPool() {
-        VkDescriptorPoolSize poolSize{};
-        {
-            poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            poolSize.descriptorCount = static_cast<uint32_t>(m_MAX_FRAMES_IN_FLIGHT);
-        }
+        std::vector<VkDescriptorPoolSize> poolSizes = m_pipelineLayout->getPoolSizes(0, m_MAX_FRAMES_IN_FLIGHT);
 
         VkDescriptorPoolCreateInfo poolInfo{};
         {
             poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-            poolInfo.poolSizeCount = 1;
-            poolInfo.pPoolSizes = &poolSize;
+            poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+            poolInfo.pPoolSizes = poolSizes.data();
             poolInfo.maxSets = static_cast<uint32_t>(m_MAX_FRAMES_IN_FLIGHT);
         }
 
@@ -476,7 +878,7 @@ private:
     }
 
     void _createDescriptorSets() {
-        std::vector<VkDescriptorSetLayout> layouts(m_MAX_FRAMES_IN_FLIGHT, m_descriptorSetLayout);
+        std::vector<VkDescriptorSetLayout> layouts(m_MAX_FRAMES_IN_FLIGHT, m_pipelineLayout->setLayouts[0]);
         VkDescriptorSetAllocateInfo allocInfo{};
         {
             allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -510,14 +912,62 @@ private:
             }
 
             vkUpdateDescriptorSets(m_device->get(), 1, &descriptorWrite, 0, nullptr);
+
+            // the lights, the clusters and their light indices at bindings 2 to 4
+            std::array<const vk::Buffer*, 3> lightBuffers = {&m_lighting->getLightBuffer(i), &m_lighting->getClusterBuffer(i), &m_lighting->getIndexBuffer(i)};
+            std::array<VkDescriptorBufferInfo, 3> lightInfos;
+            std::array<VkWriteDescriptorSet, 3> lightWrites{};
+            for (uint32_t j = 0; j < lightBuffers.size(); j++) {
+                lightInfos[j] = {
+                    .buffer = lightBuffers[j]->get(),
+                    .offset = 0,
+                    .range = VK_WHOLE_SIZE};
+
+                lightWrites[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                lightWrites[j].dstSet = m_descriptorSets[i];
+                lightWrites[j].dstBinding = j + 2;
+                lightWrites[j].descriptorCount = 1;
+                lightWrites[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                lightWrites[j].pBufferInfo = &lightInfos[j];
+            }
+            vkUpdateDescriptorSets(m_device->get(), static_cast<uint32_t>(lightWrites.size()), lightWrites.data(), 0, nullptr);
+        }
+
+        // texture bindings are written lazily once the upload of the frame was recorded
+        m_descriptorTextureVersions.assign(m_MAX_FRAMES_IN_FLIGHT, UINT32_MAX);
+    }
+
+    // points the frame's sampler binding to the texture or its placeholder, the set is not in flight at this point
+    void _updateTextureDescriptor(uint32_t frameIndex) {
+        if (m_descriptorTextureVersions[frameIndex] == m_textureManager->getVersion()) {
+            return;
+        }
+
+        VkDescriptorImageInfo imageInfo{
+            .sampler = m_textureManager->getSampler().get(),
+            .imageView = m_textureManager->getImage(m_texture).getView(),
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+
+        VkWriteDescriptorSet descriptorWrite{};
+        {
+            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrite.dstSet = m_descriptorSets[frameIndex];
+            descriptorWrite.dstBinding = 1;
+            descriptorWrite.dstArrayElement = 0;
+            descriptorWrite.descriptorCount = 1;
+            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            descriptorWrite.pImageInfo = &imageInfo;
         }
+
+        vkUpdateDescriptorSets(m_device->get(), 1, &descriptorWrite, 0, nullptr);
+        m_descriptorTextureVersions[frameIndex] = m_textureManager->getVersion();
     }
 
-    VkShaderModule _createShaderModule(const std::vector<char>& code) {
+    VkShaderModule _createShaderModule(const Asset& code) {
         VkShaderModuleCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = code.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+        createInfo.codeSize = code.getSize();
+        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.getData());
 
         VkShaderModule shaderModule;
         if (vkCreateShaderModule(m_device->get(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
@@ -541,37 +991,205 @@ private:
 
     void _recordCommandBuffer(const vk::CommandBuffer& cmd, uint32_t imageIndex) {
         cmd.begin(vk::commandBufferBeginInfo());
+        m_resolution->beginTimer(cmd);
+
+        // streamed texture uploads go before the render pass
+        m_textureManager->markUsed(m_texture);
+        m_textureManager->update(cmd, m_currentFrame);
+        _updateTextureDescriptor(m_currentFrame);
+
+        m_lighting->assign(cmd);
+        m_particles->simulate(cmd);
+        m_skinning->skin(cmd);
+
+        m_renderQueue->clear(m_frameAllocator->getArena());
+        DrawPacket packet{
+            .pipeline = m_graphicsPipelines->get(m_pipelineConstants),
+            .pipelineLayout = m_pipelineLayout->layout,
+            .descriptorSet = m_descriptorSets[m_currentFrame],
+            .mesh = m_sphere};
+        float pixelsPerUnit = m_renderExtent.height / (2.0f * std::tan(glm::radians(m_FIELD_OF_VIEW) * 0.5f));
+        std::span<const TransformHandle> visible = m_culling->cull(m_viewProjection);
+        if (!visible.empty() && visible.back() == m_occluder) {
+            _submitOccluder(packet);
+            visible = visible.first(visible.size() - 1);
+        }
+        if (m_occlusionCuller != nullptr) {
+            _addOcclusionCandidates(visible, pixelsPerUnit);
+            m_occlusionCuller->cullEarly(cmd);
+            _submitIndirect(packet, false);
+        } else {
+            _submitVisibleRuns(packet, visible, pixelsPerUnit);
+        }
+        _submitCharacters(packet);
+        m_renderQueue->sort();
+
+        VkShaderStageFlags pushConstantStages = m_pipelineLayout->getPushConstantStages(0, sizeof(DrawConstants));
+        VkBuffer instanceBuffers[] = {m_instances->getBuffer(m_currentFrame).get()};
+        VkDeviceSize instanceOffsets[] = {0};
+        _beginRenderPass(cmd, m_renderPass, imageIndex);
+        cmd.bindVertexBuffers(instanceBuffers, instanceOffsets, 1);
+        m_renderQueue->record(cmd, pushConstantStages);
+        cmd.endRenderPass();
+
+        // what the depth of the first pass no longer hides is drawn by the second
+        if (m_occlusionCuller != nullptr) {
+            m_occlusionCuller->cullLate(cmd, m_viewProjection, m_renderExtent);
+            m_renderQueue->clear(m_frameAllocator->getArena());
+            _submitIndirect(packet, true);
+            m_renderQueue->sort();
+        }
+
+        _beginRenderPass(cmd, m_lateRenderPass, imageIndex);
+        if (m_occlusionCuller != nullptr) {
+            cmd.bindVertexBuffers(instanceBuffers, instanceOffsets, 1);
+            m_renderQueue->record(cmd, pushConstantStages);
+        }
+        m_particles->draw(cmd, m_view, m_viewProjection, m_PARTICLE_SIZE);
+        cmd.endRenderPass();
+
+        if (m_occlusionCuller != nullptr) {
+            m_occlusionCuller->buildPyramid(cmd, m_viewProjection, m_renderExtent);
+        }
+
+        if (m_isUpscaled) {
+            _upscale(cmd, m_swapChain->getImages()[imageIndex]);
+        }
+        m_resolution->endTimer(cmd);
+        cmd.end();
+    }
+
+    void _beginRenderPass(const vk::CommandBuffer& cmd, VkRenderPass renderPass, uint32_t imageIndex) {
+        std::array<VkClearValue, 2> clearValues{};
+        clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+        clearValues[1].depthStencil = {1.0f, 0};
 
         VkRenderPassBeginInfo renderPassInfo = vk::renderPassBeginInfo();
         {
-            renderPassInfo.renderPass = m_renderPass;
-            renderPassInfo.framebuffer = m_swapChainFramebuffers[imageIndex];
-            renderPassInfo.renderArea.extent = m_swapChain->getExtent();
+            renderPassInfo.renderPass = renderPass;
+            renderPassInfo.framebuffer = m_framebuffers[m_isUpscaled ? 0 : imageIndex];
+            renderPassInfo.renderArea.extent = m_renderExtent;
+            renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+            renderPassInfo.pClearValues = clearValues.data();
         }
         cmd.beginRenderPass(renderPassInfo);
-        cmd.bindPipeline(m_graphicsPipeline);
-
-        VkBuffer vertexBuffers[] = {m_vertexBuffer->get()};
-        VkDeviceSize offsets[] = {0};
-        cmd.bindVertexBuffers(vertexBuffers, offsets);
-        cmd.bindIndexBuffer(m_indexBuffer->get(), VK_INDEX_TYPE_UINT16);  // TODO: add index buffer wrapper binding
 
         VkViewport viewport = vk::viewport();
         {
-            viewport.width = static_cast<float>(m_swapChain->getExtent().width);
-            viewport.height = static_cast<float>(m_swapChain->getExtent().height);
+            viewport.width = static_cast<float>(m_renderExtent.width);
+            viewport.height = static_cast<float>(m_renderExtent.height);
         }
         cmd.setViewport(viewport);
 
         VkRect2D scissor = vk::rect2D();
-        scissor.extent = m_swapChain->getExtent();
+        scissor.extent = m_renderExtent;
         cmd.setScissor(scissor);
+    }
 
-        cmd.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, &m_descriptorSets[m_currentFrame]);
-        cmd.drawIndexed(static_cast<uint32_t>(indices.size()));
-        cmd.endRenderPass();
+    // stretches the rendered part of the color target over the whole swap chain image
+    // and leaves that ready to present
+    void _upscale(const vk::CommandBuffer& cmd, VkImage swapChainImage) {
+        VkImageMemoryBarrier barrier = vk::imageMemoryBarrier();
+        {
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = swapChainImage;
+            barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        }
+        cmd.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, barrier);
+
+        VkExtent2D extent = m_swapChain->getExtent();
+        VkImageBlit region{
+            .srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .srcOffsets = {{0, 0, 0}, {static_cast<int32_t>(m_renderExtent.width), static_cast<int32_t>(m_renderExtent.height), 1}},
+            .dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+            .dstOffsets = {{0, 0, 0}, {static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1}}};
+        cmd.blitImage(*m_colorImage, swapChainImage, region, VK_FILTER_LINEAR);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+        cmd.pipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, barrier);
+    }
 
-        cmd.end();
+    // the visible handles come sorted, every run of consecutive ones at the same level
+    // of detail is a single draw
+    void _submitVisibleRuns(DrawPacket packet, std::span<const TransformHandle> visible, float pixelsPerUnit) {
+        uint32_t nextLod = visible.empty() ? 0 : _selectLod(visible[0], pixelsPerUnit);
+        for (size_t first = 0; first < visible.size();) {
+            uint32_t lod = nextLod;
+            size_t last = first + 1;
+            for (; last < visible.size(); last++) {
+                nextLod = _selectLod(visible[last], pixelsPerUnit);
+                if (visible[last] != visible[last - 1] + 1 || nextLod != lod) {
+                    break;
+                }
+            }
+
+            packet.lod = lod;
+            packet.instanceCount = static_cast<uint32_t>(last - first);
+            packet.firstInstance = visible[first];
+            m_renderQueue->submit(DrawPass::Opaque, packet, _getViewDistance(visible[first]) / m_FAR_PLANE);
+            _countLod(lod, packet.instanceCount);
+            first = last;
+        }
+    }
+
+    // every visible handle becomes a command of its own, the levels of detail are
+    // counted before the occlusion test
+    void _addOcclusionCandidates(std::span<const TransformHandle> visible, float pixelsPerUnit) {
+        for (TransformHandle handle : visible) {
+            uint32_t lod = _selectLod(handle, pixelsPerUnit);
+            m_occlusionCuller->add(m_culling->getWorldBounds(handle), m_sphere, lod, handle);
+            _countLod(lod, 1);
+        }
+    }
+
+    // the occluder goes to the first pass whatever the occlusion culling does, its depth
+    // is what hides the spheres below it
+    void _submitOccluder(DrawPacket packet) {
+        packet.mesh = m_quad;
+        packet.firstInstance = m_occluder;
+        m_renderQueue->submit(DrawPass::Opaque, packet, _getViewDistance(m_occluder) / m_FAR_PLANE);
+    }
+
+    void _submitIndirect(DrawPacket packet, bool isLate) {
+        packet.indirectBuffer = m_occlusionCuller->getCommands(isLate).get();
+        packet.indirectDrawCount = m_occlusionCuller->getCandidateCount();
+        if (packet.indirectDrawCount > 0) {
+            m_renderQueue->submit(DrawPass::Opaque, packet, 0.0f);
+        }
+    }
+
+    // the skinned copies go to the first pass, one indirect draw for all of them where
+    // the device takes the instance from the commands
+    void _submitCharacters(DrawPacket packet) {
+        if (m_characters.empty()) {
+            return;
+        }
+
+        packet.mesh = m_characters[0];
+        if (m_device->getFeatures().drawIndirectFirstInstance) {
+            packet.indirectBuffer = m_skinning->getDraws().get();
+            packet.indirectDrawCount = m_skinning->getInstanceCount();
+            m_renderQueue->submit(DrawPass::Opaque, packet, 0.0f);
+            return;
+        }
+        for (size_t i = 0; i < m_characters.size(); i++) {
+            packet.mesh = m_characters[i];
+            packet.firstInstance = m_firstCharacter + static_cast<uint32_t>(i);
+            m_renderQueue->submit(DrawPass::Opaque, packet, _getViewDistance(packet.firstInstance) / m_FAR_PLANE);
+        }
+    }
+
+    void _countLod(uint32_t lod, uint32_t objectCount) {
+        m_lodObjects[lod] += objectCount;
+        m_lodTriangles[lod] += static_cast<uint64_t>(objectCount) * (m_sphere.lods[lod].indexCount / 3);
     }
 
     static void _framebufferResizeCallback(uint32_t width, uint32_t height, void* callbackData) {
@@ -588,7 +1206,25 @@ private:
     }
 
     void _drawFrame() {
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        if (m_frameStart) {
+            m_frameMilliseconds += std::chrono::duration<double, std::milli>(frameStart - *m_frameStart).count();
+            m_timedFrames++;
+        }
+        m_frameStart = frameStart;
+
         vkWaitForFences(m_device->get(), 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+        uint64_t heapAllocations = getHeapAllocationCount();
+        m_frameAllocator->beginFrame(m_currentFrame);
+        if (m_occlusionCuller != nullptr) {
+            m_occlusionCuller->beginFrame(m_currentFrame);
+        }
+        m_lighting->beginFrame(m_currentFrame);
+        m_particles->beginFrame(m_currentFrame);
+        m_skinning->beginFrame(m_currentFrame);
+        m_resolution->beginFrame(m_currentFrame);
+        m_residencyManager->update();
+        _updatePipelines();
 
         uint32_t imageIndex;
         VkResult result = vkAcquireNextImageKHR(m_device->get(), m_swapChain->get(), UINT64_MAX, m_imageAvailableSemaphores[m_currentFrame], VK_NULL_HANDLE, &imageIndex);
@@ -602,6 +1238,8 @@ private:
 
         vkResetFences(m_device->get(), 1, &m_inFlightFences[m_currentFrame]);
 
+        m_renderExtent = m_resolution->getRenderExtent(m_swapChain->getExtent());
+        _updateScene(m_currentFrame);
         _updateUniformBuffer(m_currentFrame);
 
         m_commandBuffers[m_currentFrame].reset();
@@ -609,7 +1247,9 @@ private:
 
         VkSemaphore waitSemaphores[] = {m_imageAvailableSemaphores[m_currentFrame]};
         VkSemaphore signalSemaphores[] = {m_renderFinishedSemaphores[m_currentFrame]};
-        VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+        // the image is first written by the upscale, or by the first pass without it
+        VkPipelineStageFlags waitStage = m_isUpscaled ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        VkPipelineStageFlags waitStages[] = {waitStage};
         VkSubmitInfo submitInfo{
             .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
             .waitSemaphoreCount = 1,
@@ -644,20 +1284,116 @@ private:
             throw std::runtime_error("failed to present swap chain image!");
         }
 
+        // transient data goes to the frame allocator, in a steady frame this stays at zero
+        m_maxFrameHeapAllocations = std::max(m_maxFrameHeapAllocations, getHeapAllocationCount() - heapAllocations);
+        if (m_isStatsReported && m_residencyManager->getFrame() % m_STATS_REPORT_FRAMES == 0) {
+            _reportFrameStats();
+        }
+
         m_currentFrame = (m_currentFrame + 1) % m_MAX_FRAMES_IN_FLIGHT;
     }
 
-    void _updateUniformBuffer(uint32_t currentImage) {
+    void _reportFrameStats() {
+        m_culling->report();
+        if (m_occlusionCuller != nullptr) {
+            m_occlusionCuller->report();
+        }
+        m_lighting->report();
+        m_particles->report();
+        m_skinning->report();
+        m_resolution->report();
+        std::cout << "animation: " << m_animation->getCount() << " characters of " << m_animation->getJointCount() << " joints evaluated in "
+                  << m_animationMilliseconds / std::max<uint64_t>(m_timedFrames, 1) << " ms per frame" << std::endl;
+        m_animationMilliseconds = 0.0;
+        m_renderQueue->report(m_commandBuffers[m_currentFrame]);
+        std::cout << "frame memory: " << m_frameAllocator->getUsed() << " bytes of " << m_frameAllocator->getCapacity()
+                  << " in the frame arenas, at most " << m_maxFrameHeapAllocations << " heap allocations per frame" << std::endl;
+        m_maxFrameHeapAllocations = 0;
+
+        uint64_t frames = std::max<uint64_t>(m_timedFrames, 1);
+        uint64_t triangles = 0;
+        std::cout << "lods at " << m_lodPixelError << " px error: objects per level";
+        for (uint32_t lod = 0; lod < m_sphere.lodCount; lod++) {
+            std::cout << " " << m_lodObjects[lod] / frames;
+            triangles += m_lodTriangles[lod];
+        }
+        std::cout << ", " << triangles / frames << " triangles and " << m_frameMilliseconds / frames << " ms per frame" << std::endl;
+        m_lodObjects.fill(0);
+        m_lodTriangles.fill(0);
+        m_frameMilliseconds = 0.0;
+        m_timedFrames = 0;
+
+        // the next window measures the next setting
+        if (m_isLodBenchmark) {
+            m_lodSetting = (m_lodSetting + 1) % std::size(m_LOD_PIXEL_ERRORS);
+            m_lodPixelError = m_LOD_PIXEL_ERRORS[m_lodSetting];
+        }
+        if (m_isLightBenchmark) {
+            m_lightSetting = (m_lightSetting + 1) % std::size(m_LIGHT_COUNTS);
+            _createLights(m_LIGHT_COUNTS[m_lightSetting]);
+        }
+    }
+
+    // seconds since the first call
+    float _getTime() const {
         static auto startTime = std::chrono::high_resolution_clock::now();
 
         auto currentTime = std::chrono::high_resolution_clock::now();
-        float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+        return std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+    }
 
+    void _updateScene(uint32_t currentImage) {
+        float time = _getTime();
+        float deltaTime = std::min(time - m_sceneTime, 0.1f);  // a stall doesn't emit a burst
+        m_sceneTime = time;
+        m_transforms->setRotation(m_sceneRoot, glm::angleAxis(time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+        for (uint32_t i = 0; i < m_SCENE_GRID * m_SCENE_GRID; i++) {
+            float speed = glm::radians(45.0f) * static_cast<float>(i % 7 + 1);
+            m_transforms->setRotation(m_firstSphere + i, glm::angleAxis(time * speed, glm::vec3(0.0f, 0.0f, 1.0f)));
+        }
+
+        std::span<const uint32_t> updated = m_transforms->update();
+        m_instances->write(currentImage, *m_transforms, updated);
+        m_culling->update(*m_transforms, updated);
+
+        for (size_t i = 0; i < m_lights.size(); i++) {
+            const glm::vec4& orbit = m_lightOrbits[i];
+            float angle = orbit.y + time * orbit.z;
+            m_lights[i].position = glm::vec3(orbit.x * std::cos(angle), orbit.x * std::sin(angle), orbit.w);
+        }
+
+        m_particles->setEmitters({&m_fountain, 1}, deltaTime);
+
+        auto animationStart = std::chrono::high_resolution_clock::now();
+        m_skinning->setJoints(m_animation->update(time));
+        m_animationMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - animationStart).count();
+    }
+
+    // distance of the transform's origin along the view
+    float _getViewDistance(TransformHandle transform) const {
+        const glm::mat4& world = m_transforms->getWorldMatrix(transform);
+        glm::vec4 clip = m_viewProjection * world[3];
+        return clip.w;
+    }
+
+    // the coarsest level of the sphere that stays within m_lodPixelError on screen
+    uint32_t _selectLod(TransformHandle transform, float pixelsPerUnit) const {
+        const glm::mat4& world = m_transforms->getWorldMatrix(transform);
+        float scale = std::max({glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))});
+        return selectLod(m_sphere.getLods(), _getViewDistance(transform), pixelsPerUnit * scale, m_lodPixelError);
+    }
+
+    void _updateUniformBuffer(uint32_t currentImage) {
         UniformBufferObject ubo{};
-        ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
         ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ubo.proj = glm::perspective(glm::radians(45.0f), m_swapChain->getExtent().width / (float)m_swapChain->getExtent().height, 0.1f, 10.0f);
+        ubo.proj = glm::perspective(glm::radians(m_FIELD_OF_VIEW), m_swapChain->getExtent().width / (float)m_swapChain->getExtent().height, m_NEAR_PLANE, m_FAR_PLANE);
         ubo.proj[1][1] *= -1;
+        m_view = ubo.view;
+        m_viewProjection = ubo.proj * ubo.view;
+
+        m_lighting->update(m_lights, ubo.view, ubo.proj, m_renderExtent, m_NEAR_PLANE, m_FAR_PLANE);
+        ubo.clusters = m_lighting->getParameters();
+        ubo.ambient = glm::vec4(glm::vec3(m_AMBIENT), 0.0f);
 
         m_uniformBuffers[currentImage].setData(&ubo);
     }
@@ -684,9 +1420,12 @@ private:
     }
 
     void _cleanupSwapChain() {
-        for (size_t i = 0; i < m_swapChainFramebuffers.size(); i++) {
-            vkDestroyFramebuffer(m_device->get(), m_swapChainFramebuffers[i], nullptr);
+        for (VkFramebuffer framebuffer : m_framebuffers) {
+            vkDestroyFramebuffer(m_device->get(), framebuffer, nullptr);
         }
+        delete m_colorImage;
+        m_colorImage = nullptr;
+        delete m_depthImage;
 
         m_swapChain->clean();
     }
@@ -705,6 +1444,10 @@ private:
 
         m_physicalDevice->updateSwapChainSupportDetails(m_window->getSurface());
         m_swapChain->create();
+        if (m_isUpscaled && !_canUpscale()) {
+            throw std::runtime_error("the recreated swap chain can no longer be upscaled into!");
+        }
+        _createRenderTargets();
         _createFramebuffers();
     }
 
@@ -714,15 +1457,45 @@ private:
         m_uniformBuffers.clear();
 
         vkDestroyDescriptorPool(m_device->get(), m_descriptorPool, nullptr);
-        vkDestroyDescriptorSetLayout(m_device->get(), m_descriptorSetLayout, nullptr);
 
         // buffers
-        delete m_vertexBuffer;
-        delete m_indexBuffer;
+        delete m_geometry;
+        delete m_renderQueue;
+        delete m_occlusionCuller;
+        delete m_lighting;
+        delete m_particles;
+        delete m_skinning;
+        delete m_animation;
+        delete m_resolution;
+        delete m_frameAllocator;
+        delete m_culling;
+        delete m_instances;
+        delete m_transforms;
+
+        // textures
+        delete m_textureManager;
+        delete m_samplerCache;
+        delete m_residencyManager;
 
         // pipeline
-        vkDestroyPipeline(m_device->get(), m_graphicsPipeline, nullptr);
-        vkDestroyPipelineLayout(m_device->get(), m_pipelineLayout, nullptr);
+        delete m_shaderWatcher;
+        if (m_pendingPipelines.valid()) {
+            try {
+                for (auto& [constants, pipeline] : m_pendingPipelines.get()) {
+                    vkDestroyPipeline(m_device->get(), pipeline, nullptr);
+                }
+            } catch (const std::runtime_error&) {
+                // a failed build left nothing to destroy
+            }
+        }
+        for (const std::vector<VkPipeline>& pipelines : m_retiredPipelines) {
+            for (VkPipeline pipeline : pipelines) {
+                vkDestroyPipeline(m_device->get(), pipeline, nullptr);
+            }
+        }
+        delete m_graphicsPipelines;
+        delete m_layoutCache;
+        vkDestroyRenderPass(m_device->get(), m_lateRenderPass, nullptr);
         vkDestroyRenderPass(m_device->get(), m_renderPass, nullptr);
 
         // synchronization objects
@@ -740,6 +1513,9 @@ private:
         delete m_device;
         delete m_window;
         delete m_instance;
+        delete m_meshLoader;
+        delete m_shaders;
+        delete m_assets;
         glfwTerminate();
     }
 };
@@ -0,0 +1,68 @@
+#include "geometry/bounds.h"
+
+namespace eng {
+
+void Aabb::merge(const Aabb& other) {
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+}
+
+float Aabb::getSurfaceArea() const {
+    if (isEmpty()) {
+        return 0.0f;
+    }
+
+    glm::vec3 extent = max - min;
+    return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+}
+
+Aabb transformAabb(const Aabb& box, const glm::mat4& transform) {
+    if (box.isEmpty()) {
+        return box;
+    }
+
+    // arvo, each axis of the matrix moves the center and stretches the half extent
+    glm::vec3 center = box.getCenter();
+    glm::vec3 halfExtent = (box.max - box.min) * 0.5f;
+
+    glm::vec3 worldCenter(transform[3].x, transform[3].y, transform[3].z);
+    glm::vec3 worldHalfExtent(0.0f);
+    for (int axis = 0; axis < 3; axis++) {
+        glm::vec3 column(transform[axis].x, transform[axis].y, transform[axis].z);
+        worldCenter += column * center[axis];
+        worldHalfExtent += glm::abs(column) * halfExtent[axis];
+    }
+
+    return {worldCenter - worldHalfExtent, worldCenter + worldHalfExtent};
+}
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProjection) {
+    // gribb and hartmann, planes are sums of the matrix rows. the near plane uses the
+    // opengl depth range, which only loosens it a little for a [0, 1] projection
+    auto row = [&](int i) {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+    glm::vec4 x = row(0), y = row(1), z = row(2), w = row(3);
+
+    Frustum frustum{.planes = {w + x, w - x, w + y, w - y, w + z, w - z}};
+    for (glm::vec4& plane : frustum.planes) {
+        float length = glm::length(glm::vec3(plane.x, plane.y, plane.z));
+        plane = plane / length;
+    }
+    return frustum;
+}
+
+bool Frustum::intersects(const Aabb& box) const {
+    // the corner furthest along each normal must be on the inner side
+    for (const glm::vec4& plane : planes) {
+        glm::vec3 corner(plane.x >= 0.0f ? box.max.x : box.min.x,
+                         plane.y >= 0.0f ? box.max.y : box.min.y,
+                         plane.z >= 0.0f ? box.max.z : box.min.z);
+        if (plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "shared.h"
+
+namespace eng {
+
+struct Aabb {
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{-std::numeric_limits<float>::max()};
+
+    inline bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+    inline glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+
+    void merge(const Aabb& other);
+    float getSurfaceArea() const;
+};
+
+// bounds of the box after the transform, tight for the box but not for what's inside it
+Aabb transformAabb(const Aabb& box, const glm::mat4& transform);
+
+// six planes facing inwards, xyz the normal and w the distance
+struct Frustum {
+    std::array<glm::vec4, 6> planes;
+
+    // from projection * view, either depth range
+    static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+    bool intersects(const Aabb& box) const;
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include "geometry/geometry_buffer.h"
+
+namespace eng {
+
+namespace {
+
+VkBufferCreateInfo _geometryBufferInfo(VkDeviceSize size, VkBufferUsageFlags usage) {
+    VkBufferCreateInfo bufferInfo = vk::bufferCreateInfo();
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage;
+    return bufferInfo;
+}
+
+}  // namespace
+
+GeometryBuffer::GeometryBuffer(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, VkCommandPool commandPool, uint32_t vertexCapacity, uint32_t indexCapacity)
+    : m_device(device),
+      m_physicalDevice(physicalDevice),
+      m_commandPool(commandPool),
+      m_vertexBuffer(device, physicalDevice, _geometryBufferInfo(static_cast<VkDeviceSize>(vertexCapacity) * sizeof(EncodedVertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+      m_vertexRanges(vertexCapacity),
+      m_indices16{vk::IndexBuffer(device, physicalDevice, indexCapacity, VK_INDEX_TYPE_UINT16, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT), RangeAllocator(indexCapacity)},
+      m_indices32{vk::IndexBuffer(device, physicalDevice, indexCapacity, VK_INDEX_TYPE_UINT32, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT), RangeAllocator(indexCapacity)} {
+}
+
+MeshRange GeometryBuffer::add(const MeshData& mesh) {
+    std::span<const EncodedVertex> vertices = mesh.getVertices();
+    std::span<const uint32_t> indices = mesh.getIndices();
+
+    std::optional<uint64_t> vertexOffset = m_vertexRanges.allocate(vertices.size());
+    if (!vertexOffset) {
+        throw std::runtime_error("failed to allocate vertices in the geometry buffer!");
+    }
+
+    VkIndexType indexType = vk::IndexBuffer::selectIndexType(vertices.size());
+    IndexPool& pool = _getIndexPool(indexType);
+    std::optional<uint64_t> firstIndex = pool.ranges.allocate(indices.size());
+    if (!firstIndex) {
+        m_vertexRanges.free(*vertexOffset, vertices.size());
+        throw std::runtime_error("failed to allocate indices in the geometry buffer!");
+    }
+
+    // indices are relative to the mesh's first vertex, so the narrowing is lossless.
+    // the indices of every level of detail are one block.
+    std::vector<uint16_t> narrowed;
+    BufferUpload indexUpload{
+        .dst = &pool.buffer.getBuffer(),
+        .dstOffset = *firstIndex * pool.buffer.getIndexSize(),
+        .data = indices.data(),
+        .size = indices.size_bytes()};
+    if (indexType == VK_INDEX_TYPE_UINT16) {
+        narrowed.assign(indices.begin(), indices.end());
+        indexUpload.data = narrowed.data();
+        indexUpload.size = narrowed.size() * sizeof(uint16_t);
+    }
+
+    std::array<BufferUpload, 2> uploads = {
+        BufferUpload{
+            .dst = &m_vertexBuffer,
+            .dstOffset = *vertexOffset * sizeof(EncodedVertex),
+            .data = vertices.data(),
+            .size = vertices.size_bytes()},
+        indexUpload};
+    try {
+        upload(uploads);
+    } catch (...) {
+        m_vertexRanges.free(*vertexOffset, vertices.size());
+        pool.ranges.free(*firstIndex, indices.size());
+        throw;
+    }
+    m_meshCount++;
+
+    MeshRange range{
+        .firstIndex = static_cast<uint32_t>(*firstIndex),
+        .indexCount = static_cast<uint32_t>(indices.size()),
+        .vertexOffset = static_cast<int32_t>(*vertexOffset),
+        .vertexCount = static_cast<uint32_t>(vertices.size()),
+        .indexType = indexType,
+        .dequantization = mesh.getDequantization(),
+        .lodCount = 0};
+    for (const MeshLod& lod : mesh.getLods().first(std::min<size_t>(mesh.getLods().size(), MAX_MESH_LODS))) {
+        range.lods[range.lodCount++] = {.firstIndex = range.firstIndex + lod.firstIndex, .indexCount = lod.indexCount, .error = lod.error};
+    }
+    if (range.lodCount == 0) {
+        range.lods[range.lodCount++] = {.firstIndex = range.firstIndex, .indexCount = range.indexCount, .error = 0.0f};
+    }
+    return range;
+}
+
+void GeometryBuffer::remove(const MeshRange& range) {
+    m_vertexRanges.free(static_cast<uint64_t>(range.vertexOffset), range.vertexCount);
+    _getIndexPool(range.indexType).ranges.free(range.firstIndex, range.indexCount);
+    m_meshCount--;
+}
+
+MeshRange GeometryBuffer::addCopy(const MeshRange& mesh) {
+    std::optional<uint64_t> vertexOffset = m_vertexRanges.allocate(mesh.vertexCount);
+    if (!vertexOffset) {
+        throw std::runtime_error("failed to allocate vertices in the geometry buffer!");
+    }
+    m_copyCount++;
+
+    MeshRange copy = mesh;
+    copy.vertexOffset = static_cast<int32_t>(*vertexOffset);
+    return copy;
+}
+
+void GeometryBuffer::removeCopy(const MeshRange& copy) {
+    m_vertexRanges.free(static_cast<uint64_t>(copy.vertexOffset), copy.vertexCount);
+    m_copyCount--;
+}
+
+void GeometryBuffer::bind(const vk::CommandBuffer& cmd, VkIndexType indexType) const {
+    VkBuffer vertexBuffers[] = {m_vertexBuffer.get()};
+    VkDeviceSize offsets[] = {0};
+    cmd.bindVertexBuffers(vertexBuffers, offsets);
+    cmd.bindIndexBuffer(_getIndexPool(indexType).buffer);
+}
+
+void GeometryBuffer::draw(const vk::CommandBuffer& cmd, const MeshRange& range, uint32_t instanceCount, uint32_t firstInstance, uint32_t lod) const {
+    const MeshLod& level = range.lods[std::min(lod, range.lodCount - 1)];
+    cmd.drawIndexed(level.indexCount, instanceCount, level.firstIndex, range.vertexOffset, firstInstance);
+}
+
+void GeometryBuffer::drawIndirect(const vk::CommandBuffer& cmd, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount) const {
+    cmd.drawIndexedIndirect(buffer, offset, drawCount);
+}
+
+void GeometryBuffer::report() const {
+    std::cout << "geometry buffer: " << m_meshCount << " meshes, " << m_copyCount << " copies, "
+              << m_vertexRanges.getUsed() << "/" << m_vertexRanges.getCapacity() << " vertices, "
+              << m_indices16.ranges.getUsed() << "/" << m_indices16.ranges.getCapacity() << " 16 bit indices, "
+              << m_indices32.ranges.getUsed() << "/" << m_indices32.ranges.getCapacity() << " 32 bit indices" << std::endl;
+}
+
+const GeometryBuffer::IndexPool& GeometryBuffer::_getIndexPool(VkIndexType indexType) const {
+    return indexType == VK_INDEX_TYPE_UINT16 ? m_indices16 : m_indices32;
+}
+
+GeometryBuffer::IndexPool& GeometryBuffer::_getIndexPool(VkIndexType indexType) {
+    return indexType == VK_INDEX_TYPE_UINT16 ? m_indices16 : m_indices32;
+}
+
+void GeometryBuffer::upload(std::span<const BufferUpload> uploads) {
+    // each copy starts 4 byte aligned in the staging buffer
+    VkDeviceSize stagingSize = 0;
+    for (const BufferUpload& upload : uploads) {
+        stagingSize += (upload.size + 3) & ~VkDeviceSize(3);
+    }
+    if (stagingSize == 0) {
+        return;
+    }
+
+    VkBufferCreateInfo bufferInfo = vk::bufferCreateInfo();
+    bufferInfo.size = stagingSize;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    vk::Buffer stagingBuffer(m_device, m_physicalDevice, bufferInfo,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    VkCommandBufferAllocateInfo allocInfo = vk::commandBufferAllocateInfo();
+    allocInfo.commandPool = m_commandPool;
+    vk::CommandBuffer cmd(m_device, allocInfo);
+
+    VkCommandBufferBeginInfo beginInfo = vk::commandBufferBeginInfo();
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    cmd.begin(beginInfo);
+    VkDeviceSize stagingOffset = 0;
+    for (const BufferUpload& upload : uploads) {
+        if (upload.size == 0) {
+            continue;
+        }
+        stagingBuffer.setData(upload.data, upload.size, stagingOffset);
+        cmd.copyBuffer(stagingBuffer, *upload.dst, upload.size, stagingOffset, upload.dstOffset);
+        stagingOffset += (upload.size + 3) & ~VkDeviceSize(3);
+    }
+    cmd.end();
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    if (vkCreateFence(m_device.get(), &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create geometry upload fence!");
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cmd.get();
+
+    VkResult result = vkQueueSubmit(m_device.getGraphicsQueue(), 1, &submitInfo, fence);
+    if (result == VK_SUCCESS) {
+        result = vkWaitForFences(m_device.get(), 1, &fence, VK_TRUE, UINT64_MAX);
+    }
+    vkDestroyFence(m_device.get(), fence, nullptr);
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit geometry upload!");
+    }
+}
+
+void GeometryBuffer::upload(vk::Buffer& dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+    BufferUpload single{
+        .dst = &dst,
+        .dstOffset = dstOffset,
+        .data = data,
+        .size = size};
+    upload({&single, 1});
+}
+
+}  // namespace eng
\ No newline at end of file
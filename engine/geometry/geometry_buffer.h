@@ -0,0 +1,95 @@
+#pragma once
+
+#include "shared.h"
+#include "geometry/mesh_loader.h"
+#include "resource/range_allocator.h"
+#include "wrapper/vk/buffer.h"
+#include "wrapper/vk/command_buffer.h"
+#include "wrapper/vk/device.h"
+#include "wrapper/vk/index_buffer.h"
+#include "wrapper/vk/physical_device.h"
+
+namespace eng {
+
+// where a mesh lives in the geometry buffer, everything a draw needs
+struct MeshRange {
+    uint32_t firstIndex = 0;  // the indices of every level of detail
+    uint32_t indexCount = 0;
+    int32_t vertexOffset = 0;
+    uint32_t vertexCount = 0;
+    VkIndexType indexType = VK_INDEX_TYPE_UINT32;  // picks the index buffer the range lives in
+    MeshDequantization dequantization;
+    uint32_t lodCount = 1;
+    std::array<MeshLod, MAX_MESH_LODS> lods;  // first indices in the index buffer
+
+    inline std::span<const MeshLod> getLods() const { return {lods.data(), lodCount}; }
+};
+
+// a copy into a device local buffer, data is read when the upload is recorded
+struct BufferUpload {
+    vk::Buffer* dst = nullptr;
+    VkDeviceSize dstOffset = 0;
+    const void* data = nullptr;
+    VkDeviceSize size = 0;
+};
+
+// one vertex buffer and an index buffer per index type shared by every mesh,
+// sub-allocated per mesh. meshes that fit 16 bit indices use them, bigger ones
+// get 32 bit indices instead of being split. drawing sorted by index type binds
+// each buffer once, and the ranges can also be written into indirect draws. the
+// vertex buffer is also a storage buffer, compute passes write vertices into it.
+class GeometryBuffer {
+public:
+    // indexCapacity applies to each of the two index buffers
+    GeometryBuffer(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, VkCommandPool commandPool, uint32_t vertexCapacity, uint32_t indexCapacity);
+
+    GeometryBuffer(const GeometryBuffer&) = delete;
+    GeometryBuffer& operator=(const GeometryBuffer&) = delete;
+
+    // uploads the mesh and waits for the copy, meant for load time
+    MeshRange add(const MeshData& mesh);
+    // the range must no longer be used by a frame in flight
+    void remove(const MeshRange& range);
+    // reserves vertices for a copy of the mesh written on the gpu, skinned for instance.
+    // the copy shares the mesh's indices and must be removed before it.
+    MeshRange addCopy(const MeshRange& mesh);
+    void removeCopy(const MeshRange& copy);
+    // copies through one staging buffer in a single submit and waits on its fence, meant for load time
+    void upload(std::span<const BufferUpload> uploads);
+    void upload(vk::Buffer& dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+    // binds the vertex buffer and the index buffer of the given type
+    void bind(const vk::CommandBuffer& cmd, VkIndexType indexType) const;
+    // the range's index type must be the bound one, levels past the last draw the last
+    void draw(const vk::CommandBuffer& cmd, const MeshRange& range, uint32_t instanceCount = 1, uint32_t firstInstance = 0, uint32_t lod = 0) const;
+    // VkDrawIndexedIndirectCommands of ranges in the bound index buffer
+    void drawIndirect(const vk::CommandBuffer& cmd, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount) const;
+
+    inline const vk::Buffer& getVertexBuffer() const { return m_vertexBuffer; }
+    inline const vk::IndexBuffer& getIndexBuffer(VkIndexType indexType) const { return _getIndexPool(indexType).buffer; }
+
+    void report() const;
+
+private:
+    const vk::Device& m_device;
+    const vk::PhysicalDevice& m_physicalDevice;
+    VkCommandPool m_commandPool;
+
+    struct IndexPool {
+        vk::IndexBuffer buffer;
+        RangeAllocator ranges;  // in indices
+    };
+
+    vk::Buffer m_vertexBuffer;
+    RangeAllocator m_vertexRanges;  // in vertices
+    IndexPool m_indices16;
+    IndexPool m_indices32;
+    uint32_t m_meshCount = 0;
+    uint32_t m_copyCount = 0;
+
+private:
+    const IndexPool& _getIndexPool(VkIndexType indexType) const;
+    IndexPool& _getIndexPool(VkIndexType indexType);
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,532 @@
+#include "geometry/gltf.h"
+
+#include <charconv>
+#include <cstring>
+#include <glm/gtc/quaternion.hpp>
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t GLB_MAGIC = 0x46546c67;  // "glTF"
+constexpr uint32_t GLB_CHUNK_JSON = 0x4e4f534a;
+constexpr uint32_t GLB_CHUNK_BIN = 0x004e4942;
+
+constexpr uint32_t COMPONENT_BYTE = 5120;
+constexpr uint32_t COMPONENT_UNSIGNED_BYTE = 5121;
+constexpr uint32_t COMPONENT_SHORT = 5122;
+constexpr uint32_t COMPONENT_UNSIGNED_SHORT = 5123;
+constexpr uint32_t COMPONENT_UNSIGNED_INT = 5125;
+constexpr uint32_t COMPONENT_FLOAT = 5126;
+constexpr uint32_t MODE_TRIANGLES = 4;
+
+// just enough json for the gltf document, numbers as doubles and no escapes beyond
+// the simple ones
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> elements;
+    std::vector<std::string> keys;  // object members, parallel to elements
+
+    const JsonValue* find(std::string_view key) const {
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (keys[i] == key) {
+                return &elements[i];
+            }
+        }
+        return nullptr;
+    }
+
+    const JsonValue& operator[](std::string_view key) const {
+        const JsonValue* value = find(key);
+        if (value == nullptr) {
+            throw std::runtime_error("gltf is missing \"" + std::string(key) + "\"!");
+        }
+        return *value;
+    }
+
+    const JsonValue& at(size_t index) const {
+        if (type != Type::Array || index >= elements.size()) {
+            throw std::runtime_error("gltf index out of range!");
+        }
+        return elements[index];
+    }
+
+    uint32_t getUint(std::string_view key, uint32_t fallback) const {
+        const JsonValue* value = find(key);
+        return value != nullptr && value->type == Type::Number ? static_cast<uint32_t>(value->number) : fallback;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(std::string_view text) : m_text(text) {}
+
+    JsonValue parse() {
+        JsonValue value = _value();
+        _skipSpaces();
+        if (m_position != m_text.size()) {
+            _fail();
+        }
+        return value;
+    }
+
+private:
+    std::string_view m_text;
+    size_t m_position = 0;
+
+private:
+    [[noreturn]] void _fail() const {
+        throw std::runtime_error("invalid gltf json at offset " + std::to_string(m_position) + "!");
+    }
+
+    void _skipSpaces() {
+        while (m_position < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_position]))) {
+            m_position++;
+        }
+    }
+
+    bool _consume(char c) {
+        _skipSpaces();
+        if (m_position < m_text.size() && m_text[m_position] == c) {
+            m_position++;
+            return true;
+        }
+        return false;
+    }
+
+    void _expect(char c) {
+        if (!_consume(c)) {
+            _fail();
+        }
+    }
+
+    bool _literal(std::string_view word) {
+        if (m_text.substr(m_position, word.size()) == word) {
+            m_position += word.size();
+            return true;
+        }
+        return false;
+    }
+
+    JsonValue _value() {
+        _skipSpaces();
+        if (m_position >= m_text.size()) {
+            _fail();
+        }
+
+        JsonValue value;
+        char c = m_text[m_position];
+        if (c == '{') {
+            value.type = JsonValue::Type::Object;
+            m_position++;
+            if (!_consume('}')) {
+                do {
+                    _skipSpaces();
+                    value.keys.push_back(_string());
+                    _expect(':');
+                    value.elements.push_back(_value());
+                } while (_consume(','));
+                _expect('}');
+            }
+        } else if (c == '[') {
+            value.type = JsonValue::Type::Array;
+            m_position++;
+            if (!_consume(']')) {
+                do {
+                    value.elements.push_back(_value());
+                } while (_consume(','));
+                _expect(']');
+            }
+        } else if (c == '"') {
+            value.type = JsonValue::Type::String;
+            value.string = _string();
+        } else if (_literal("true") || _literal("false")) {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = c == 't';
+        } else if (_literal("null")) {
+            value.type = JsonValue::Type::Null;
+        } else {
+            value.type = JsonValue::Type::Number;
+            auto [end, error] = std::from_chars(m_text.data() + m_position, m_text.data() + m_text.size(), value.number);
+            if (error != std::errc()) {
+                _fail();
+            }
+            m_position = end - m_text.data();
+        }
+
+        return value;
+    }
+
+    std::string _string() {
+        if (m_position >= m_text.size() || m_text[m_position] != '"') {
+            _fail();
+        }
+        m_position++;
+
+        std::string result;
+        while (m_position < m_text.size() && m_text[m_position] != '"') {
+            char c = m_text[m_position++];
+            if (c == '\\' && m_position < m_text.size()) {
+                char escaped = m_text[m_position++];
+                switch (escaped) {
+                    case 'n': c = '\n'; break;
+                    case 't': c = '\t'; break;
+                    case 'r': c = '\r'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'u': _fail();  // names and uris in practice never need it
+                    default: c = escaped; break;
+                }
+            }
+            result.push_back(c);
+        }
+
+        if (m_position >= m_text.size()) {
+            _fail();
+        }
+        m_position++;
+        return result;
+    }
+};
+
+std::vector<char> _decodeBase64(std::string_view text) {
+    auto decode = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    };
+
+    std::vector<char> data;
+    data.reserve(text.size() * 3 / 4);
+    uint32_t bits = 0;
+    int bitCount = 0;
+    for (char c : text) {
+        int value = decode(c);
+        if (value < 0) {
+            break;  // padding
+        }
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        bitCount += 6;
+        if (bitCount >= 8) {
+            bitCount -= 8;
+            data.push_back(static_cast<char>((bits >> bitCount) & 0xff));
+        }
+    }
+
+    return data;
+}
+
+struct Accessor {
+    const char* data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    uint32_t componentType = 0;
+    uint32_t componentCount = 0;
+    bool normalized = false;
+
+    float getFloat(size_t element, uint32_t component) const {
+        const char* source = data + element * stride;
+        switch (componentType) {
+            case COMPONENT_FLOAT: return _read<float>(source, component);
+            case COMPONENT_UNSIGNED_BYTE: return _normalize(_read<uint8_t>(source, component), 255.0f);
+            case COMPONENT_UNSIGNED_SHORT: return _normalize(_read<uint16_t>(source, component), 65535.0f);
+            case COMPONENT_BYTE: return std::max(_normalize(_read<int8_t>(source, component), 127.0f), -1.0f);
+            case COMPONENT_SHORT: return std::max(_normalize(_read<int16_t>(source, component), 32767.0f), -1.0f);
+            case COMPONENT_UNSIGNED_INT: return static_cast<float>(_read<uint32_t>(source, component));
+            default: throw std::runtime_error("unsupported gltf component type!");
+        }
+    }
+
+    uint32_t getIndex(size_t element) const {
+        const char* source = data + element * stride;
+        switch (componentType) {
+            case COMPONENT_UNSIGNED_BYTE: return _read<uint8_t>(source, 0);
+            case COMPONENT_UNSIGNED_SHORT: return _read<uint16_t>(source, 0);
+            case COMPONENT_UNSIGNED_INT: return _read<uint32_t>(source, 0);
+            default: throw std::runtime_error("unsupported gltf index type!");
+        }
+    }
+
+private:
+    template <typename T>
+    static T _read(const char* source, uint32_t component) {
+        T value;
+        memcpy(&value, source + component * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    float _normalize(float value, float max) const {
+        return normalized ? value / max : value;
+    }
+};
+
+class GltfDocument {
+public:
+    GltfDocument(std::span<const char> file, const GltfBufferLoader& loadBuffer) {
+        std::string_view json(file.data(), file.size());
+        std::span<const char> binaryChunk;
+
+        uint32_t magic = 0;
+        if (file.size() >= sizeof(magic)) {
+            memcpy(&magic, file.data(), sizeof(magic));
+        }
+        if (magic == GLB_MAGIC) {
+            // 12 byte header, then chunks of length | type | data
+            json = {};
+            for (size_t offset = 12; offset + 8 <= file.size();) {
+                uint32_t chunkLength, chunkType;
+                memcpy(&chunkLength, file.data() + offset, sizeof(chunkLength));
+                memcpy(&chunkType, file.data() + offset + 4, sizeof(chunkType));
+                if (offset + 8 + chunkLength > file.size()) {
+                    throw std::runtime_error("truncated glb chunk!");
+                }
+
+                const char* chunk = file.data() + offset + 8;
+                if (chunkType == GLB_CHUNK_JSON) {
+                    json = std::string_view(chunk, chunkLength);
+                } else if (chunkType == GLB_CHUNK_BIN) {
+                    binaryChunk = std::span<const char>(chunk, chunkLength);
+                }
+                offset += 8 + chunkLength;
+            }
+        }
+
+        m_root = JsonParser(json).parse();
+
+        if (const JsonValue* buffers = m_root.find("buffers")) {
+            for (const JsonValue& buffer : buffers->elements) {
+                const JsonValue* uri = buffer.find("uri");
+                if (uri == nullptr) {
+                    m_buffers.push_back(binaryChunk);
+                    continue;
+                }
+
+                constexpr std::string_view BASE64_MARKER = ";base64,";
+                size_t marker = uri->string.find(BASE64_MARKER);
+                if (uri->string.starts_with("data:") && marker != std::string::npos) {
+                    m_storage.push_back(Asset(_decodeBase64(std::string_view(uri->string).substr(marker + BASE64_MARKER.size()))));
+                } else {
+                    m_storage.push_back(loadBuffer(uri->string));
+                }
+                m_buffers.push_back(m_storage.back().getSpan());
+            }
+        }
+    }
+
+    inline const JsonValue& getRoot() const { return m_root; }
+
+    Accessor getAccessor(uint32_t index) const {
+        const JsonValue& accessor = m_root["accessors"].at(index);
+        if (accessor.find("sparse") != nullptr) {
+            throw std::runtime_error("sparse gltf accessors are not supported!");
+        }
+
+        static const std::pair<std::string_view, uint32_t> TYPES[] = {
+            {"SCALAR", 1}, {"VEC2", 2}, {"VEC3", 3}, {"VEC4", 4}};
+        const std::string& type = accessor["type"].string;
+        auto found = std::find_if(std::begin(TYPES), std::end(TYPES), [&](const auto& entry) { return entry.first == type; });
+        if (found == std::end(TYPES)) {
+            throw std::runtime_error("unsupported gltf accessor type " + type + "!");
+        }
+
+        Accessor result{
+            .count = accessor.getUint("count", 0),
+            .componentType = accessor.getUint("componentType", 0),
+            .componentCount = found->second};
+        const JsonValue* normalized = accessor.find("normalized");
+        result.normalized = normalized != nullptr && normalized->boolean;
+
+        uint32_t componentSize = result.componentType == COMPONENT_FLOAT || result.componentType == COMPONENT_UNSIGNED_INT ? 4
+                               : result.componentType == COMPONENT_SHORT || result.componentType == COMPONENT_UNSIGNED_SHORT ? 2
+                                                                                                                              : 1;
+        size_t elementSize = static_cast<size_t>(componentSize) * result.componentCount;
+
+        const JsonValue& view = m_root["bufferViews"].at(accessor["bufferView"].number);
+        uint32_t bufferIndex = view.getUint("buffer", 0);
+        if (bufferIndex >= m_buffers.size()) {
+            throw std::runtime_error("gltf buffer view references a missing buffer!");
+        }
+
+        std::span<const char> buffer = m_buffers[bufferIndex];
+        size_t offset = static_cast<size_t>(view.getUint("byteOffset", 0)) + accessor.getUint("byteOffset", 0);
+        result.stride = view.getUint("byteStride", static_cast<uint32_t>(elementSize));
+        if (result.count > 0 && offset + (result.count - 1) * result.stride + elementSize > buffer.size()) {
+            throw std::runtime_error("gltf accessor reads past the end of its buffer!");
+        }
+
+        result.data = buffer.data() + offset;
+        return result;
+    }
+
+private:
+    JsonValue m_root;
+    std::vector<Asset> m_storage;
+    std::vector<std::span<const char>> m_buffers;
+};
+
+void _appendPrimitive(const GltfDocument& document, const JsonValue& primitive, const glm::mat4& transform, Mesh& mesh) {
+    if (primitive.getUint("mode", MODE_TRIANGLES) != MODE_TRIANGLES) {
+        return;
+    }
+
+    const JsonValue& attributes = primitive["attributes"];
+    Accessor positions = document.getAccessor(attributes["POSITION"].number);
+    if (positions.componentCount < 3) {
+        throw std::runtime_error("gltf attribute POSITION is not a vec3!");
+    }
+
+    uint32_t baseVertex = static_cast<uint32_t>(mesh.vertices.size());
+    mesh.vertices.resize(baseVertex + positions.count, MeshVertex{glm::vec3(0.0f), glm::vec3(0.0f), glm::vec2(0.0f), glm::vec4(1.0f)});
+    MeshVertex* vertices = mesh.vertices.data() + baseVertex;
+
+    for (size_t i = 0; i < positions.count; i++) {
+        vertices[i].position = glm::vec3(positions.getFloat(i, 0), positions.getFloat(i, 1), positions.getFloat(i, 2));
+    }
+
+    // optional attributes must match the position count
+    auto read = [&](const char* name, uint32_t minComponents, auto assign) {
+        const JsonValue* index = attributes.find(name);
+        if (index == nullptr) {
+            return;
+        }
+
+        Accessor accessor = document.getAccessor(index->number);
+        if (accessor.count != positions.count || accessor.componentCount < minComponents) {
+            throw std::runtime_error(std::string("gltf attribute ") + name + " does not match the positions!");
+        }
+        for (size_t i = 0; i < accessor.count; i++) {
+            assign(vertices[i], accessor, i);
+        }
+    };
+
+    read("NORMAL", 3, [](MeshVertex& vertex, const Accessor& accessor, size_t i) {
+        vertex.normal = glm::vec3(accessor.getFloat(i, 0), accessor.getFloat(i, 1), accessor.getFloat(i, 2));
+    });
+    read("TEXCOORD_0", 2, [](MeshVertex& vertex, const Accessor& accessor, size_t i) {
+        vertex.uv = glm::vec2(accessor.getFloat(i, 0), accessor.getFloat(i, 1));
+    });
+    read("COLOR_0", 3, [](MeshVertex& vertex, const Accessor& accessor, size_t i) {
+        float alpha = accessor.componentCount == 4 ? accessor.getFloat(i, 3) : 1.0f;
+        vertex.color = glm::vec4(accessor.getFloat(i, 0), accessor.getFloat(i, 1), accessor.getFloat(i, 2), alpha);
+    });
+
+    // into the space of the scene, normals by the inverse transpose
+    glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+    for (size_t i = 0; i < positions.count; i++) {
+        vertices[i].position = glm::vec3(transform * glm::vec4(vertices[i].position, 1.0f));
+        glm::vec3 normal = normalTransform * vertices[i].normal;
+        float length = glm::length(normal);
+        vertices[i].normal = length > 0.0f ? normal / length : normal;
+    }
+
+    size_t firstIndex = mesh.indices.size();
+    if (const JsonValue* indicesIndex = primitive.find("indices")) {
+        Accessor indices = document.getAccessor(indicesIndex->number);
+        mesh.indices.reserve(mesh.indices.size() + indices.count);
+        for (size_t i = 0; i < indices.count; i++) {
+            uint32_t index = indices.getIndex(i);
+            if (index >= positions.count) {
+                throw std::runtime_error("gltf index out of range!");
+            }
+            mesh.indices.push_back(baseVertex + index);
+        }
+    } else {
+        for (uint32_t i = 0; i < positions.count; i++) {
+            mesh.indices.push_back(baseVertex + i);
+        }
+    }
+
+    // a mirroring transform turns the triangles around
+    if (glm::determinant(glm::mat3(transform)) < 0.0f) {
+        for (size_t i = firstIndex; i + 2 < mesh.indices.size(); i += 3) {
+            std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+        }
+    }
+}
+
+// a column major matrix, or translation * rotation * scale
+glm::mat4 _getLocalTransform(const JsonValue& node) {
+    auto component = [](const JsonValue& array, size_t index) { return static_cast<float>(array.at(index).number); };
+
+    glm::mat4 transform(1.0f);
+    if (const JsonValue* matrix = node.find("matrix")) {
+        for (int column = 0; column < 4; column++) {
+            for (int row = 0; row < 4; row++) {
+                transform[column][row] = component(*matrix, column * 4 + row);
+            }
+        }
+        return transform;
+    }
+
+    if (const JsonValue* rotation = node.find("rotation")) {
+        transform = glm::mat4_cast(glm::quat(component(*rotation, 3), component(*rotation, 0), component(*rotation, 1), component(*rotation, 2)));
+    }
+    if (const JsonValue* scale = node.find("scale")) {
+        for (int axis = 0; axis < 3; axis++) {
+            transform[axis] *= component(*scale, axis);
+        }
+    }
+    if (const JsonValue* translation = node.find("translation")) {
+        transform[3] = glm::vec4(component(*translation, 0), component(*translation, 1), component(*translation, 2), 1.0f);
+    }
+    return transform;
+}
+
+void _appendNode(const GltfDocument& document, size_t index, const glm::mat4& parentTransform, size_t depth, Mesh& mesh) {
+    const JsonValue& nodes = document.getRoot()["nodes"];
+    if (depth > nodes.elements.size()) {
+        throw std::runtime_error("gltf node hierarchy has a cycle!");
+    }
+
+    const JsonValue& node = nodes.at(index);
+    glm::mat4 transform = parentTransform * _getLocalTransform(node);
+    if (const JsonValue* meshIndex = node.find("mesh")) {
+        for (const JsonValue& primitive : document.getRoot()["meshes"].at(meshIndex->number)["primitives"].elements) {
+            _appendPrimitive(document, primitive, transform, mesh);
+        }
+    }
+    if (const JsonValue* children = node.find("children")) {
+        for (const JsonValue& child : children->elements) {
+            _appendNode(document, child.number, transform, depth + 1, mesh);
+        }
+    }
+}
+
+}  // namespace
+
+Mesh parseGltf(std::span<const char> file, const GltfBufferLoader& loadBuffer) {
+    GltfDocument document(file, loadBuffer);
+
+    Mesh mesh;
+    const JsonValue& root = document.getRoot();
+    if (const JsonValue* scenes = root.find("scenes")) {
+        const JsonValue& scene = scenes->at(root.getUint("scene", 0));
+        if (const JsonValue* nodes = scene.find("nodes")) {
+            for (const JsonValue& node : nodes->elements) {
+                _appendNode(document, node.number, glm::mat4(1.0f), 0, mesh);
+            }
+        }
+    } else if (const JsonValue* meshes = root.find("meshes")) {
+        // without a scene nothing places the meshes, they are taken as they are
+        for (const JsonValue& gltfMesh : meshes->elements) {
+            for (const JsonValue& primitive : gltfMesh["primitives"].elements) {
+                _appendPrimitive(document, primitive, glm::mat4(1.0f), mesh);
+            }
+        }
+    }
+
+    if (mesh.indices.size() % 3 != 0) {
+        throw std::runtime_error("gltf triangle list with a partial triangle!");
+    }
+    return mesh;
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <functional>
+#include <span>
+#include "shared.h"
+#include "geometry/mesh.h"
+#include "resource/asset_store.h"
+
+namespace eng {
+
+// loads a buffer referenced by uri, relative to the gltf file
+using GltfBufferLoader = std::function<Asset(const std::string& uri)>;
+
+// gltf 2.0, either a .glb or json with external or base64 buffers. the triangle
+// primitives the nodes of the default scene place are merged into one with the node
+// transforms applied, a file without scenes merges every mesh as it is.
+Mesh parseGltf(std::span<const char> file, const GltfBufferLoader& loadBuffer);
+
+}  // namespace eng
\ No newline at end of file
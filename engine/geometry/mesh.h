@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "shared.h"
+
+namespace eng {
+
+// full precision vertex as imported, before any encoding
+struct MeshVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+    glm::vec4 color;
+};
+
+constexpr uint32_t MAX_MESH_LODS = 4;
+
+// a level of detail, a run of the mesh's indices over the same vertices as the others
+struct MeshLod {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f;  // how far the surface may be from lod 0, in model units
+};
+
+struct Mesh {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "geometry/mesh_encoder.h"
+
+#include <cmath>
+
+namespace eng {
+
+namespace {
+
+// per component scale that maps [min, max] to [0, 1], zero for a flat axis
+template <typename Vec>
+Vec _inverseExtent(const Vec& min, const Vec& max) {
+    Vec inverse = max - min;
+    for (size_t i = 0; i < sizeof(Vec) / sizeof(float); i++) {
+        inverse[i] = inverse[i] > 0.0f ? 1.0f / inverse[i] : 0.0f;
+    }
+    return inverse;
+}
+
+}  // namespace
+
+EncodedMesh encodeMesh(const Mesh& mesh) {
+    EncodedMesh encoded;
+    encoded.indices = mesh.indices;
+    encoded.lods = {{.firstIndex = 0, .indexCount = static_cast<uint32_t>(mesh.indices.size()), .error = 0.0f}};
+    if (mesh.vertices.empty()) {
+        return encoded;
+    }
+
+    glm::vec3 positionMin = mesh.vertices[0].position;
+    glm::vec3 positionMax = positionMin;
+    glm::vec2 uvMin = mesh.vertices[0].uv;
+    glm::vec2 uvMax = uvMin;
+    for (const MeshVertex& vertex : mesh.vertices) {
+        positionMin = glm::min(positionMin, vertex.position);
+        positionMax = glm::max(positionMax, vertex.position);
+        uvMin = glm::min(uvMin, vertex.uv);
+        uvMax = glm::max(uvMax, vertex.uv);
+    }
+
+    glm::vec3 positionInverse = _inverseExtent(positionMin, positionMax);
+    glm::vec2 uvInverse = _inverseExtent(uvMin, uvMax);
+
+    encoded.dequantization.positionOffset = glm::vec4(positionMin, 0.0f);
+    encoded.dequantization.positionScale = glm::vec4(positionMax - positionMin, 0.0f);
+    encoded.dequantization.uvTransform = glm::vec4(uvMin.x, uvMin.y, uvMax.x - uvMin.x, uvMax.y - uvMin.y);
+
+    encoded.vertices.reserve(mesh.vertices.size());
+    for (const MeshVertex& vertex : mesh.vertices) {
+        float normalLength = glm::length(vertex.normal);
+        glm::vec3 normal = normalLength > 0.0f ? vertex.normal / normalLength : glm::vec3(0.0f);
+
+        encoded.vertices.emplace_back(
+            Unorm16x4((vertex.position - positionMin) * positionInverse),
+            Snorm8x4(normal),
+            Unorm16x2((vertex.uv - uvMin) * uvInverse),
+            Unorm8x4(vertex.color));
+    }
+
+    return encoded;
+}
+
+MeshVertex decodeVertex(const EncodedVertex& vertex, const MeshDequantization& dequantization) {
+    const Unorm16x4& position = vertex.get<0>();
+    const Snorm8x4& normal = vertex.get<1>();
+    const Unorm16x2& uv = vertex.get<2>();
+    const Unorm8x4& color = vertex.get<3>();
+
+    const glm::vec4& offset = dequantization.positionOffset;
+    const glm::vec4& scale = dequantization.positionScale;
+    const glm::vec4& uvTransform = dequantization.uvTransform;
+
+    return MeshVertex{
+        .position = glm::vec3(offset.x + position.get(0) * scale.x, offset.y + position.get(1) * scale.y, offset.z + position.get(2) * scale.z),
+        .normal = glm::vec3(normal.get(0), normal.get(1), normal.get(2)),
+        .uv = glm::vec2(uvTransform.x + uv.get(0) * uvTransform.z, uvTransform.y + uv.get(1) * uvTransform.w),
+        .color = glm::vec4(color.get(0), color.get(1), color.get(2), color.get(3))};
+}
+
+Aabb getPositionBounds(const MeshDequantization& dequantization) {
+    glm::vec3 offset(dequantization.positionOffset.x, dequantization.positionOffset.y, dequantization.positionOffset.z);
+    glm::vec3 scale(dequantization.positionScale.x, dequantization.positionScale.y, dequantization.positionScale.z);
+    return {offset, offset + scale};
+}
+
+EncodingError measureEncodingError(const Mesh& mesh, const EncodedMesh& encoded) {
+    EncodingError error;
+    double squaredPositionSum = 0.0;
+
+    for (size_t i = 0; i < mesh.vertices.size(); i++) {
+        const MeshVertex& original = mesh.vertices[i];
+        MeshVertex decoded = decodeVertex(encoded.vertices[i], encoded.dequantization);
+
+        float positionError = glm::distance(original.position, decoded.position);
+        error.maxPosition = std::max(error.maxPosition, positionError);
+        squaredPositionSum += static_cast<double>(positionError) * positionError;
+
+        if (glm::length(original.normal) > 0.0f && glm::length(decoded.normal) > 0.0f) {
+            float cosine = std::clamp(glm::dot(glm::normalize(original.normal), glm::normalize(decoded.normal)), -1.0f, 1.0f);
+            error.maxNormalDegrees = std::max(error.maxNormalDegrees, glm::degrees(std::acos(cosine)));
+        }
+
+        error.maxUv = std::max(error.maxUv, glm::distance(original.uv, decoded.uv));
+        for (int c = 0; c < 4; c++) {
+            float color = std::clamp(original.color[c], 0.0f, 1.0f);
+            error.maxColor = std::max(error.maxColor, std::abs(color - decoded.color[c]));
+        }
+    }
+
+    if (!mesh.vertices.empty()) {
+        error.rmsPosition = static_cast<float>(std::sqrt(squaredPositionSum / mesh.vertices.size()));
+    }
+    return error;
+}
+
+void reportEncoding(const Mesh& mesh, const EncodedMesh& encoded) {
+    EncodingError error = measureEncodingError(mesh, encoded);
+    glm::vec3 extent(encoded.dequantization.positionScale.x, encoded.dequantization.positionScale.y, encoded.dequantization.positionScale.z);
+    float diagonal = glm::length(extent);
+
+    std::cout << "mesh encoding: " << mesh.vertices.size() << " vertices, "
+              << sizeof(MeshVertex) << " -> " << sizeof(EncodedVertex) << " bytes/vertex ("
+              << static_cast<float>(sizeof(MeshVertex)) / sizeof(EncodedVertex) << "x smaller)" << std::endl;
+    std::cout << "    position error max " << error.maxPosition << " rms " << error.rmsPosition;
+    if (diagonal > 0.0f) {
+        std::cout << " (" << error.maxPosition / diagonal * 100.0f << "% of the bounds)";
+    }
+    std::cout << ", normal " << error.maxNormalDegrees << " deg, uv " << error.maxUv << ", color " << error.maxColor << std::endl;
+}
+
+}  // namespace eng
\ No newline at end of file
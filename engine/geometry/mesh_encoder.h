@@ -0,0 +1,50 @@
+#pragma once
+
+#include "shared.h"
+#include "geometry/bounds.h"
+#include "geometry/mesh.h"
+#include "geometry/vertex_layout.h"
+
+namespace eng {
+
+// position and uv are normalized to the bounds of the mesh, normal and color are
+// stored directly. 20 bytes against the 48 of a MeshVertex.
+using EncodedVertex = VertexLayout<Unorm16x4,  // position, w unused
+                                   Snorm8x4,   // normal, w unused
+                                   Unorm16x2,  // uv
+                                   Unorm8x4>;  // color
+
+// turns the normalized attributes back into model space. pushed with every draw,
+// the layout matches the DrawConstants block of the shaders.
+struct MeshDequantization {
+    glm::vec4 positionOffset{0.0f};  // w unused
+    glm::vec4 positionScale{1.0f};   // w unused
+    glm::vec4 uvTransform{0.0f, 0.0f, 1.0f, 1.0f};  // offset in xy, scale in zw
+};
+
+struct EncodedMesh {
+    std::vector<EncodedVertex> vertices;
+    std::vector<uint32_t> indices;  // every level of detail, one after the other
+    std::vector<MeshLod> lods;
+    MeshDequantization dequantization;
+};
+
+struct EncodingError {
+    float maxPosition = 0.0f;  // model units
+    float rmsPosition = 0.0f;
+    float maxNormalDegrees = 0.0f;
+    float maxUv = 0.0f;
+    float maxColor = 0.0f;
+};
+
+// all of the mesh's indices are a single level of detail
+EncodedMesh encodeMesh(const Mesh& mesh);
+MeshVertex decodeVertex(const EncodedVertex& vertex, const MeshDequantization& dequantization);
+
+// model space bounds of the positions, the quantization grid spans exactly those
+Aabb getPositionBounds(const MeshDequantization& dequantization);
+
+EncodingError measureEncodingError(const Mesh& mesh, const EncodedMesh& encoded);
+void reportEncoding(const Mesh& mesh, const EncodedMesh& encoded);
+
+}  // namespace eng
\ No newline at end of file
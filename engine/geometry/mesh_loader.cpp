@@ -0,0 +1,224 @@
+#include "geometry/mesh_loader.h"
+
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+#include "geometry/gltf.h"
+#include "geometry/mesh_optimizer.h"
+#include "geometry/mesh_simplifier.h"
+#include "geometry/obj.h"
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t CACHE_MAGIC = 0x4853454d;  // "MESH"
+constexpr uint32_t CACHE_VERSION = 3;         // bump whenever the encoding or the optimization passes change
+
+// header | vertices | indices, the vertex block is padded to keep the indices aligned
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint64_t sourceKey;
+    uint32_t vertexStride;
+    uint32_t lodCount;
+    MeshDequantization dequantization;
+    MeshLod lods[MAX_MESH_LODS];  // ranges of the index block
+};
+
+static_assert(sizeof(CacheHeader) % alignof(uint32_t) == 0 && sizeof(CacheHeader) % alignof(EncodedVertex) == 0,
+              "mesh cache blocks must stay aligned");
+
+// fnv-1a, value continues an earlier hash
+uint64_t _hash(const void* data, size_t size, uint64_t value = 0xcbf29ce484222325ull) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        value ^= bytes[i];
+        value *= 0x100000001b3ull;
+    }
+
+    return value;
+}
+
+size_t _getIndicesOffset(uint32_t vertexCount) {
+    size_t end = sizeof(CacheHeader) + static_cast<size_t>(vertexCount) * sizeof(EncodedVertex);
+    return (end + alignof(uint32_t) - 1) & ~(alignof(uint32_t) - 1);
+}
+
+std::string _getExtension(const std::string& name) {
+    std::string extension = std::filesystem::path(name).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+}  // namespace
+
+MeshData::MeshData(std::unique_ptr<MappedFile> file, std::span<const EncodedVertex> vertices, std::span<const uint32_t> indices, std::span<const MeshLod> lods,
+                   const MeshDequantization& dequantization)
+    : m_file(std::move(file)), m_vertices(vertices), m_indices(indices), m_lods(lods.begin(), lods.end()), m_dequantization(dequantization) {}
+
+MeshData::MeshData(EncodedMesh&& mesh)
+    : m_storage(std::move(mesh)), m_vertices(m_storage.vertices), m_indices(m_storage.indices), m_lods(m_storage.lods), m_dequantization(m_storage.dequantization) {}
+
+MeshLoader::MeshLoader(const AssetStore& assets, const std::string& cacheDirectory)
+    : m_assets(assets), m_cacheDirectory(RESOURCE_DIR + cacheDirectory) {
+    std::error_code error;
+    std::filesystem::create_directories(m_cacheDirectory, error);
+    if (error) {
+        std::cerr << "failed to create mesh cache directory: " << m_cacheDirectory << " (" << error.message() << ")" << std::endl;
+    }
+}
+
+MeshData MeshLoader::load(const std::string& name) const {
+    // keyed by the name and the stamp of the source, so a cached mesh is found without
+    // reading the source. external gltf buffers are not part of the key, edits to a .bin
+    // alone need the cache entry removed.
+    AssetStamp stamp = m_assets.getStamp(name);
+    uint64_t key = _hash(&stamp, sizeof(stamp), _hash(name.data(), name.size()));
+    std::string path = _getPath(key);
+
+    MeshData cached = _mapCached(path, key);
+    if (cached.isMapped()) {
+        return cached;
+    }
+
+    Asset source = m_assets.load(name);
+    auto start = std::chrono::high_resolution_clock::now();
+    Mesh mesh = _import(name, source);
+    size_t importedVertices = mesh.vertices.size();
+
+    weldVertices(mesh);
+    VertexCacheStats before = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+    optimizeVertexCache(mesh);
+    VertexCacheStats optimized = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+    optimizeOverdraw(mesh);
+    optimizeVertexFetch(mesh);
+    VertexCacheStats after = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+    std::vector<MeshLod> lods = generateLods(mesh);
+
+    EncodedMesh encoded = encodeMesh(mesh);
+    encoded.lods = lods;
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "mesh " << name << ": " << lods[0].indexCount / 3 << " triangles, "
+              << importedVertices << " -> " << mesh.vertices.size() << " vertices after welding, acmr "
+              << before.acmr << " -> " << optimized.acmr << " (" << after.acmr << " after overdraw ordering), imported in "
+              << std::chrono::duration<float, std::milli>(end - start).count() << " ms" << std::endl;
+    std::cout << "    " << lods.size() << " lods:";
+    for (const MeshLod& lod : lods) {
+        std::cout << " " << lod.indexCount / 3 << " triangles (error " << lod.error << ")";
+    }
+    std::cout << std::endl;
+    reportEncoding(mesh, encoded);
+
+    if (_storeCached(path, key, encoded)) {
+        cached = _mapCached(path, key);
+        if (cached.isMapped()) {
+            return cached;
+        }
+    }
+
+    return MeshData(std::move(encoded));
+}
+
+Mesh MeshLoader::_import(const std::string& name, const Asset& source) const {
+    std::string extension = _getExtension(name);
+    if (extension == ".obj") {
+        return parseObj(source.getSpan());
+    }
+    if (extension == ".gltf" || extension == ".glb") {
+        std::string directory = std::filesystem::path(name).parent_path().generic_string();
+        return parseGltf(source.getSpan(), [&](const std::string& uri) {
+            return m_assets.load(directory.empty() ? uri : directory + "/" + uri);
+        });
+    }
+
+    throw std::runtime_error("unsupported mesh format: " + name);
+}
+
+MeshData MeshLoader::_mapCached(const std::string& path, uint64_t key) const {
+    if (!std::filesystem::exists(path)) {
+        return {};
+    }
+
+    auto file = std::make_unique<MappedFile>(path);
+    CacheHeader header;
+    if (file->getSize() < sizeof(header)) {
+        return {};
+    }
+    memcpy(&header, file->getData(), sizeof(header));
+
+    size_t indicesOffset = _getIndicesOffset(header.vertexCount);
+    if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.sourceKey != key ||
+        header.vertexStride != sizeof(EncodedVertex) ||
+        indicesOffset + static_cast<size_t>(header.indexCount) * sizeof(uint32_t) > file->getSize() ||
+        header.lodCount == 0 || header.lodCount > MAX_MESH_LODS) {
+        return {};
+    }
+    for (uint32_t i = 0; i < header.lodCount; i++) {
+        if (static_cast<uint64_t>(header.lods[i].firstIndex) + header.lods[i].indexCount > header.indexCount) {
+            return {};
+        }
+    }
+
+    // the mapping is page aligned and the blocks are aligned within it
+    const char* data = file->getData();
+    std::span<const EncodedVertex> vertices(reinterpret_cast<const EncodedVertex*>(data + sizeof(CacheHeader)), header.vertexCount);
+    std::span<const uint32_t> indices(reinterpret_cast<const uint32_t*>(data + indicesOffset), header.indexCount);
+    return MeshData(std::move(file), vertices, indices, std::span(header.lods, header.lodCount), header.dequantization);
+}
+
+bool MeshLoader::_storeCached(const std::string& path, uint64_t key, const EncodedMesh& mesh) const {
+    // written under a temporary name so a concurrent reader never sees a partial entry
+    std::ostringstream temporary;
+    temporary << path << "." << std::this_thread::get_id() << ".tmp";
+
+    bool isWritten = false;
+    {
+        std::ofstream file(temporary.str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        CacheHeader header{
+            .magic = CACHE_MAGIC,
+            .version = CACHE_VERSION,
+            .vertexCount = static_cast<uint32_t>(mesh.vertices.size()),
+            .indexCount = static_cast<uint32_t>(mesh.indices.size()),
+            .sourceKey = key,
+            .vertexStride = sizeof(EncodedVertex),
+            .lodCount = static_cast<uint32_t>(std::min<size_t>(mesh.lods.size(), MAX_MESH_LODS)),
+            .dequantization = mesh.dequantization,
+            .lods = {}};
+        std::copy_n(mesh.lods.begin(), header.lodCount, header.lods);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(EncodedVertex));
+
+        const char padding[alignof(uint32_t)] = {};
+        size_t vertexEnd = sizeof(CacheHeader) + mesh.vertices.size() * sizeof(EncodedVertex);
+        file.write(padding, _getIndicesOffset(header.vertexCount) - vertexEnd);
+        file.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(uint32_t));
+        isWritten = static_cast<bool>(file);
+    }
+
+    std::error_code error;
+    if (isWritten) {
+        std::filesystem::rename(temporary.str(), path, error);
+    }
+    if (!isWritten || error) {
+        std::filesystem::remove(temporary.str(), error);
+        return false;
+    }
+    return true;
+}
+
+std::string MeshLoader::_getPath(uint64_t key) const {
+    std::ostringstream path;
+    path << m_cacheDirectory << std::hex << key << ".mesh";
+    return path.str();
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include "shared.h"
+#include "geometry/mesh_encoder.h"
+#include "resource/asset_store.h"
+#include "resource/mapped_file.h"
+
+namespace eng {
+
+// an encoded mesh ready for upload. points straight into a mapped cache entry, or owns
+// the freshly imported mesh when the entry could not be written.
+class MeshData {
+public:
+    MeshData() = default;
+    MeshData(std::unique_ptr<MappedFile> file, std::span<const EncodedVertex> vertices, std::span<const uint32_t> indices, std::span<const MeshLod> lods,
+             const MeshDequantization& dequantization);
+    explicit MeshData(EncodedMesh&& mesh);
+
+    MeshData(MeshData&&) = default;
+    MeshData& operator=(MeshData&&) = default;
+    MeshData(const MeshData&) = delete;
+    MeshData& operator=(const MeshData&) = delete;
+
+    inline std::span<const EncodedVertex> getVertices() const { return m_vertices; }
+    inline std::span<const uint32_t> getIndices() const { return m_indices; }
+    inline std::span<const MeshLod> getLods() const { return m_lods; }
+    inline const MeshDequantization& getDequantization() const { return m_dequantization; }
+    inline bool isMapped() const { return m_file != nullptr; }
+
+private:
+    std::unique_ptr<MappedFile> m_file;
+    EncodedMesh m_storage;  // moving the vectors keeps their buffers, so the spans stay valid
+    std::span<const EncodedVertex> m_vertices;
+    std::span<const uint32_t> m_indices;
+    std::vector<MeshLod> m_lods;
+    MeshDequantization m_dequantization;
+};
+
+// imports .obj, .gltf and .glb models through the asset store, welds and reorders them
+// for the vertex cache, overdraw and vertex fetch, simplifies them into levels of
+// detail, encodes them and caches the result on disk keyed by the name, size and write
+// time of the source. a cached mesh is just mapped, the source is not read. gltf node
+// transforms are applied by the import, see parseGltf.
+class MeshLoader {
+public:
+    explicit MeshLoader(const AssetStore& assets, const std::string& cacheDirectory = "cache/meshes/");
+
+    MeshData load(const std::string& name) const;
+
+private:
+    const AssetStore& m_assets;
+    std::string m_cacheDirectory;
+
+private:
+    Mesh _import(const std::string& name, const Asset& source) const;
+    MeshData _mapCached(const std::string& path, uint64_t key) const;
+    bool _storeCached(const std::string& path, uint64_t key, const EncodedMesh& mesh) const;
+    std::string _getPath(uint64_t key) const;
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include "geometry/mesh_optimizer.h"
+
+#include <cstring>
+#include <unordered_map>
+
+namespace eng {
+
+namespace {
+
+// forsyth's tuning
+constexpr uint32_t MAX_CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+struct VertexHash {
+    size_t operator()(const MeshVertex& vertex) const {
+        // fnv-1a over the raw floats, welding is bitwise
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&vertex);
+        uint64_t value = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < sizeof(MeshVertex); i++) {
+            value ^= bytes[i];
+            value *= 0x100000001b3ull;
+        }
+
+        return static_cast<size_t>(value);
+    }
+};
+
+struct VertexEqual {
+    bool operator()(const MeshVertex& a, const MeshVertex& b) const {
+        return memcmp(&a, &b, sizeof(MeshVertex)) == 0;
+    }
+};
+
+static_assert(sizeof(MeshVertex) == 12 * sizeof(float), "mesh vertex must not contain padding for bitwise welding");
+
+float _vertexScore(int cachePosition, uint32_t liveTriangles, uint32_t cacheSize) {
+    if (liveTriangles == 0) {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // the last triangle's vertices get a fixed score so it isn't simply repeated
+        score = cachePosition < 3 ? LAST_TRIANGLE_SCORE
+                                  : std::pow(1.0f - static_cast<float>(cachePosition - 3) / (cacheSize - 3), CACHE_DECAY_POWER);
+    }
+
+    // favours vertices with few triangles left, so lone triangles don't get stranded
+    return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(liveTriangles), -VALENCE_BOOST_POWER);
+}
+
+}  // namespace
+
+VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize) {
+    VertexCacheStats stats;
+    if (indices.empty() || vertexCount == 0) {
+        return stats;
+    }
+
+    // a vertex is in the fifo if fewer than cacheSize misses happened since it was loaded
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    uint32_t misses = 0;
+    for (uint32_t index : indices) {
+        if (time - timestamps[index] > cacheSize) {
+            timestamps[index] = time++;
+            misses++;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / (indices.size() / 3);
+    stats.atvr = static_cast<float>(misses) / vertexCount;
+    return stats;
+}
+
+void weldVertices(Mesh& mesh) {
+    std::unordered_map<MeshVertex, uint32_t, VertexHash, VertexEqual> unique;
+    unique.reserve(mesh.indices.size());
+
+    std::vector<MeshVertex> vertices;
+    for (uint32_t& index : mesh.indices) {
+        auto [it, inserted] = unique.try_emplace(mesh.vertices[index], static_cast<uint32_t>(vertices.size()));
+        if (inserted) {
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = it->second;
+    }
+
+    mesh.vertices = std::move(vertices);
+}
+
+void optimizeVertexCache(Mesh& mesh, uint32_t cacheSize) {
+    cacheSize = std::clamp(cacheSize, 4u, MAX_CACHE_SIZE);
+    const std::vector<uint32_t>& indices = mesh.indices;
+    size_t vertexCount = mesh.vertices.size();
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // triangles of each vertex, the live ones are kept at the front of its range
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (uint32_t index : indices) {
+        liveTriangles[index]++;
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    }
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) {
+            adjacency[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        vertexScores[v] = _vertexScore(-1, liveTriangles[v], cacheSize);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    size_t best = 0;
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+        if (triangleScores[t] > triangleScores[best]) {
+            best = t;
+        }
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    std::vector<uint32_t> cache, nextCache;
+    cache.reserve(cacheSize + 3);
+    nextCache.reserve(cacheSize + 3);
+    size_t cursor = 0;
+
+    while (best < triangleCount) {
+        emitted[best] = true;
+
+        nextCache.clear();
+        for (int k = 0; k < 3; k++) {
+            uint32_t v = indices[best * 3 + k];
+            result.push_back(v);
+
+            auto begin = adjacency.begin() + adjacencyOffsets[v];
+            auto end = begin + liveTriangles[v];
+            auto found = std::find(begin, end, static_cast<uint32_t>(best));
+            if (found != end) {
+                std::iter_swap(found, end - 1);
+                liveTriangles[v]--;
+            }
+
+            if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end()) {
+                nextCache.push_back(v);
+            }
+        }
+
+        // lru, the emitted triangle moves to the front and pushes the rest back
+        for (uint32_t v : cache) {
+            if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end()) {
+                nextCache.push_back(v);
+            }
+        }
+
+        // rescore everything that moved, including what fell out of the cache
+        for (size_t i = 0; i < nextCache.size(); i++) {
+            uint32_t v = nextCache[i];
+            cachePositions[v] = i < cacheSize ? static_cast<int>(i) : -1;
+
+            float score = _vertexScore(cachePositions[v], liveTriangles[v], cacheSize);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+            for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v] + liveTriangles[v]; a++) {
+                triangleScores[adjacency[a]] += delta;
+            }
+        }
+
+        nextCache.resize(std::min<size_t>(nextCache.size(), cacheSize));
+        std::swap(cache, nextCache);
+
+        // the next triangle is almost always next to the cache, a full scan only happens
+        // when the current patch runs out
+        best = triangleCount;
+        float bestScore = -std::numeric_limits<float>::infinity();
+        for (uint32_t v : cache) {
+            for (uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v] + liveTriangles[v]; a++) {
+                uint32_t t = adjacency[a];
+                if (triangleScores[t] > bestScore) {
+                    best = t;
+                    bestScore = triangleScores[t];
+                }
+            }
+        }
+
+        if (best == triangleCount) {
+            while (cursor < triangleCount && emitted[cursor]) {
+                cursor++;
+            }
+            best = cursor;
+        }
+    }
+
+    mesh.indices = std::move(result);
+}
+
+void optimizeOverdraw(Mesh& mesh, uint32_t cacheSize) {
+    const std::vector<uint32_t>& indices = mesh.indices;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // a cluster ends where the fifo has been flushed, a triangle that misses on all
+    // three vertices. reordering at those points costs no extra cache misses.
+    std::vector<size_t> clusterStarts;
+    {
+        std::vector<uint32_t> timestamps(mesh.vertices.size(), 0);
+        uint32_t time = cacheSize + 1;
+        for (size_t t = 0; t < triangleCount; t++) {
+            uint32_t misses = 0;
+            for (int k = 0; k < 3; k++) {
+                uint32_t index = indices[t * 3 + k];
+                if (time - timestamps[index] > cacheSize) {
+                    timestamps[index] = time++;
+                    misses++;
+                }
+            }
+
+            if (misses == 3 || t == 0) {
+                clusterStarts.push_back(t);
+            }
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    size_t clusterCount = clusterStarts.size() - 1;
+    if (clusterCount < 2) {
+        return;
+    }
+
+    glm::vec3 meshCentroid(0.0f);
+    for (const MeshVertex& vertex : mesh.vertices) {
+        meshCentroid += vertex.position;
+    }
+    meshCentroid = meshCentroid / static_cast<float>(mesh.vertices.size());
+
+    // how far a cluster faces away from the center, those occlude the most
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+            const glm::vec3& p0 = mesh.vertices[indices[t * 3]].position;
+            const glm::vec3& p1 = mesh.vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& p2 = mesh.vertices[indices[t * 3 + 2]].position;
+
+            glm::vec3 weighted = glm::cross(p1 - p0, p2 - p0);
+            float triangleArea = glm::length(weighted);
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += weighted;
+            area += triangleArea;
+        }
+
+        float normalLength = glm::length(normal);
+        if (area == 0.0f || normalLength == 0.0f) {
+            sortKeys[c] = 0.0f;
+            continue;
+        }
+        sortKeys[c] = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+    }
+
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        order[c] = static_cast<uint32_t>(c);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return sortKeys[a] > sortKeys[b];
+    });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (uint32_t c : order) {
+        result.insert(result.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+    }
+
+    mesh.indices = std::move(result);
+}
+
+void optimizeVertexFetch(Mesh& mesh) {
+    constexpr uint32_t UNUSED = ~0u;
+    std::vector<uint32_t> remap(mesh.vertices.size(), UNUSED);
+
+    std::vector<MeshVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (uint32_t& index : mesh.indices) {
+        if (remap[index] == UNUSED) {
+            remap[index] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    mesh.vertices = std::move(vertices);
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <span>
+#include "shared.h"
+#include "geometry/mesh.h"
+
+namespace eng {
+
+// fifo size the passes optimize for, small enough to hold on every recent gpu
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats {
+    float acmr = 0.0f;  // transformed vertices per triangle, 3 is the worst case
+    float atvr = 0.0f;  // transformed vertices per unique vertex, 1 is ideal
+};
+
+VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// merges bitwise identical vertices and drops the ones no triangle references
+void weldVertices(Mesh& mesh);
+
+// reorders triangles for the post transform cache, forsyth's linear speed algorithm
+void optimizeVertexCache(Mesh& mesh, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// sorts the clusters the cache order leaves behind so outward facing ones are drawn
+// first, the order inside each cluster is kept so the cache hit rate barely moves
+void optimizeOverdraw(Mesh& mesh, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// renumbers vertices in order of first use so vertex fetch streams through memory
+void optimizeVertexFetch(Mesh& mesh);
+
+}  // namespace eng
\ No newline at end of file
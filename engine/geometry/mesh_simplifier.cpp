@@ -0,0 +1,317 @@
+#include "geometry/mesh_simplifier.h"
+
+#include <unordered_map>
+#include "geometry/mesh_optimizer.h"
+
+namespace eng {
+
+namespace {
+
+constexpr float LOD_REDUCTION = 0.5f;       // triangles kept from one level to the next
+constexpr float LOD_MIN_REDUCTION = 0.85f;  // a level keeping more than this of the previous one is dropped
+constexpr float LOD_MAX_ERROR = 0.1f;       // relative to the mesh's extent
+constexpr float MAX_COLLAPSE_TURN = 0.25f;  // cosine of how far one collapse may turn a triangle
+
+// plane distances squared, summed and weighted by the triangles' areas
+struct Quadric {
+    double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+    double b2 = 0.0, bc = 0.0, bd = 0.0;
+    double c2 = 0.0, cd = 0.0;
+    double d2 = 0.0;
+    double weight = 0.0;
+};
+
+void _addPlane(Quadric& q, double a, double b, double c, double d, double weight) {
+    q.a2 += weight * a * a;
+    q.ab += weight * a * b;
+    q.ac += weight * a * c;
+    q.ad += weight * a * d;
+    q.b2 += weight * b * b;
+    q.bc += weight * b * c;
+    q.bd += weight * b * d;
+    q.c2 += weight * c * c;
+    q.cd += weight * c * d;
+    q.d2 += weight * d * d;
+    q.weight += weight;
+}
+
+void _addQuadric(Quadric& q, const Quadric& other) {
+    q.a2 += other.a2;
+    q.ab += other.ab;
+    q.ac += other.ac;
+    q.ad += other.ad;
+    q.b2 += other.b2;
+    q.bc += other.bc;
+    q.bd += other.bd;
+    q.c2 += other.c2;
+    q.cd += other.cd;
+    q.d2 += other.d2;
+    q.weight += other.weight;
+}
+
+// mean squared distance of p to the planes
+double _evaluate(const Quadric& q, const glm::vec3& p) {
+    double x = p.x, y = p.y, z = p.z;
+    double error = q.a2 * x * x + 2.0 * q.ab * x * y + 2.0 * q.ac * x * z + 2.0 * q.ad * x +
+                   q.b2 * y * y + 2.0 * q.bc * y * z + 2.0 * q.bd * y +
+                   q.c2 * z * z + 2.0 * q.cd * z + q.d2;
+    return q.weight > 0.0 ? std::max(error, 0.0) / q.weight : 0.0;
+}
+
+struct PositionHash {
+    size_t operator()(const glm::vec3& p) const {
+        uint32_t bits[3];
+        memcpy(bits, &p, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    }
+};
+
+struct PositionEqual {
+    bool operator()(const glm::vec3& a, const glm::vec3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+};
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    double cost;
+};
+
+uint32_t _resolve(const std::vector<uint32_t>& remap, uint32_t v) {
+    while (remap[v] != v) {
+        v = remap[v];
+    }
+    return v;
+}
+
+}  // namespace
+
+std::vector<uint32_t> simplifyMesh(const Mesh& mesh, std::span<const uint32_t> indices, size_t targetIndexCount, float maxError, float* resultError) {
+    size_t vertexCount = mesh.vertices.size();
+    std::vector<uint32_t> result(indices.begin(), indices.end());
+    float error = 0.0f;
+
+    // vertices sharing a position are copies split by a seam, they must stay together
+    std::vector<uint32_t> canonical(vertexCount);
+    std::vector<uint32_t> copies(vertexCount, 0);
+    {
+        std::unordered_map<glm::vec3, uint32_t, PositionHash, PositionEqual> firstAt;
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            canonical[v] = firstAt.try_emplace(mesh.vertices[v].position, v).first->second;
+            copies[canonical[v]]++;
+        }
+    }
+
+    // an edge without its opposite is an open border, one used twice the same way is
+    // non-manifold, neither may move
+    std::vector<uint8_t> isLocked(vertexCount, 0);
+    {
+        auto edgeKey = [&](uint32_t a, uint32_t b) { return static_cast<uint64_t>(canonical[a]) << 32 | canonical[b]; };
+        std::unordered_map<uint64_t, uint32_t> edges;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                edges[edgeKey(result[i + k], result[i + (k + 1) % 3])]++;
+            }
+        }
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = result[i + k], b = result[i + (k + 1) % 3];
+                auto opposite = edges.find(edgeKey(b, a));
+                if (opposite == edges.end() || opposite->second != 1 || edges[edgeKey(a, b)] != 1) {
+                    isLocked[canonical[a]] = 1;
+                    isLocked[canonical[b]] = 1;
+                }
+            }
+        }
+    }
+    auto isFree = [&](uint32_t v) { return copies[canonical[v]] == 1 && !isLocked[canonical[v]]; };
+    auto isTarget = [&](uint32_t v) { return copies[canonical[v]] == 1; };
+
+    // the area weighted normals of the original surface, small turns per collapse can
+    // still add up over passes, so triangles must also keep facing the way it did
+    std::vector<Quadric> quadrics(vertexCount);
+    std::vector<glm::vec3> surfaceNormals(vertexCount, glm::vec3(0.0f));
+    for (size_t i = 0; i < result.size(); i += 3) {
+        const glm::vec3& p0 = mesh.vertices[result[i]].position;
+        glm::vec3 normal = glm::cross(mesh.vertices[result[i + 1]].position - p0, mesh.vertices[result[i + 2]].position - p0);
+        float length = glm::length(normal);
+        if (length == 0.0f) {
+            continue;
+        }
+
+        for (int k = 0; k < 3; k++) {
+            surfaceNormals[canonical[result[i + k]]] += normal;
+        }
+        normal = normal / length;
+        double d = -glm::dot(normal, p0);
+        for (int k = 0; k < 3; k++) {
+            _addPlane(quadrics[result[i + k]], normal.x, normal.y, normal.z, d, length * 0.5);
+        }
+    }
+
+    std::vector<uint32_t> remap(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; v++) {
+        remap[v] = v;
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+    std::vector<uint8_t> isTouched(vertexCount);
+    size_t triangleCount = result.size() / 3;
+    double maxCost = static_cast<double>(maxError) * maxError;
+
+    while (triangleCount * 3 > targetIndexCount) {
+        // triangles around each vertex, for the flip test
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (uint32_t index : result) {
+            adjacencyOffsets[index + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++) {
+            adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+        }
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < result.size(); i++) {
+                adjacency[cursors[result[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = result[i + k], b = result[i + (k + 1) % 3];
+                for (auto [from, to] : {std::pair(a, b), std::pair(b, a)}) {
+                    if (isFree(from) && isTarget(to)) {
+                        Quadric q = quadrics[from];
+                        _addQuadric(q, quadrics[to]);
+                        collapses.push_back({from, to, _evaluate(q, mesh.vertices[to].position)});
+                    }
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+        // cheapest first, each vertex takes part in one collapse per pass
+        std::fill(isTouched.begin(), isTouched.end(), 0);
+        size_t collapsed = 0;
+        for (const Collapse& collapse : collapses) {
+            if (collapse.cost > maxCost || triangleCount * 3 <= targetIndexCount) {
+                break;
+            }
+            if (isTouched[collapse.from] || isTouched[collapse.to]) {
+                continue;
+            }
+
+            // a triangle that would turn too far, or face away from the surface, folds it
+            bool isFlipped = false;
+            uint32_t removed = 0;
+            for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && !isFlipped; a++) {
+                uint32_t t = adjacency[a];
+                uint32_t v[3] = {_resolve(remap, result[t * 3]), _resolve(remap, result[t * 3 + 1]), _resolve(remap, result[t * 3 + 2])};
+                if (v[0] == v[1] || v[1] == v[2] || v[0] == v[2]) {
+                    continue;
+                }
+                if (v[0] == collapse.to || v[1] == collapse.to || v[2] == collapse.to) {
+                    removed++;
+                    continue;
+                }
+
+                glm::vec3 before = glm::cross(mesh.vertices[v[1]].position - mesh.vertices[v[0]].position,
+                                              mesh.vertices[v[2]].position - mesh.vertices[v[0]].position);
+                for (uint32_t& vertex : v) {
+                    vertex = vertex == collapse.from ? collapse.to : vertex;
+                }
+                glm::vec3 after = glm::cross(mesh.vertices[v[1]].position - mesh.vertices[v[0]].position,
+                                             mesh.vertices[v[2]].position - mesh.vertices[v[0]].position);
+                glm::vec3 surfaceNormal = surfaceNormals[canonical[v[0]]] + surfaceNormals[canonical[v[1]]] + surfaceNormals[canonical[v[2]]];
+                isFlipped = glm::dot(before, after) <= MAX_COLLAPSE_TURN * glm::length(before) * glm::length(after) ||
+                            glm::dot(after, surfaceNormal) <= 0.0f;
+            }
+            if (isFlipped) {
+                continue;
+            }
+
+            remap[collapse.from] = collapse.to;
+            _addQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+            isTouched[collapse.from] = 1;
+            isTouched[collapse.to] = 1;
+            triangleCount -= removed;
+            error = std::max(error, static_cast<float>(std::sqrt(collapse.cost)));
+            collapsed++;
+        }
+
+        // apply the pass and drop the triangles that collapsed to lines
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            uint32_t v0 = _resolve(remap, result[i]), v1 = _resolve(remap, result[i + 1]), v2 = _resolve(remap, result[i + 2]);
+            if (v0 != v1 && v1 != v2 && v0 != v2) {
+                result[write++] = v0;
+                result[write++] = v1;
+                result[write++] = v2;
+            }
+        }
+        result.resize(write);
+        triangleCount = write / 3;
+
+        if (collapsed == 0) {
+            break;
+        }
+    }
+
+    if (resultError != nullptr) {
+        *resultError = error;
+    }
+    return result;
+}
+
+std::vector<MeshLod> generateLods(Mesh& mesh) {
+    std::vector<MeshLod> lods = {{.firstIndex = 0, .indexCount = static_cast<uint32_t>(mesh.indices.size()), .error = 0.0f}};
+    if (mesh.indices.empty()) {
+        return lods;
+    }
+
+    glm::vec3 min = mesh.vertices[0].position, max = mesh.vertices[0].position;
+    for (const MeshVertex& vertex : mesh.vertices) {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+    float maxError = glm::length(max - min) * LOD_MAX_ERROR;
+
+    // every level starts from lod 0, so its error is measured against the real surface
+    std::vector<uint32_t> base = mesh.indices;
+    size_t targetIndexCount = base.size();
+    while (lods.size() < MAX_MESH_LODS) {
+        targetIndexCount = static_cast<size_t>(targetIndexCount * LOD_REDUCTION) / 3 * 3;
+        float error = 0.0f;
+        std::vector<uint32_t> indices = simplifyMesh(mesh, base, targetIndexCount, maxError, &error);
+        if (indices.empty() || indices.size() > lods.back().indexCount * LOD_MIN_REDUCTION) {
+            break;
+        }
+
+        // each level gets its own cache order, the optimizer only looks at the indices
+        std::swap(mesh.indices, indices);
+        optimizeVertexCache(mesh);
+        std::swap(mesh.indices, indices);
+
+        lods.push_back({.firstIndex = static_cast<uint32_t>(mesh.indices.size()), .indexCount = static_cast<uint32_t>(indices.size()), .error = error});
+        mesh.indices.insert(mesh.indices.end(), indices.begin(), indices.end());
+        targetIndexCount = indices.size();
+    }
+
+    return lods;
+}
+
+uint32_t selectLod(std::span<const MeshLod> lods, float distance, float pixelsPerUnit, float maxPixelError) {
+    uint32_t lod = 0;
+    float scale = pixelsPerUnit / std::max(distance, std::numeric_limits<float>::epsilon());
+    for (uint32_t i = 1; i < lods.size(); i++) {
+        if (lods[i].error * scale > maxPixelError) {
+            break;
+        }
+        lod = i;
+    }
+    return lod;
+}
+
+}  // namespace eng
\ No newline at end of file
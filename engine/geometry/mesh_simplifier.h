@@ -0,0 +1,26 @@
+#pragma once
+
+#include <span>
+#include "shared.h"
+#include "geometry/mesh.h"
+
+namespace eng {
+
+// quadric error metric simplification after garland and heckbert. edges collapse
+// into one of their end points, so the result indexes the mesh's own vertices and
+// every level shares the vertex buffer. vertices on open borders and on attribute
+// seams never move, which keeps silhouettes and uv islands intact. stops at
+// targetIndexCount or before the first collapse that would exceed maxError, and
+// returns the largest error made, in model units, through resultError.
+std::vector<uint32_t> simplifyMesh(const Mesh& mesh, std::span<const uint32_t> indices, size_t targetIndexCount, float maxError,
+                                   float* resultError = nullptr);
+
+// appends up to MAX_MESH_LODS - 1 coarser levels, each about half the triangles of the
+// one before, to the indices of lod 0. gives up once a level barely shrinks.
+std::vector<MeshLod> generateLods(Mesh& mesh);
+
+// the coarsest level whose error, seen at distance from the eye, covers at most
+// maxPixelError pixels. pixelsPerUnit is the size in pixels of one unit at distance 1.
+uint32_t selectLod(std::span<const MeshLod> lods, float distance, float pixelsPerUnit, float maxPixelError);
+
+}  // namespace eng
\ No newline at end of file
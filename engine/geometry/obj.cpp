@@ -0,0 +1,144 @@
+#include "geometry/obj.h"
+
+#include <charconv>
+
+namespace eng {
+
+namespace {
+
+class LineReader {
+public:
+    explicit LineReader(std::string_view line) : m_line(line) {}
+
+    std::string_view token() {
+        _skipSpaces();
+        size_t end = m_line.find_first_of(" \t", m_position);
+        end = end == std::string_view::npos ? m_line.size() : end;
+
+        std::string_view token = m_line.substr(m_position, end - m_position);
+        m_position = end;
+        return token;
+    }
+
+    bool number(float& value) {
+        std::string_view text = token();
+        return !text.empty() && std::from_chars(text.data(), text.data() + text.size(), value).ec == std::errc();
+    }
+
+private:
+    std::string_view m_line;
+    size_t m_position = 0;
+
+private:
+    void _skipSpaces() {
+        while (m_position < m_line.size() && (m_line[m_position] == ' ' || m_line[m_position] == '\t')) {
+            m_position++;
+        }
+    }
+};
+
+// obj indices are one based, negative ones count back from the latest element
+uint32_t _resolveIndex(std::string_view text, size_t count, size_t lineNumber) {
+    int64_t index = 0;
+    if (text.empty() || std::from_chars(text.data(), text.data() + text.size(), index).ec != std::errc()) {
+        throw std::runtime_error("invalid obj face on line " + std::to_string(lineNumber) + "!");
+    }
+
+    int64_t resolved = index < 0 ? static_cast<int64_t>(count) + index : index - 1;
+    if (index == 0 || resolved < 0 || resolved >= static_cast<int64_t>(count)) {
+        throw std::runtime_error("obj face index out of range on line " + std::to_string(lineNumber) + "!");
+    }
+
+    return static_cast<uint32_t>(resolved);
+}
+
+}  // namespace
+
+Mesh parseObj(std::span<const char> file) {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec4> colors;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> uvs;
+    Mesh mesh;
+
+    std::string_view text(file.data(), file.size());
+    size_t lineNumber = 0;
+    std::vector<uint32_t> polygon;
+
+    for (size_t start = 0; start < text.size();) {
+        size_t end = text.find('\n', start);
+        end = end == std::string_view::npos ? text.size() : end;
+        std::string_view line = text.substr(start, end - start);
+        start = end + 1;
+        lineNumber++;
+
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        LineReader reader(line);
+        std::string_view keyword = reader.token();
+
+        if (keyword == "v") {
+            glm::vec3 position(0.0f);
+            glm::vec4 color(1.0f);
+            if (!reader.number(position.x) || !reader.number(position.y) || !reader.number(position.z)) {
+                throw std::runtime_error("invalid obj position on line " + std::to_string(lineNumber) + "!");
+            }
+            // optional vertex colors, a lone fourth value is a w and ignored
+            glm::vec3 rgb;
+            if (reader.number(rgb.x) && reader.number(rgb.y) && reader.number(rgb.z)) {
+                color = glm::vec4(rgb, 1.0f);
+            }
+            positions.push_back(position);
+            colors.push_back(color);
+        } else if (keyword == "vn") {
+            glm::vec3 normal(0.0f);
+            reader.number(normal.x);
+            reader.number(normal.y);
+            reader.number(normal.z);
+            normals.push_back(normal);
+        } else if (keyword == "vt") {
+            glm::vec2 uv(0.0f);
+            reader.number(uv.x);
+            reader.number(uv.y);
+            uvs.push_back(glm::vec2(uv.x, 1.0f - uv.y));  // obj has the origin at the bottom left
+        } else if (keyword == "f") {
+            polygon.clear();
+            for (std::string_view corner = reader.token(); !corner.empty(); corner = reader.token()) {
+                // v, v/vt, v//vn or v/vt/vn
+                size_t firstSlash = corner.find('/');
+                size_t secondSlash = firstSlash == std::string_view::npos ? std::string_view::npos : corner.find('/', firstSlash + 1);
+
+                MeshVertex vertex{.normal = glm::vec3(0.0f), .uv = glm::vec2(0.0f)};
+                uint32_t position = _resolveIndex(corner.substr(0, firstSlash), positions.size(), lineNumber);
+                vertex.position = positions[position];
+                vertex.color = colors[position];
+
+                if (firstSlash != std::string_view::npos) {
+                    std::string_view uv = corner.substr(firstSlash + 1, secondSlash - firstSlash - 1);
+                    if (!uv.empty()) {
+                        vertex.uv = uvs[_resolveIndex(uv, uvs.size(), lineNumber)];
+                    }
+                }
+                if (secondSlash != std::string_view::npos) {
+                    vertex.normal = normals[_resolveIndex(corner.substr(secondSlash + 1), normals.size(), lineNumber)];
+                }
+
+                polygon.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+                mesh.vertices.push_back(vertex);
+            }
+
+            if (polygon.size() < 3) {
+                throw std::runtime_error("obj face with fewer than three corners on line " + std::to_string(lineNumber) + "!");
+            }
+            for (size_t i = 1; i + 1 < polygon.size(); i++) {
+                mesh.indices.insert(mesh.indices.end(), {polygon[0], polygon[i], polygon[i + 1]});
+            }
+        }
+    }
+
+    return mesh;
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <span>
+#include "shared.h"
+#include "geometry/mesh.h"
+
+namespace eng {
+
+// wavefront obj, positions with optional "v x y z r g b" colors, normals and texture
+// coordinates. polygons are fanned into triangles, every corner gets its own vertex
+// until the mesh is welded. materials and groups are ignored.
+Mesh parseObj(std::span<const char> file);
+
+}  // namespace eng
\ No newline at end of file
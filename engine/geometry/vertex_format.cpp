@@ -0,0 +1,63 @@
+#include "geometry/vertex_format.h"
+
+#include <cstring>
+
+namespace eng {
+
+// round to nearest even, overflow becomes infinity and tiny values flush through the subnormals
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t biasedExponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (biasedExponent == 0xff) {
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));  // inf stays inf, nan stays quiet nan
+    }
+
+    int32_t exponent = static_cast<int32_t>(biasedExponent) - 127 + 15;
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7c00);
+    }
+
+    uint32_t shift = 13;
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000;  // the implicit leading one becomes explicit in a subnormal
+        shift = 14 - exponent;
+        exponent = 0;
+    }
+
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> shift);
+    uint32_t remainder = mantissa & ((1u << shift) - 1);
+    uint32_t midpoint = 1u << (shift - 1);
+    // a carry out of the mantissa correctly bumps the exponent, up to infinity
+    if (remainder > midpoint || (remainder == midpoint && (half & 1))) {
+        half++;
+    }
+
+    return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t bits) {
+    uint32_t sign = (bits & 0x8000u) << 16;
+    uint32_t exponent = (bits >> 10) & 0x1f;
+    uint32_t mantissa = bits & 0x3ff;
+
+    if (exponent == 0) {
+        float value = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -value : value;
+    }
+
+    uint32_t result = exponent == 31 ? (sign | 0x7f800000 | (mantissa << 13))
+                                     : (sign | ((exponent + 112) << 23) | (mantissa << 13));
+    float value;
+    std::memcpy(&value, &result, sizeof(value));
+    return value;
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <type_traits>
+#include <glm/glm.hpp>
+#include "shared.h"
+
+namespace eng {
+
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t bits);
+
+enum class VertexEncoding {
+    Half,   // ieee 754 binary16
+    Snorm,  // [-1, 1] mapped to the signed integer range
+    Unorm   // [0, 1] mapped to the unsigned integer range
+};
+
+// N float components stored as T. the vertex fetch expands them back to floats, so
+// shaders keep declaring vecN while the buffer only holds sizeof(T) * N bytes.
+template <typename T, size_t N, VertexEncoding E>
+struct PackedVec {
+    static_assert(N == 1 || N == 2 || N == 4, "three component 8 and 16 bit vertex formats are rarely supported");
+    static_assert(E != VertexEncoding::Half || std::is_same_v<T, uint16_t>, "half floats are stored as uint16_t");
+    static_assert(E == VertexEncoding::Half || std::is_integral_v<T>, "normalized components must be integers");
+
+    std::array<T, N> values{};
+
+    PackedVec() = default;
+
+    // missing components are zero, eg. a rgb color in a rgba8 slot
+    template <typename... Components>
+        requires(sizeof...(Components) >= 1 && sizeof...(Components) <= N && (std::is_arithmetic_v<Components> && ...))
+    PackedVec(Components... components) {
+        float floats[] = {static_cast<float>(components)...};
+        for (size_t i = 0; i < sizeof...(Components); i++) {
+            values[i] = encode(floats[i]);
+        }
+    }
+
+    PackedVec(const glm::vec2& v) requires(N >= 2) : PackedVec(v.x, v.y) {}
+    PackedVec(const glm::vec3& v) requires(N >= 3) : PackedVec(v.x, v.y, v.z) {}
+    PackedVec(const glm::vec4& v) requires(N >= 4) : PackedVec(v.x, v.y, v.z, v.w) {}
+
+    inline float get(size_t i) const { return decode(values[i]); }
+
+    static T encode(float value) {
+        if constexpr (E == VertexEncoding::Half) {
+            return floatToHalf(value);
+        } else if constexpr (E == VertexEncoding::Snorm) {
+            constexpr float MAX = static_cast<float>(std::numeric_limits<T>::max());
+            return static_cast<T>(std::round(std::clamp(value, -1.0f, 1.0f) * MAX));
+        } else {
+            constexpr float MAX = static_cast<float>(std::numeric_limits<T>::max());
+            return static_cast<T>(std::round(std::clamp(value, 0.0f, 1.0f) * MAX));
+        }
+    }
+
+    // what the gpu reads back, the most negative snorm value clamps to -1
+    static float decode(T value) {
+        if constexpr (E == VertexEncoding::Half) {
+            return halfToFloat(value);
+        } else if constexpr (E == VertexEncoding::Snorm) {
+            return std::max(static_cast<float>(value) / std::numeric_limits<T>::max(), -1.0f);
+        } else {
+            return static_cast<float>(value) / std::numeric_limits<T>::max();
+        }
+    }
+};
+
+using Half2 = PackedVec<uint16_t, 2, VertexEncoding::Half>;
+using Half4 = PackedVec<uint16_t, 4, VertexEncoding::Half>;
+using Snorm8x4 = PackedVec<int8_t, 4, VertexEncoding::Snorm>;
+using Snorm16x2 = PackedVec<int16_t, 2, VertexEncoding::Snorm>;
+using Snorm16x4 = PackedVec<int16_t, 4, VertexEncoding::Snorm>;
+using Unorm8x4 = PackedVec<uint8_t, 4, VertexEncoding::Unorm>;
+using Unorm16x2 = PackedVec<uint16_t, 2, VertexEncoding::Unorm>;
+using Unorm16x4 = PackedVec<uint16_t, 4, VertexEncoding::Unorm>;
+
+// the vertex input format of a c++ attribute type, undefined for unsupported types
+template <typename T>
+struct VertexFormat;
+
+template <VkFormat F>
+struct VertexFormatValue {
+    static constexpr VkFormat value = F;
+};
+
+template <> struct VertexFormat<float> : VertexFormatValue<VK_FORMAT_R32_SFLOAT> {};
+template <> struct VertexFormat<glm::vec2> : VertexFormatValue<VK_FORMAT_R32G32_SFLOAT> {};
+template <> struct VertexFormat<glm::vec3> : VertexFormatValue<VK_FORMAT_R32G32B32_SFLOAT> {};
+template <> struct VertexFormat<glm::vec4> : VertexFormatValue<VK_FORMAT_R32G32B32A32_SFLOAT> {};
+template <> struct VertexFormat<int32_t> : VertexFormatValue<VK_FORMAT_R32_SINT> {};
+template <> struct VertexFormat<glm::ivec2> : VertexFormatValue<VK_FORMAT_R32G32_SINT> {};
+template <> struct VertexFormat<glm::ivec3> : VertexFormatValue<VK_FORMAT_R32G32B32_SINT> {};
+template <> struct VertexFormat<glm::ivec4> : VertexFormatValue<VK_FORMAT_R32G32B32A32_SINT> {};
+template <> struct VertexFormat<uint32_t> : VertexFormatValue<VK_FORMAT_R32_UINT> {};
+template <> struct VertexFormat<glm::uvec2> : VertexFormatValue<VK_FORMAT_R32G32_UINT> {};
+template <> struct VertexFormat<glm::uvec3> : VertexFormatValue<VK_FORMAT_R32G32B32_UINT> {};
+template <> struct VertexFormat<glm::uvec4> : VertexFormatValue<VK_FORMAT_R32G32B32A32_UINT> {};
+
+template <size_t N>
+struct VertexFormat<PackedVec<uint16_t, N, VertexEncoding::Half>>
+    : VertexFormatValue<std::array{VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_UNDEFINED, VK_FORMAT_R16G16B16A16_SFLOAT}[N - 1]> {};
+template <size_t N>
+struct VertexFormat<PackedVec<int8_t, N, VertexEncoding::Snorm>>
+    : VertexFormatValue<std::array{VK_FORMAT_R8_SNORM, VK_FORMAT_R8G8_SNORM, VK_FORMAT_UNDEFINED, VK_FORMAT_R8G8B8A8_SNORM}[N - 1]> {};
+template <size_t N>
+struct VertexFormat<PackedVec<int16_t, N, VertexEncoding::Snorm>>
+    : VertexFormatValue<std::array{VK_FORMAT_R16_SNORM, VK_FORMAT_R16G16_SNORM, VK_FORMAT_UNDEFINED, VK_FORMAT_R16G16B16A16_SNORM}[N - 1]> {};
+template <size_t N>
+struct VertexFormat<PackedVec<uint8_t, N, VertexEncoding::Unorm>>
+    : VertexFormatValue<std::array{VK_FORMAT_R8_UNORM, VK_FORMAT_R8G8_UNORM, VK_FORMAT_UNDEFINED, VK_FORMAT_R8G8B8A8_UNORM}[N - 1]> {};
+template <size_t N>
+struct VertexFormat<PackedVec<uint16_t, N, VertexEncoding::Unorm>>
+    : VertexFormatValue<std::array{VK_FORMAT_R16_UNORM, VK_FORMAT_R16G16_UNORM, VK_FORMAT_UNDEFINED, VK_FORMAT_R16G16B16A16_UNORM}[N - 1]> {};
+
+}  // namespace eng
\ No newline at end of file
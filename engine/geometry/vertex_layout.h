@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstring>
+#include <new>
+#include <tuple>
+#include "shared.h"
+#include "geometry/vertex_format.h"
+
+namespace eng {
+
+namespace detail {
+
+template <typename... Attributes>
+constexpr std::array<uint32_t, sizeof...(Attributes)> computeVertexOffsets() {
+    std::array<uint32_t, sizeof...(Attributes)> offsets{};
+    uint32_t offset = 0;
+    size_t i = 0;
+    // every attribute starts at a multiple of its component size, as the vertex fetch expects
+    ((offset = (offset + alignof(Attributes) - 1) / alignof(Attributes) * alignof(Attributes),
+      offsets[i++] = offset,
+      offset += sizeof(Attributes)),
+     ...);
+    return offsets;
+}
+
+}  // namespace detail
+
+// an interleaved vertex declared as a list of attribute types, bound to consecutive
+// locations. offsets, stride and formats are derived at compile time, eg.
+//     using Vertex = VertexLayout<glm::vec3, Snorm8x4, Half2>;  // position, normal, uv
+//     Vertex vertex{position, normal, uv};
+//     vertex.get<2>() = uv;
+template <typename... Attributes>
+class VertexLayout {
+public:
+    static_assert(sizeof...(Attributes) > 0, "a vertex needs at least one attribute");
+    static_assert((std::is_trivially_copyable_v<Attributes> && ...), "vertex attributes must be trivially copyable");
+
+    static constexpr uint32_t ATTRIBUTE_COUNT = sizeof...(Attributes);
+    static constexpr std::array<uint32_t, ATTRIBUTE_COUNT> OFFSETS = detail::computeVertexOffsets<Attributes...>();
+    static constexpr std::array<VkFormat, ATTRIBUTE_COUNT> FORMATS = {VertexFormat<Attributes>::value...};
+    static constexpr uint32_t ALIGNMENT = std::max({alignof(Attributes)...});
+    static constexpr uint32_t STRIDE = (OFFSETS.back() + sizeof(std::tuple_element_t<ATTRIBUTE_COUNT - 1, std::tuple<Attributes...>>) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+    template <size_t I>
+    using Attribute = std::tuple_element_t<I, std::tuple<Attributes...>>;
+
+    VertexLayout() = default;
+    VertexLayout(const Attributes&... values) {
+        _store(std::index_sequence_for<Attributes...>{}, values...);
+    }
+
+    template <size_t I>
+    inline Attribute<I>& get() { return *std::launder(reinterpret_cast<Attribute<I>*>(m_data + OFFSETS[I])); }
+    template <size_t I>
+    inline const Attribute<I>& get() const { return *std::launder(reinterpret_cast<const Attribute<I>*>(m_data + OFFSETS[I])); }
+
+    static constexpr VkVertexInputBindingDescription getBindingDescription(uint32_t binding = 0, VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX) {
+        return VkVertexInputBindingDescription{
+            .binding = binding,
+            .stride = STRIDE,
+            .inputRate = inputRate};
+    }
+
+    static constexpr std::array<VkVertexInputAttributeDescription, ATTRIBUTE_COUNT> getAttributeDescriptions(uint32_t binding = 0, uint32_t firstLocation = 0) {
+        std::array<VkVertexInputAttributeDescription, ATTRIBUTE_COUNT> attributeDescriptions{};
+        for (uint32_t i = 0; i < ATTRIBUTE_COUNT; i++) {
+            attributeDescriptions[i].binding = binding;
+            attributeDescriptions[i].location = firstLocation + i;
+            attributeDescriptions[i].format = FORMATS[i];
+            attributeDescriptions[i].offset = OFFSETS[i];
+        }
+        return attributeDescriptions;
+    }
+
+private:
+    alignas(ALIGNMENT) std::byte m_data[STRIDE]{};
+
+private:
+    template <size_t... I>
+    void _store(std::index_sequence<I...>, const Attributes&... values) {
+        (std::memcpy(m_data + OFFSETS[I], &values, sizeof(Attributes)), ...);
+    }
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "render/clustered_lighting.h"
+#include <cmath>
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t LIGHT_BATCH = 256;  // lights moved to view space before each write
+
+// the Light struct of the shaders, std430
+struct LightData {
+    glm::vec4 positionRadius;  // view space
+    glm::vec4 colorIntensity;
+};
+
+// the ClusterConstants block of light_cluster.comp
+struct ClusterConstants {
+    glm::mat4 inverseProjection;
+    glm::vec2 screenSize;
+    float nearPlane;
+    float farPlane;
+    uint32_t lightCount;
+};
+
+vk::Buffer createBuffer(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, VkDeviceSize size, VkMemoryPropertyFlags properties) {
+    VkBufferCreateInfo bufferInfo = vk::bufferCreateInfo();
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    return vk::Buffer(device, physicalDevice, bufferInfo, properties);
+}
+
+}  // namespace
+
+ClusteredLighting::FrameResources::FrameResources(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, uint32_t lightCapacity)
+    : lights(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(lightCapacity) * sizeof(LightData),
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)),
+      clusters(createBuffer(device, physicalDevice, m_CLUSTER_COUNT * sizeof(glm::uvec2), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)),
+      indices(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(m_CLUSTER_COUNT) * m_MAX_CLUSTER_LIGHTS * sizeof(uint32_t),
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)),
+      stats(createBuffer(device, physicalDevice, sizeof(ClusterStats), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+    ClusterStats zero{};
+    stats.setData(&zero, sizeof(zero));
+}
+
+ClusteredLighting::ClusteredLighting(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, uint32_t lightCapacity, uint32_t frameCount)
+    : m_device(device), m_lightCapacity(lightCapacity) {
+    m_frames.reserve(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++) {
+        m_frames.emplace_back(device, physicalDevice, lightCapacity);
+    }
+
+    _createComputePipeline(shaders, layoutCache);
+    _createDescriptorSets();
+}
+
+ClusteredLighting::~ClusteredLighting() {
+    vkDestroyDescriptorPool(m_device.get(), m_descriptorPool, nullptr);
+    vkDestroyPipeline(m_device.get(), m_pipeline, nullptr);
+}
+
+void ClusteredLighting::beginFrame(uint32_t frameIndex) {
+    m_frameIndex = frameIndex;
+    FrameResources& frame = m_frames[frameIndex];
+
+    if (frame.isPending) {
+        frame.stats.getData(&m_stats, sizeof(m_stats));
+
+        m_reportFrames++;
+        m_reportLights += frame.lightCount;
+        m_reportIndices += m_stats.indexCount;
+        m_reportMaxClusterLights = std::max(m_reportMaxClusterLights, m_stats.maxClusterLights);
+        m_reportOverflows += m_stats.overflowCount;
+
+        ClusterStats zero{};
+        frame.stats.setData(&zero, sizeof(zero));
+        frame.isPending = false;
+    }
+}
+
+void ClusteredLighting::update(std::span<const PointLight> lights, const glm::mat4& view, const glm::mat4& projection, VkExtent2D extent, float nearPlane, float farPlane) {
+    if (lights.size() > m_lightCapacity) {
+        throw std::runtime_error("too many lights!");
+    }
+
+    FrameResources& frame = m_frames[m_frameIndex];
+    frame.lightCount = static_cast<uint32_t>(lights.size());
+
+    std::array<LightData, LIGHT_BATCH> batch;
+    for (size_t first = 0; first < lights.size(); first += LIGHT_BATCH) {
+        size_t count = std::min<size_t>(LIGHT_BATCH, lights.size() - first);
+        for (size_t i = 0; i < count; i++) {
+            const PointLight& light = lights[first + i];
+            batch[i] = {
+                .positionRadius = glm::vec4(glm::vec3(view * glm::vec4(light.position, 1.0f)), light.radius),
+                .colorIntensity = glm::vec4(light.color, light.intensity)};
+        }
+        frame.lights.setData(batch.data(), count * sizeof(LightData), first * sizeof(LightData));
+    }
+
+    m_inverseProjection = glm::inverse(projection);
+    m_extent = extent;
+    m_nearPlane = nearPlane;
+    m_farPlane = farPlane;
+}
+
+void ClusteredLighting::assign(const vk::CommandBuffer& cmd) {
+    FrameResources& frame = m_frames[m_frameIndex];
+
+    ClusterConstants constants{
+        .inverseProjection = m_inverseProjection,
+        .screenSize = glm::vec2(m_extent.width, m_extent.height),
+        .nearPlane = m_nearPlane,
+        .farPlane = m_farPlane,
+        .lightCount = frame.lightCount};
+
+    cmd.bindPipeline(m_pipeline, VK_PIPELINE_BIND_POINT_COMPUTE);
+    cmd.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout->layout, &frame.descriptorSet);
+    cmd.pushConstants(m_pipelineLayout->layout, VK_SHADER_STAGE_COMPUTE_BIT, constants);
+    cmd.dispatch(m_GRID_X, m_GRID_Y, m_GRID_Z);
+
+    // fragments read the clusters, the stats are read on the host once the frame's fence was signaled
+    VkMemoryBarrier barrier = vk::memoryBarrier();
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+    cmd.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT, barrier);
+
+    frame.isPending = true;
+}
+
+ClusterParameters ClusteredLighting::getParameters() const {
+    // the slices split the depth range exponentially, slice = log(depth / near) / log(far / near) * slices
+    float sliceScale = m_GRID_Z / std::log(m_farPlane / m_nearPlane);
+    return {
+        .scale = glm::vec4(static_cast<float>(m_GRID_X) / m_extent.width, static_cast<float>(m_GRID_Y) / m_extent.height, sliceScale, -std::log(m_nearPlane) * sliceScale),
+        .grid = glm::uvec4(m_GRID_X, m_GRID_Y, m_GRID_Z, 0)};
+}
+
+void ClusteredLighting::report() {
+    uint32_t frames = std::max(m_reportFrames, 1u);
+    std::cout << "clustered lighting: " << m_reportLights / frames << " lights, "
+              << static_cast<double>(m_reportIndices) / frames / m_CLUSTER_COUNT << " per cluster on average, at most "
+              << m_reportMaxClusterLights << ", " << m_reportOverflows / frames << " clusters over " << m_MAX_CLUSTER_LIGHTS << " per frame" << std::endl;
+
+    m_reportFrames = 0;
+    m_reportLights = 0;
+    m_reportIndices = 0;
+    m_reportMaxClusterLights = 0;
+    m_reportOverflows = 0;
+}
+
+void ClusteredLighting::_createComputePipeline(const ShaderLibrary& shaders, LayoutCache& layoutCache) {
+    Asset code = shaders.load("shaders/bin/light_cluster_comp.spv");
+    ShaderReflection reflection = reflectShader(code.getSpan());
+    m_pipelineLayout = &layoutCache.get({&reflection, 1});
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = code.getSize();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code.getData());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(m_device.get(), &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create shader module!");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = shaderModule,
+            .pName = "main"},
+        .layout = m_pipelineLayout->layout};
+
+    VkResult result = vkCreateComputePipelines(m_device.get(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
+    vkDestroyShaderModule(m_device.get(), shaderModule, nullptr);
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create light clustering pipeline!");
+    }
+}
+
+void ClusteredLighting::_createDescriptorSets() {
+    uint32_t frameCount = static_cast<uint32_t>(m_frames.size());
+    std::vector<VkDescriptorPoolSize> poolSizes = m_pipelineLayout->getPoolSizes(0, frameCount);
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    {
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = frameCount;
+    }
+
+    if (vkCreateDescriptorPool(m_device.get(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create light clustering descriptor pool!");
+    }
+
+    for (FrameResources& frame : m_frames) {
+        VkDescriptorSetAllocateInfo allocInfo{};
+        {
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool = m_descriptorPool;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &m_pipelineLayout->setLayouts[0];
+        }
+
+        if (vkAllocateDescriptorSets(m_device.get(), &allocInfo, &frame.descriptorSet) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate light clustering descriptor set!");
+        }
+
+        std::array<const vk::Buffer*, 4> buffers = {&frame.lights, &frame.clusters, &frame.indices, &frame.stats};
+        std::array<VkDescriptorBufferInfo, 4> bufferInfos;
+        std::array<VkWriteDescriptorSet, 4> writes{};
+        for (uint32_t i = 0; i < buffers.size(); i++) {
+            bufferInfos[i] = {
+                .buffer = buffers[i]->get(),
+                .offset = 0,
+                .range = VK_WHOLE_SIZE};
+
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = frame.descriptorSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(m_device.get(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <span>
+#include <glm/glm.hpp>
+#include "shared.h"
+#include "shader/layout_cache.h"
+#include "shader/shader_library.h"
+#include "wrapper/vk/buffer.h"
+#include "wrapper/vk/command_buffer.h"
+
+namespace eng {
+
+struct PointLight {
+    glm::vec3 position;  // world space
+    float radius;        // reaches nothing past it
+    glm::vec3 color;
+    float intensity;
+};
+
+// what a fragment needs to find its cluster, std140 as part of a uniform buffer
+struct ClusterParameters {
+    glm::vec4 scale;  // clusters per pixel in x and y, the slice is log(view depth) * z + w
+    glm::uvec4 grid;  // clusters along x, y and depth
+};
+
+// of one frame, the ClusterStats block of light_cluster.comp read back once the
+// frame's fence was waited on
+struct ClusterStats {
+    uint32_t indexCount = 0;  // light to cluster assignments
+    uint32_t maxClusterLights = 0;
+    uint32_t overflowCount = 0;  // clusters that dropped lights
+};
+
+// clustered forward lighting. the view frustum is split into a grid of tiles on screen
+// and exponential slices in depth, and a compute pass collects the lights reaching
+// each cluster into a compact index list. fragments then only shade with the lights
+// of their cluster, so the cost follows the lights per cluster rather than the light
+// count. the fragment shader reads the lights, the clusters and the index list from
+// storage buffers, see getLightBuffer() and the getters next to it.
+class ClusteredLighting {
+public:
+    ClusteredLighting(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, uint32_t lightCapacity, uint32_t frameCount);
+    ~ClusteredLighting();
+
+    ClusteredLighting(const ClusteredLighting&) = delete;
+    ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+    // after the frame's fence was waited on, collects the stats of its last use
+    void beginFrame(uint32_t frameIndex);
+    // moves the lights to the view space of the frame, projection as in the uniform buffer
+    void update(std::span<const PointLight> lights, const glm::mat4& view, const glm::mat4& projection, VkExtent2D extent, float nearPlane, float farPlane);
+    // before the passes shading with the clusters
+    void assign(const vk::CommandBuffer& cmd);
+
+    ClusterParameters getParameters() const;
+    inline const vk::Buffer& getLightBuffer(uint32_t frameIndex) const { return m_frames[frameIndex].lights; }
+    inline const vk::Buffer& getClusterBuffer(uint32_t frameIndex) const { return m_frames[frameIndex].clusters; }
+    inline const vk::Buffer& getIndexBuffer(uint32_t frameIndex) const { return m_frames[frameIndex].indices; }
+    inline const ClusterStats& getStats() const { return m_stats; }
+
+    // logs the averages since the last report
+    void report();
+
+private:
+    static constexpr uint32_t m_GRID_X = 16;
+    static constexpr uint32_t m_GRID_Y = 9;
+    static constexpr uint32_t m_GRID_Z = 24;
+    static constexpr uint32_t m_CLUSTER_COUNT = m_GRID_X * m_GRID_Y * m_GRID_Z;
+    static constexpr uint32_t m_MAX_CLUSTER_LIGHTS = 256;  // MAX_CLUSTER_LIGHTS of light_cluster.comp
+
+    struct FrameResources {
+        FrameResources(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, uint32_t lightCapacity);
+
+        vk::Buffer lights;    // host visible
+        vk::Buffer clusters;
+        vk::Buffer indices;   // room for every cluster to be full, it never runs out
+        vk::Buffer stats;     // host visible
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        uint32_t lightCount = 0;
+        bool isPending = false;  // assigned, its stats are read on the next begin
+    };
+
+    const vk::Device& m_device;
+    uint32_t m_lightCapacity;
+
+    const PipelineLayout* m_pipelineLayout = nullptr;
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+    std::vector<FrameResources> m_frames;
+    uint32_t m_frameIndex = 0;
+
+    glm::mat4 m_inverseProjection{1.0f};
+    VkExtent2D m_extent{};
+    float m_nearPlane = 0.1f;
+    float m_farPlane = 1.0f;
+
+    ClusterStats m_stats;
+    uint32_t m_reportFrames = 0;
+    uint64_t m_reportLights = 0;
+    uint64_t m_reportIndices = 0;
+    uint32_t m_reportMaxClusterLights = 0;
+    uint64_t m_reportOverflows = 0;
+
+private:
+    void _createComputePipeline(const ShaderLibrary& shaders, LayoutCache& layoutCache);
+    void _createDescriptorSets();
+};
+
+}  // namespace eng
\ No newline at end of file
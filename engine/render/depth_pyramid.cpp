@@ -0,0 +1,208 @@
+#include "render/depth_pyramid.h"
+#include <bit>
+#include "texture/mip_generator.h"
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t WORKGROUP_SIZE = 8;
+
+}  // namespace
+
+DepthPyramid::DepthPyramid(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, SamplerCache& samplerCache)
+    : m_device(device), m_physicalDevice(physicalDevice) {
+    // texels are fetched, never filtered
+    VkSamplerCreateInfo samplerInfo = vk::samplerCreateInfo();
+    {
+        samplerInfo.magFilter = VK_FILTER_NEAREST;
+        samplerInfo.minFilter = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    }
+    m_sampler = &samplerCache.get(samplerInfo);
+
+    _createComputePipeline(shaders, layoutCache);
+}
+
+DepthPyramid::~DepthPyramid() {
+    _destroyLevels();
+    vkDestroyPipeline(m_device.get(), m_pipeline, nullptr);
+}
+
+void DepthPyramid::resize(const vk::Image& depth) {
+    _destroyLevels();
+
+    m_depthExtent = {depth.getExtent().width, depth.getExtent().height};
+    uint32_t width = std::bit_ceil((m_depthExtent.width + 1) / 2);
+    uint32_t height = std::bit_ceil((m_depthExtent.height + 1) / 2);
+    uint32_t levelCount = MipGenerator::getMipLevelCount(width, height);
+
+    VkImageCreateInfo imageInfo = vk::imageCreateInfo();
+    {
+        imageInfo.format = m_FORMAT;
+        imageInfo.extent.width = width;
+        imageInfo.extent.height = height;
+        imageInfo.mipLevels = levelCount;
+        imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    }
+    m_image = std::make_unique<vk::Image>(m_device, m_physicalDevice, imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    m_levelViews.resize(levelCount);
+    for (uint32_t level = 0; level < levelCount; level++) {
+        VkImageViewCreateInfo viewInfo = vk::imageViewCreateInfo();
+        {
+            viewInfo.image = m_image->get();
+            viewInfo.format = m_FORMAT;
+            viewInfo.subresourceRange.baseMipLevel = level;
+        }
+
+        if (vkCreateImageView(m_device.get(), &viewInfo, nullptr, &m_levelViews[level]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create depth pyramid view!");
+        }
+    }
+
+    std::vector<VkDescriptorPoolSize> poolSizes = m_pipelineLayout->getPoolSizes(0, levelCount);
+    VkDescriptorPoolCreateInfo poolInfo{};
+    {
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = levelCount;
+    }
+
+    if (vkCreateDescriptorPool(m_device.get(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create depth pyramid descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(levelCount, m_pipelineLayout->setLayouts[0]);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    {
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_descriptorPool;
+        allocInfo.descriptorSetCount = levelCount;
+        allocInfo.pSetLayouts = layouts.data();
+    }
+
+    m_descriptorSets.resize(levelCount);
+    if (vkAllocateDescriptorSets(m_device.get(), &allocInfo, m_descriptorSets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate depth pyramid descriptor sets!");
+    }
+
+    for (uint32_t level = 0; level < levelCount; level++) {
+        VkDescriptorImageInfo srcInfo{
+            .sampler = m_sampler->get(),
+            .imageView = level == 0 ? depth.getView() : m_levelViews[level - 1],
+            .imageLayout = level == 0 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL};
+        VkDescriptorImageInfo dstInfo{
+            .sampler = VK_NULL_HANDLE,
+            .imageView = m_levelViews[level],
+            .imageLayout = VK_IMAGE_LAYOUT_GENERAL};
+
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        {
+            writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[0].dstSet = m_descriptorSets[level];
+            writes[0].dstBinding = 0;
+            writes[0].descriptorCount = 1;
+            writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[0].pImageInfo = &srcInfo;
+
+            writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[1].dstSet = m_descriptorSets[level];
+            writes[1].dstBinding = 1;
+            writes[1].descriptorCount = 1;
+            writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            writes[1].pImageInfo = &dstInfo;
+        }
+        vkUpdateDescriptorSets(m_device.get(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
+    m_isValid = false;
+}
+
+void DepthPyramid::build(const vk::CommandBuffer& cmd, const glm::mat4& viewProjection, VkExtent2D renderExtent) {
+    // the culling of the last build may still read it
+    cmd.transitionImageLayout(*m_image, m_isValid ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+
+    cmd.bindPipeline(m_pipeline, VK_PIPELINE_BIND_POINT_COMPUTE);
+
+    for (uint32_t level = 0; level < getLevelCount(); level++) {
+        if (level > 0) {
+            cmd.transitionImageLayout(*m_image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                      level - 1, 1);
+        }
+
+        cmd.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout->layout, &m_descriptorSets[level]);
+
+        // a texel of level n covers 2^(n + 1) pixels, the reduction at the edge of the render
+        // extent also takes in stale depth, which can only make it farther
+        uint32_t width = std::clamp(((renderExtent.width - 1) >> (level + 1)) + 1, 1u, std::max(m_image->getExtent().width >> level, 1u));
+        uint32_t height = std::clamp(((renderExtent.height - 1) >> (level + 1)) + 1, 1u, std::max(m_image->getExtent().height >> level, 1u));
+        cmd.dispatch((width + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, (height + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE);
+    }
+
+    cmd.transitionImageLayout(*m_image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                              getLevelCount() - 1, 1);
+
+    m_viewProjection = viewProjection;
+    m_renderExtent = renderExtent;
+    m_isValid = true;
+}
+
+void DepthPyramid::_createComputePipeline(const ShaderLibrary& shaders, LayoutCache& layoutCache) {
+    Asset code = shaders.load("shaders/bin/depth_pyramid_comp.spv");
+    ShaderReflection reflection = reflectShader(code.getSpan());
+    m_pipelineLayout = &layoutCache.get({&reflection, 1});
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = code.getSize();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code.getData());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(m_device.get(), &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create shader module!");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = shaderModule,
+            .pName = "main"},
+        .layout = m_pipelineLayout->layout};
+
+    VkResult result = vkCreateComputePipelines(m_device.get(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
+    vkDestroyShaderModule(m_device.get(), shaderModule, nullptr);
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create depth pyramid pipeline!");
+    }
+}
+
+void DepthPyramid::_destroyLevels() {
+    for (VkImageView view : m_levelViews) {
+        vkDestroyImageView(m_device.get(), view, nullptr);
+    }
+    m_levelViews.clear();
+
+    if (m_descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(m_device.get(), m_descriptorPool, nullptr);
+        m_descriptorPool = VK_NULL_HANDLE;
+    }
+    m_descriptorSets.clear();
+
+    m_image.reset();
+}
+
+}  // namespace eng
\ No newline at end of file
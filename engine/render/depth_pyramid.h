@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <glm/glm.hpp>
+#include "shared.h"
+#include "shader/layout_cache.h"
+#include "shader/shader_library.h"
+#include "texture/sampler_cache.h"
+#include "wrapper/vk/command_buffer.h"
+#include "wrapper/vk/image.h"
+
+namespace eng {
+
+// hierarchical z over a depth attachment, a mip chain where every texel keeps the
+// farthest depth below it. level 0 is half the depth rounded up to a power of two,
+// so each level halves the one before exactly and a texel of level n covers
+// 2^(n + 1) pixels of the depth. the image stays in GENERAL.
+class DepthPyramid {
+public:
+    DepthPyramid(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, SamplerCache& samplerCache);
+    ~DepthPyramid();
+
+    DepthPyramid(const DepthPyramid&) = delete;
+    DepthPyramid& operator=(const DepthPyramid&) = delete;
+
+    // after the depth attachment was (re)created, no frame in flight may use the old pyramid
+    void resize(const vk::Image& depth);
+
+    // expects the depth in SHADER_READ_ONLY_OPTIMAL with its writes visible to compute,
+    // leaves every level readable by compute shaders. only the texels over renderExtent,
+    // the top left of the depth the view was rendered into, are reduced.
+    void build(const vk::CommandBuffer& cmd, const glm::mat4& viewProjection, VkExtent2D renderExtent);
+
+    // false until the first build after a resize
+    inline bool isValid() const { return m_isValid; }
+    inline const vk::Image& getImage() const { return *m_image; }
+    inline const vk::Sampler& getSampler() const { return *m_sampler; }
+    inline uint32_t getLevelCount() const { return m_image->getMipLevels(); }
+    inline VkExtent2D getDepthExtent() const { return m_depthExtent; }
+    // the part of the depth the last build covered, whatever lies past it is stale
+    inline VkExtent2D getRenderExtent() const { return m_renderExtent; }
+    // the view the depth of the last build was rendered from
+    inline const glm::mat4& getViewProjection() const { return m_viewProjection; }
+
+private:
+    static constexpr VkFormat m_FORMAT = VK_FORMAT_R32_SFLOAT;
+
+    const vk::Device& m_device;
+    const vk::PhysicalDevice& m_physicalDevice;
+
+    const PipelineLayout* m_pipelineLayout = nullptr;
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+    const vk::Sampler* m_sampler = nullptr;
+
+    std::unique_ptr<vk::Image> m_image;
+    std::vector<VkImageView> m_levelViews;
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> m_descriptorSets;  // per level, the level below as source
+
+    VkExtent2D m_depthExtent{};
+    VkExtent2D m_renderExtent{};
+    glm::mat4 m_viewProjection{1.0f};
+    bool m_isValid = false;
+
+private:
+    void _createComputePipeline(const ShaderLibrary& shaders, LayoutCache& layoutCache);
+    void _destroyLevels();
+};
+
+}  // namespace eng
\ No newline at end of file
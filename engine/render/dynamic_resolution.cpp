@@ -0,0 +1,130 @@
+#include "render/dynamic_resolution.h"
+#include <cmath>
+
+namespace eng {
+
+DynamicResolution::DynamicResolution(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, uint32_t frameCount, float budgetMilliseconds)
+    : m_device(device), m_budget(budgetMilliseconds), m_isPending(frameCount, 0) {
+    const VkPhysicalDeviceLimits& limits = physicalDevice.getProperties().limits;
+    if (!limits.timestampComputeAndGraphics) {
+        return;
+    }
+    m_timestampPeriod = limits.timestampPeriod;
+
+    // the bits above timestampValidBits are undefined, the difference is taken modulo the valid range
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice.get(), &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice.get(), &queueFamilyCount, queueFamilies.data());
+    uint32_t validBits = queueFamilies[physicalDevice.getQueueFamilyIndices().graphicsFamily.value()].timestampValidBits;
+    if (validBits == 0) {
+        return;
+    }
+    m_timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    VkQueryPoolCreateInfo poolInfo{
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = frameCount * 2};
+
+    if (vkCreateQueryPool(m_device.get(), &poolInfo, nullptr, &m_queryPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+}
+
+DynamicResolution::~DynamicResolution() {
+    vkDestroyQueryPool(m_device.get(), m_queryPool, nullptr);
+}
+
+void DynamicResolution::beginFrame(uint32_t frameIndex) {
+    m_frameIndex = frameIndex;
+    if (!m_isPending[frameIndex]) {
+        return;
+    }
+    m_isPending[frameIndex] = 0;
+
+    std::array<uint64_t, 2> timestamps;
+    VkResult result = vkGetQueryPoolResults(m_device.get(), m_queryPool, frameIndex * 2, 2, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_SUCCESS) {
+        uint64_t ticks = (timestamps[1] - timestamps[0]) & m_timestampMask;
+        _adjust(static_cast<float>(ticks * m_timestampPeriod * 1e-6));
+    }
+}
+
+void DynamicResolution::beginTimer(const vk::CommandBuffer& cmd) {
+    if (!isSupported()) {
+        return;
+    }
+
+    cmd.resetQueryPool(m_queryPool, m_frameIndex * 2, 2);
+    cmd.writeTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, m_frameIndex * 2);
+}
+
+void DynamicResolution::endTimer(const vk::CommandBuffer& cmd) {
+    if (!isSupported()) {
+        return;
+    }
+
+    cmd.writeTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, m_frameIndex * 2 + 1);
+    m_isPending[m_frameIndex] = 1;
+}
+
+void DynamicResolution::setFixedScale(float scale) {
+    m_steps = std::clamp(static_cast<uint32_t>(std::lround(scale * m_SCALE_STEPS)), m_MIN_STEPS, m_SCALE_STEPS);
+    m_isFixed = true;
+}
+
+VkExtent2D DynamicResolution::getRenderExtent(VkExtent2D maxExtent) const {
+    return {
+        std::max((maxExtent.width * m_steps + m_SCALE_STEPS / 2) / m_SCALE_STEPS, 1u),
+        std::max((maxExtent.height * m_steps + m_SCALE_STEPS / 2) / m_SCALE_STEPS, 1u)};
+}
+
+void DynamicResolution::report() {
+    uint32_t frames = std::max(m_reportFrames, 1u);
+    std::cout << "dynamic resolution: " << m_reportMilliseconds / frames << " ms on the gpu per frame against " << m_budget << " ms, scale "
+              << m_reportScale / frames << " on average, at least " << static_cast<float>(m_reportMinSteps) / m_SCALE_STEPS << ", "
+              << m_reportChanges << " changes" << (isSupported() ? "" : ", no timestamps") << (m_isFixed ? ", fixed" : "") << std::endl;
+
+    m_reportFrames = 0;
+    m_reportMilliseconds = 0.0;
+    m_reportScale = 0.0;
+    m_reportMinSteps = m_steps;
+    m_reportChanges = 0;
+}
+
+void DynamicResolution::_adjust(float milliseconds) {
+    m_reportFrames++;
+    m_reportMilliseconds += milliseconds;
+    m_reportScale += getScale();
+    m_reportMinSteps = std::min(m_reportMinSteps, m_steps);
+
+    if (m_isFixed) {
+        return;
+    }
+    if (m_settleFrames > 0) {
+        m_settleFrames--;
+        return;
+    }
+
+    m_smoothedMilliseconds = m_smoothedMilliseconds == 0.0f ? milliseconds : m_smoothedMilliseconds + (milliseconds - m_smoothedMilliseconds) * m_SMOOTHING;
+
+    uint32_t steps = m_steps;
+    if (m_smoothedMilliseconds > m_budget * m_UPPER_THRESHOLD) {
+        // the time follows the pixel count, the square of the scale. aims between the thresholds.
+        float target = getScale() * std::sqrt(m_budget * (m_UPPER_THRESHOLD + m_LOWER_THRESHOLD) * 0.5f / m_smoothedMilliseconds);
+        steps = std::min(static_cast<uint32_t>(target * m_SCALE_STEPS), m_steps - 1);
+    } else if (m_smoothedMilliseconds < m_budget * m_LOWER_THRESHOLD) {
+        steps = m_steps + 1;
+    }
+
+    steps = std::clamp(steps, m_MIN_STEPS, m_SCALE_STEPS);
+    if (steps != m_steps) {
+        m_steps = steps;
+        m_smoothedMilliseconds = 0.0f;
+        m_settleFrames = m_SETTLE_FRAMES;
+        m_reportChanges++;
+    }
+}
+
+}  // namespace eng
\ No newline at end of file
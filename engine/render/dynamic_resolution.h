@@ -0,0 +1,74 @@
+#pragma once
+
+#include "shared.h"
+#include "wrapper/vk/command_buffer.h"
+#include "wrapper/vk/device.h"
+#include "wrapper/vk/physical_device.h"
+
+namespace eng {
+
+// scales the resolution the scene is rendered at so the gpu time of a frame stays
+// within a budget. timestamps around each frame's command buffer are read back once
+// its fence was waited on, and the smoothed time is held between two thresholds under
+// the budget with hysteresis: past the upper one the scale drops straight to where the
+// time should land between them, under the lower one it grows a step at a time, and
+// after every change it holds until frames at the new scale were measured. the render
+// targets keep their full size, only the viewport follows the scale.
+class DynamicResolution {
+public:
+    DynamicResolution(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, uint32_t frameCount, float budgetMilliseconds);
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // after the frame's fence was waited on, reads the gpu time of its last use and
+    // adjusts the scale
+    void beginFrame(uint32_t frameIndex);
+    // the first and the last commands of the frame's command buffer
+    void beginTimer(const vk::CommandBuffer& cmd);
+    void endTimer(const vk::CommandBuffer& cmd);
+
+    // holds the scale, rounded to a step, the frames are still timed
+    void setFixedScale(float scale);
+    // maxExtent, the size of the render targets, scaled
+    VkExtent2D getRenderExtent(VkExtent2D maxExtent) const;
+    inline float getScale() const { return static_cast<float>(m_steps) / m_SCALE_STEPS; }
+    // without timestamps on the graphics queue the scale stays at the maximum
+    inline bool isSupported() const { return m_queryPool != VK_NULL_HANDLE; }
+
+    // logs the averages since the last report
+    void report();
+
+private:
+    static constexpr uint32_t m_SCALE_STEPS = 20;  // the scale is a multiple of 1 / m_SCALE_STEPS
+    static constexpr uint32_t m_MIN_STEPS = 10;    // half the resolution along each axis
+    static constexpr float m_UPPER_THRESHOLD = 0.95f;  // of the budget, the scale drops past it
+    static constexpr float m_LOWER_THRESHOLD = 0.75f;  // and grows under it
+    static constexpr float m_SMOOTHING = 0.2f;         // weight of the newest frame
+    static constexpr uint32_t m_SETTLE_FRAMES = 8;     // ignored after a change, some were recorded at the old scale
+
+    const vk::Device& m_device;
+    VkQueryPool m_queryPool = VK_NULL_HANDLE;  // a begin and an end timestamp per frame
+    float m_timestampPeriod = 1.0f;            // nanoseconds per tick
+    uint64_t m_timestampMask = ~0ull;          // the valid bits of a timestamp on the graphics queue
+    float m_budget;
+    std::vector<uint8_t> m_isPending;          // per frame, timed and not read back yet
+    uint32_t m_frameIndex = 0;
+
+    uint32_t m_steps = m_SCALE_STEPS;
+    bool m_isFixed = false;
+    float m_smoothedMilliseconds = 0.0f;  // zero until a frame at the current scale was measured
+    uint32_t m_settleFrames = 0;
+
+    uint32_t m_reportFrames = 0;
+    double m_reportMilliseconds = 0.0;
+    double m_reportScale = 0.0;
+    uint32_t m_reportMinSteps = m_SCALE_STEPS;
+    uint32_t m_reportChanges = 0;
+
+private:
+    void _adjust(float milliseconds);
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,280 @@
+#include "render/occlusion_culler.h"
+#include "shader/specialization_constants.h"
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t WORKGROUP_SIZE = 64;
+
+// the CullConstants block of occlusion_cull.comp
+struct CullConstants {
+    glm::mat4 viewProjection;
+    glm::vec2 depthSize;
+    uint32_t candidateCount;
+    uint32_t levelCount;
+};
+
+static_assert(sizeof(OcclusionCandidate) == 48, "candidate must match the std430 layout of the shader");
+
+vk::Buffer createBuffer(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
+    VkBufferCreateInfo bufferInfo = vk::bufferCreateInfo();
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    return vk::Buffer(device, physicalDevice, bufferInfo, properties);
+}
+
+}  // namespace
+
+OcclusionCuller::FrameResources::FrameResources(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, uint32_t capacity)
+    : candidates(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(capacity) * sizeof(OcclusionCandidate), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)),
+      earlyCommands(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(capacity) * sizeof(VkDrawIndexedIndirectCommand),
+                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)),
+      lateCommands(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(capacity) * sizeof(VkDrawIndexedIndirectCommand),
+                                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)),
+      retest(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(capacity) * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)),
+      stats(createBuffer(device, physicalDevice, sizeof(CullStats), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+    CullStats zero{};
+    stats.setData(&zero, sizeof(zero));
+}
+
+OcclusionCuller::OcclusionCuller(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, SamplerCache& samplerCache, uint32_t capacity, uint32_t frameCount)
+    : m_device(device), m_capacity(capacity), m_pyramid(device, physicalDevice, shaders, layoutCache, samplerCache) {
+    m_frames.reserve(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++) {
+        m_frames.emplace_back(device, physicalDevice, capacity);
+    }
+
+    _createComputePipelines(shaders, layoutCache);
+    _createDescriptorSets();
+}
+
+OcclusionCuller::~OcclusionCuller() {
+    vkDestroyDescriptorPool(m_device.get(), m_descriptorPool, nullptr);
+    for (VkPipeline pipeline : m_pipelines) {
+        vkDestroyPipeline(m_device.get(), pipeline, nullptr);
+    }
+}
+
+bool OcclusionCuller::isSupported(const vk::Device& device) {
+    return device.getFeatures().drawIndirectFirstInstance;
+}
+
+void OcclusionCuller::resize(const vk::Image& depth) {
+    m_pyramid.resize(depth);
+
+    VkDescriptorImageInfo pyramidInfo{
+        .sampler = m_pyramid.getSampler().get(),
+        .imageView = m_pyramid.getImage().getView(),
+        .imageLayout = VK_IMAGE_LAYOUT_GENERAL};
+
+    for (FrameResources& frame : m_frames) {
+        VkWriteDescriptorSet descriptorWrite{};
+        {
+            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrite.dstSet = frame.descriptorSet;
+            descriptorWrite.dstBinding = 0;
+            descriptorWrite.descriptorCount = 1;
+            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            descriptorWrite.pImageInfo = &pyramidInfo;
+        }
+        vkUpdateDescriptorSets(m_device.get(), 1, &descriptorWrite, 0, nullptr);
+    }
+}
+
+void OcclusionCuller::beginFrame(uint32_t frameIndex) {
+    m_frameIndex = frameIndex;
+    FrameResources& frame = m_frames[frameIndex];
+
+    if (frame.isPending) {
+        CullStats stats;
+        frame.stats.getData(&stats, sizeof(stats));
+        m_stats = {frame.candidateCount, stats.retestCount, stats.disoccludedCount};
+
+        m_reportFrames++;
+        m_reportCandidates += m_stats.candidates;
+        m_reportRetested += m_stats.retested;
+        m_reportDisoccluded += m_stats.disoccluded;
+
+        CullStats zero{};
+        frame.stats.setData(&zero, sizeof(zero));
+        frame.isPending = false;
+    }
+
+    frame.candidateCount = 0;
+}
+
+void OcclusionCuller::add(const Aabb& worldBounds, const MeshRange& mesh, uint32_t lod, TransformHandle instance) {
+    FrameResources& frame = m_frames[m_frameIndex];
+    if (frame.candidateCount == m_capacity) {
+        throw std::runtime_error("too many occlusion culling candidates!");
+    }
+
+    const MeshLod& level = mesh.lods[std::min(lod, mesh.lodCount - 1)];
+    OcclusionCandidate candidate{
+        .boundsMin = glm::vec4(worldBounds.min, 0.0f),
+        .boundsMax = glm::vec4(worldBounds.max, 0.0f),
+        .indexCount = level.indexCount,
+        .firstIndex = level.firstIndex,
+        .vertexOffset = mesh.vertexOffset,
+        .instance = instance};
+    frame.candidates.setData(&candidate, sizeof(candidate), static_cast<VkDeviceSize>(frame.candidateCount) * sizeof(candidate));
+    frame.candidateCount++;
+}
+
+void OcclusionCuller::cullEarly(const vk::CommandBuffer& cmd) {
+    _dispatch(cmd, false, m_pyramid.getViewProjection());
+
+    // the late pass reads the retest list and completes the late commands
+    VkMemoryBarrier barrier = vk::memoryBarrier();
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    cmd.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, barrier);
+
+    m_frames[m_frameIndex].isPending = true;
+}
+
+void OcclusionCuller::cullLate(const vk::CommandBuffer& cmd, const glm::mat4& viewProjection, VkExtent2D renderExtent) {
+    m_pyramid.build(cmd, viewProjection, renderExtent);
+    _dispatch(cmd, true, viewProjection);
+
+    // the stats are read on the host once the frame's fence was signaled
+    VkMemoryBarrier barrier = vk::memoryBarrier();
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+    cmd.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT, barrier);
+}
+
+void OcclusionCuller::buildPyramid(const vk::CommandBuffer& cmd, const glm::mat4& viewProjection, VkExtent2D renderExtent) {
+    m_pyramid.build(cmd, viewProjection, renderExtent);
+}
+
+void OcclusionCuller::report() {
+    uint32_t frames = std::max(m_reportFrames, 1u);
+    uint64_t occluded = m_reportRetested - m_reportDisoccluded;
+    std::cout << "occlusion culling: " << m_reportCandidates / frames << " candidates, "
+              << (m_reportCandidates - m_reportRetested) / frames << " drawn in the first pass, "
+              << m_reportRetested / frames << " retested, " << m_reportDisoccluded / frames << " disoccluded, "
+              << occluded / frames << " occluded per frame" << std::endl;
+
+    m_reportFrames = 0;
+    m_reportCandidates = 0;
+    m_reportRetested = 0;
+    m_reportDisoccluded = 0;
+}
+
+void OcclusionCuller::_createComputePipelines(const ShaderLibrary& shaders, LayoutCache& layoutCache) {
+    Asset code = shaders.load("shaders/bin/occlusion_cull_comp.spv");
+    ShaderReflection reflection = reflectShader(code.getSpan());
+    m_pipelineLayout = &layoutCache.get({&reflection, 1});
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = code.getSize();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code.getData());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(m_device.get(), &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create shader module!");
+    }
+
+    for (uint32_t i = 0; i < m_pipelines.size(); i++) {
+        // constant 0 selects the late pass
+        SpecializationConstants constants;
+        constants.set(0, i == 1);
+        VkSpecializationInfo specializationInfo = constants.getInfo();
+
+        VkComputePipelineCreateInfo pipelineInfo{
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = shaderModule,
+                .pName = "main",
+                .pSpecializationInfo = &specializationInfo},
+            .layout = m_pipelineLayout->layout};
+
+        if (vkCreateComputePipelines(m_device.get(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipelines[i]) != VK_SUCCESS) {
+            vkDestroyShaderModule(m_device.get(), shaderModule, nullptr);
+            throw std::runtime_error("failed to create occlusion culling pipeline!");
+        }
+    }
+
+    vkDestroyShaderModule(m_device.get(), shaderModule, nullptr);
+}
+
+void OcclusionCuller::_createDescriptorSets() {
+    uint32_t frameCount = static_cast<uint32_t>(m_frames.size());
+    std::vector<VkDescriptorPoolSize> poolSizes = m_pipelineLayout->getPoolSizes(0, frameCount);
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    {
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = frameCount;
+    }
+
+    if (vkCreateDescriptorPool(m_device.get(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create occlusion culling descriptor pool!");
+    }
+
+    for (FrameResources& frame : m_frames) {
+        VkDescriptorSetAllocateInfo allocInfo{};
+        {
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool = m_descriptorPool;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &m_pipelineLayout->setLayouts[0];
+        }
+
+        if (vkAllocateDescriptorSets(m_device.get(), &allocInfo, &frame.descriptorSet) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate occlusion culling descriptor set!");
+        }
+
+        // binding 0, the pyramid, is written on resize
+        std::array<const vk::Buffer*, 5> buffers = {&frame.candidates, &frame.earlyCommands, &frame.lateCommands, &frame.retest, &frame.stats};
+        std::array<VkDescriptorBufferInfo, 5> bufferInfos;
+        std::array<VkWriteDescriptorSet, 5> writes{};
+        for (uint32_t i = 0; i < buffers.size(); i++) {
+            bufferInfos[i] = {
+                .buffer = buffers[i]->get(),
+                .offset = 0,
+                .range = VK_WHOLE_SIZE};
+
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = frame.descriptorSet;
+            writes[i].dstBinding = i + 1;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(m_device.get(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+}
+
+void OcclusionCuller::_dispatch(const vk::CommandBuffer& cmd, bool isLate, const glm::mat4& viewProjection) {
+    FrameResources& frame = m_frames[m_frameIndex];
+    if (frame.candidateCount == 0) {
+        return;
+    }
+
+    // the bounds are projected onto the part of the depth that was rendered
+    VkExtent2D renderExtent = m_pyramid.getRenderExtent();
+    CullConstants constants{
+        .viewProjection = viewProjection,
+        .depthSize = glm::vec2(renderExtent.width, renderExtent.height),
+        .candidateCount = frame.candidateCount,
+        .levelCount = m_pyramid.isValid() ? m_pyramid.getLevelCount() : 0};
+
+    cmd.bindPipeline(m_pipelines[isLate ? 1 : 0], VK_PIPELINE_BIND_POINT_COMPUTE);
+    cmd.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout->layout, &frame.descriptorSet);
+    cmd.pushConstants(m_pipelineLayout->layout, VK_SHADER_STAGE_COMPUTE_BIT, constants);
+    // the late pass only has work for the retested candidates, the rest return at once
+    cmd.dispatch((frame.candidateCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE);
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "shared.h"
+#include "geometry/bounds.h"
+#include "geometry/geometry_buffer.h"
+#include "render/depth_pyramid.h"
+#include "scene/transform_system.h"
+#include "wrapper/vk/buffer.h"
+
+namespace eng {
+
+// what the cull shader reads per candidate, std430
+struct OcclusionCandidate {
+    glm::vec4 boundsMin;  // world space, w unused
+    glm::vec4 boundsMax;
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t instance;
+};
+
+// of one frame, read back once its fence was waited on
+struct OcclusionStats {
+    uint32_t candidates = 0;
+    uint32_t retested = 0;     // behind the previous frame's depth
+    uint32_t disoccluded = 0;  // retested and visible after all
+};
+
+// two phase occlusion culling on the gpu. candidates, objects that passed frustum
+// culling with the level of detail to draw, are tested against the depth pyramid of
+// the previous frame and the ones in front of it are drawn first. the pyramid is then
+// rebuilt from that depth and the occluded candidates are tested again, the ones it
+// no longer hides are drawn by a second pass. each pass is one indirect draw with a
+// command per candidate, culled commands have no instance.
+class OcclusionCuller {
+public:
+    OcclusionCuller(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, SamplerCache& samplerCache, uint32_t capacity, uint32_t frameCount);
+    ~OcclusionCuller();
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    // the commands pick the world matrix through their first instance
+    static bool isSupported(const vk::Device& device);
+
+    // after the depth attachment was (re)created
+    void resize(const vk::Image& depth);
+
+    // after the frame's fence was waited on, collects the stats of its last use
+    void beginFrame(uint32_t frameIndex);
+    // every candidate of a frame has to be in the same index buffer
+    void add(const Aabb& worldBounds, const MeshRange& mesh, uint32_t lod, TransformHandle instance);
+
+    // before the first pass, against the pyramid of the last frame
+    void cullEarly(const vk::CommandBuffer& cmd);
+    // between the passes, rebuilds the pyramid from the depth of the first one.
+    // renderExtent is the part of the depth attachment the passes render into.
+    void cullLate(const vk::CommandBuffer& cmd, const glm::mat4& viewProjection, VkExtent2D renderExtent);
+    // after the second pass, so the next frame tests against the complete depth
+    void buildPyramid(const vk::CommandBuffer& cmd, const glm::mat4& viewProjection, VkExtent2D renderExtent);
+
+    // VkDrawIndexedIndirectCommands of the first or second pass, one per candidate
+    inline const vk::Buffer& getCommands(bool isLate) const { return isLate ? m_frames[m_frameIndex].lateCommands : m_frames[m_frameIndex].earlyCommands; }
+    inline uint32_t getCandidateCount() const { return m_frames[m_frameIndex].candidateCount; }
+    inline const OcclusionStats& getStats() const { return m_stats; }
+
+    // logs the averages since the last report
+    void report();
+
+private:
+    // the CullStats block of occlusion_cull.comp
+    struct CullStats {
+        uint32_t retestCount;
+        uint32_t disoccludedCount;
+    };
+
+    struct FrameResources {
+        FrameResources(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, uint32_t capacity);
+
+        vk::Buffer candidates;  // host visible
+        vk::Buffer earlyCommands;
+        vk::Buffer lateCommands;
+        vk::Buffer retest;      // candidates occluded in the early pass
+        vk::Buffer stats;       // host visible
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        uint32_t candidateCount = 0;
+        bool isPending = false;  // culled, its stats are read on the next begin
+    };
+
+    const vk::Device& m_device;
+    uint32_t m_capacity;
+
+    DepthPyramid m_pyramid;
+    const PipelineLayout* m_pipelineLayout = nullptr;
+    std::array<VkPipeline, 2> m_pipelines{};  // early and late pass
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+    std::vector<FrameResources> m_frames;
+    uint32_t m_frameIndex = 0;
+
+    OcclusionStats m_stats;
+    uint32_t m_reportFrames = 0;
+    uint64_t m_reportCandidates = 0;
+    uint64_t m_reportRetested = 0;
+    uint64_t m_reportDisoccluded = 0;
+
+private:
+    void _createComputePipelines(const ShaderLibrary& shaders, LayoutCache& layoutCache);
+    void _createDescriptorSets();
+    void _dispatch(const vk::CommandBuffer& cmd, bool isLate, const glm::mat4& viewProjection);
+};
+
+}  // namespace eng
\ No newline at end of file
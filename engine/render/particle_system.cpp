@@ -0,0 +1,455 @@
+#include "render/particle_system.h"
+#include <cmath>
+#include <cstddef>
+#include "shader/specialization_constants.h"
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t WORKGROUP_SIZE = 64;
+constexpr float GRAVITY = 2.0f;  // along -z, which is down
+constexpr float DRAG = 0.3f;     // fraction of the velocity lost per second
+
+// the stages of particle_update.comp, its constant 0
+constexpr uint32_t STAGE_INIT = 0;
+constexpr uint32_t STAGE_PREPARE = 1;
+constexpr uint32_t STAGE_EMIT = 2;
+constexpr uint32_t STAGE_SIMULATE = 3;
+constexpr uint32_t STAGE_FINISH = 4;
+
+// the Particle struct of the shaders, std430
+struct Particle {
+    glm::vec4 positionAge;
+    glm::vec4 velocityLifetime;
+    glm::vec4 color;
+};
+
+// the Counters block of particle_update.comp
+struct ParticleCounters {
+    VkDispatchIndirectCommand emitDispatch;
+    VkDispatchIndirectCommand simulateDispatch;
+    VkDrawIndirectCommand drawCommand;
+    uint32_t deadCount;
+    uint32_t aliveCount[2];
+    uint32_t emitCount;
+};
+
+// the ParticleConstants block of particle_update.comp
+struct ParticleConstants {
+    glm::vec4 gravityDrag;
+    float deltaTime;
+    uint32_t capacity;
+    uint32_t current;
+    uint32_t requested;
+    uint32_t emitterCount;
+    uint32_t seed;
+};
+
+// the ParticleDrawConstants block of particle.vert
+struct ParticleDrawConstants {
+    glm::mat4 viewProjection;
+    glm::vec4 cameraRight;
+    glm::vec4 cameraUp;
+    uint32_t aliveOffset;
+};
+
+static_assert(sizeof(Particle) == 48, "particle must match the std430 layout of the shaders");
+
+vk::Buffer createBuffer(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
+    VkBufferCreateInfo bufferInfo = vk::bufferCreateInfo();
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    return vk::Buffer(device, physicalDevice, bufferInfo, properties);
+}
+
+// makes the compute writes so far visible to what follows
+void computeBarrier(const vk::CommandBuffer& cmd, VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask) {
+    VkMemoryBarrier barrier = vk::memoryBarrier();
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = dstAccessMask;
+    cmd.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStageMask, barrier);
+}
+
+}  // namespace
+
+ParticleSystem::FrameResources::FrameResources(const vk::Device& device, const vk::PhysicalDevice& physicalDevice)
+    : emitters(createBuffer(device, physicalDevice, m_MAX_EMITTERS * sizeof(EmitterData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)),
+      stats(createBuffer(device, physicalDevice, sizeof(ParticleStats), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {}
+
+ParticleSystem::ParticleSystem(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, VkRenderPass renderPass, uint32_t capacity, uint32_t frameCount)
+    : m_device(device),
+      m_capacity(capacity),
+      m_particles(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(capacity) * sizeof(Particle), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)),
+      m_deadList(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(capacity) * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)),
+      m_aliveLists(createBuffer(device, physicalDevice, 2 * static_cast<VkDeviceSize>(capacity) * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)),
+      m_counters(createBuffer(device, physicalDevice, sizeof(ParticleCounters), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+    m_frames.reserve(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++) {
+        m_frames.emplace_back(device, physicalDevice);
+    }
+
+    _createComputePipelines(shaders, layoutCache);
+    _createDrawPipeline(shaders, layoutCache, renderPass);
+    _createDescriptorSets();
+}
+
+ParticleSystem::~ParticleSystem() {
+    vkDestroyDescriptorPool(m_device.get(), m_descriptorPool, nullptr);
+    vkDestroyPipeline(m_device.get(), m_drawPipeline, nullptr);
+    for (VkPipeline pipeline : m_computePipelines) {
+        vkDestroyPipeline(m_device.get(), pipeline, nullptr);
+    }
+}
+
+void ParticleSystem::beginFrame(uint32_t frameIndex) {
+    m_frameIndex = frameIndex;
+    FrameResources& frame = m_frames[frameIndex];
+
+    if (frame.isPending) {
+        frame.stats.getData(&m_stats, sizeof(m_stats));
+
+        m_reportFrames++;
+        m_reportAlive += m_stats.aliveCount;
+        m_reportEmitted += m_stats.emitted;
+        m_reportRequested += m_stats.requested;
+        frame.isPending = false;
+    }
+
+    frame.emitterCount = 0;
+    frame.requested = 0;
+    frame.deltaTime = 0.0f;
+}
+
+void ParticleSystem::setEmitters(std::span<const ParticleEmitter> emitters, float deltaTime) {
+    if (emitters.size() > m_MAX_EMITTERS) {
+        throw std::runtime_error("too many particle emitters!");
+    }
+
+    FrameResources& frame = m_frames[m_frameIndex];
+    frame.emitterCount = static_cast<uint32_t>(emitters.size());
+    frame.requested = 0;
+    frame.deltaTime = deltaTime;
+
+    std::array<EmitterData, m_MAX_EMITTERS> data;
+    for (uint32_t i = 0; i < frame.emitterCount; i++) {
+        const ParticleEmitter& emitter = emitters[i];
+
+        // whole particles only, the rest is emitted once it adds up
+        float count = emitter.rate * deltaTime + m_emitRemainders[i];
+        uint32_t particleCount = static_cast<uint32_t>(std::floor(count));
+        m_emitRemainders[i] = count - particleCount;
+
+        data[i] = {
+            .positionRadius = glm::vec4(emitter.position, emitter.radius),
+            .velocitySpread = glm::vec4(emitter.velocity, emitter.spread),
+            .color = emitter.color,
+            .lifetime = emitter.lifetime,
+            .firstParticle = frame.requested,
+            .particleCount = particleCount};
+        frame.requested += particleCount;
+    }
+    frame.emitters.setData(data.data(), frame.emitterCount * sizeof(EmitterData));
+}
+
+void ParticleSystem::simulate(const vk::CommandBuffer& cmd) {
+    // the last frame's simulation wrote the lists and the counters, its draw may still read them
+    VkMemoryBarrier barrier = vk::memoryBarrier();
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    cmd.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, barrier);
+
+    if (!m_isInitialized) {
+        _bind(cmd, STAGE_INIT);
+        cmd.dispatch((m_capacity + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE);
+        computeBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        m_isInitialized = true;
+    }
+
+    _bind(cmd, STAGE_PREPARE);
+    cmd.dispatch(1);
+    computeBarrier(cmd, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                   VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+    _bind(cmd, STAGE_EMIT);
+    cmd.dispatchIndirect(m_counters.get(), offsetof(ParticleCounters, emitDispatch));
+    computeBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+    _bind(cmd, STAGE_SIMULATE);
+    cmd.dispatchIndirect(m_counters.get(), offsetof(ParticleCounters, simulateDispatch));
+    computeBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+    _bind(cmd, STAGE_FINISH);
+    cmd.dispatch(1);
+    // the stats are read on the host once the frame's fence was signaled
+    computeBarrier(cmd, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                   VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_HOST_READ_BIT);
+
+    m_current = 1 - m_current;
+    m_seed++;
+    m_frames[m_frameIndex].isPending = true;
+}
+
+void ParticleSystem::draw(const vk::CommandBuffer& cmd, const glm::mat4& view, const glm::mat4& viewProjection, float size) const {
+    // the rows of the view's rotation are the camera's axes in world space
+    ParticleDrawConstants constants{
+        .viewProjection = viewProjection,
+        .cameraRight = glm::vec4(view[0][0], view[1][0], view[2][0], size),
+        .cameraUp = glm::vec4(view[0][1], view[1][1], view[2][1], 0.0f),
+        .aliveOffset = m_current * m_capacity};
+
+    cmd.bindPipeline(m_drawPipeline);
+    cmd.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, m_drawLayout->layout, &m_drawDescriptorSet);
+    cmd.pushConstants(m_drawLayout->layout, VK_SHADER_STAGE_VERTEX_BIT, constants);
+    cmd.drawIndirect(m_counters.get(), offsetof(ParticleCounters, drawCommand));
+}
+
+void ParticleSystem::report() {
+    uint32_t frames = std::max(m_reportFrames, 1u);
+    std::cout << "particles: " << m_reportAlive / frames << " of " << m_capacity << " alive, "
+              << m_reportEmitted / frames << " emitted of " << m_reportRequested / frames << " requested per frame" << std::endl;
+
+    m_reportFrames = 0;
+    m_reportAlive = 0;
+    m_reportEmitted = 0;
+    m_reportRequested = 0;
+}
+
+void ParticleSystem::_createComputePipelines(const ShaderLibrary& shaders, LayoutCache& layoutCache) {
+    Asset code = shaders.load("shaders/bin/particle_update_comp.spv");
+    ShaderReflection reflection = reflectShader(code.getSpan());
+    m_computeLayout = &layoutCache.get({&reflection, 1});
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = code.getSize();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code.getData());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(m_device.get(), &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create shader module!");
+    }
+
+    for (uint32_t stage = 0; stage < m_computePipelines.size(); stage++) {
+        SpecializationConstants constants;
+        constants.set(0, stage);
+        VkSpecializationInfo specializationInfo = constants.getInfo();
+
+        VkComputePipelineCreateInfo pipelineInfo{
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = shaderModule,
+                .pName = "main",
+                .pSpecializationInfo = &specializationInfo},
+            .layout = m_computeLayout->layout};
+
+        if (vkCreateComputePipelines(m_device.get(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_computePipelines[stage]) != VK_SUCCESS) {
+            vkDestroyShaderModule(m_device.get(), shaderModule, nullptr);
+            throw std::runtime_error("failed to create particle simulation pipeline!");
+        }
+    }
+
+    vkDestroyShaderModule(m_device.get(), shaderModule, nullptr);
+}
+
+void ParticleSystem::_createDrawPipeline(const ShaderLibrary& shaders, LayoutCache& layoutCache, VkRenderPass renderPass) {
+    Asset vertCode = shaders.load("shaders/bin/particle_vert.spv");
+    Asset fragCode = shaders.load("shaders/bin/particle_frag.spv");
+    std::array<ShaderReflection, 2> reflections = {reflectShader(vertCode.getSpan()), reflectShader(fragCode.getSpan())};
+    m_drawLayout = &layoutCache.get(reflections);
+
+    std::array<const Asset*, 2> codes = {&vertCode, &fragCode};
+    std::array<VkShaderModule, 2> modules{};
+    for (uint32_t i = 0; i < modules.size(); i++) {
+        VkShaderModuleCreateInfo moduleInfo{};
+        moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInfo.codeSize = codes[i]->getSize();
+        moduleInfo.pCode = reinterpret_cast<const uint32_t*>(codes[i]->getData());
+
+        if (vkCreateShaderModule(m_device.get(), &moduleInfo, nullptr, &modules[i]) != VK_SUCCESS) {
+            vkDestroyShaderModule(m_device.get(), modules[0], nullptr);
+            throw std::runtime_error("failed to create shader module!");
+        }
+    }
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> stages{};
+    {
+        stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        stages[0].module = modules[0];
+        stages[0].pName = "main";
+
+        stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[1].module = modules[1];
+        stages[1].pName = "main";
+    }
+
+    // the quads are built from the vertex index, there is no vertex input
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST};
+
+    // the viewport is dynamic state, the counts have to match
+    VkPipelineViewportStateCreateInfo viewportState{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .viewportCount = 1,
+        .scissorCount = 1};
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_NONE,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .lineWidth = 1.0f};
+
+    VkPipelineMultisampleStateCreateInfo multisampling{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT};
+
+    // hidden by the scene, but not by each other
+    VkPipelineDepthStencilStateCreateInfo depthStencil{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_FALSE,
+        .depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL};
+
+    // premultiplied and added, the order of the particles doesn't matter
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{
+        .blendEnable = VK_TRUE,
+        .srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
+        .dstColorBlendFactor = VK_BLEND_FACTOR_ONE,
+        .colorBlendOp = VK_BLEND_OP_ADD,
+        .srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+        .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+        .alphaBlendOp = VK_BLEND_OP_ADD,
+        .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT};
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .attachmentCount = 1,
+        .pAttachments = &colorBlendAttachment};
+
+    std::array<VkDynamicState, 2> dynamicStates = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
+        .pDynamicStates = dynamicStates.data()};
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .stageCount = static_cast<uint32_t>(stages.size()),
+        .pStages = stages.data(),
+        .pVertexInputState = &vertexInputInfo,
+        .pInputAssemblyState = &inputAssembly,
+        .pViewportState = &viewportState,
+        .pRasterizationState = &rasterizer,
+        .pMultisampleState = &multisampling,
+        .pDepthStencilState = &depthStencil,
+        .pColorBlendState = &colorBlending,
+        .pDynamicState = &dynamicState,
+        .layout = m_drawLayout->layout,
+        .renderPass = renderPass,
+        .subpass = 0};
+
+    VkResult result = vkCreateGraphicsPipelines(m_device.get(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_drawPipeline);
+    for (VkShaderModule module : modules) {
+        vkDestroyShaderModule(m_device.get(), module, nullptr);
+    }
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create particle pipeline!");
+    }
+}
+
+void ParticleSystem::_createDescriptorSets() {
+    // a set per frame for the simulation, they differ in the emitters and stats, and one to draw
+    uint32_t frameCount = static_cast<uint32_t>(m_frames.size());
+    std::vector<VkDescriptorPoolSize> poolSizes = m_computeLayout->getPoolSizes(0, frameCount);
+    std::vector<VkDescriptorPoolSize> drawPoolSizes = m_drawLayout->getPoolSizes(0, 1);
+    poolSizes.insert(poolSizes.end(), drawPoolSizes.begin(), drawPoolSizes.end());
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    {
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = frameCount + 1;
+    }
+
+    if (vkCreateDescriptorPool(m_device.get(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create particle descriptor pool!");
+    }
+
+    auto allocate = [this](const PipelineLayout& layout) {
+        VkDescriptorSetAllocateInfo allocInfo{};
+        {
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool = m_descriptorPool;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &layout.setLayouts[0];
+        }
+
+        VkDescriptorSet descriptorSet;
+        if (vkAllocateDescriptorSets(m_device.get(), &allocInfo, &descriptorSet) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate particle descriptor set!");
+        }
+        return descriptorSet;
+    };
+
+    // the buffers are bound in order from binding 0
+    auto write = [this](VkDescriptorSet descriptorSet, std::span<const vk::Buffer* const> buffers) {
+        std::array<VkDescriptorBufferInfo, 6> bufferInfos;
+        std::array<VkWriteDescriptorSet, 6> writes{};
+        for (uint32_t i = 0; i < buffers.size(); i++) {
+            bufferInfos[i] = {
+                .buffer = buffers[i]->get(),
+                .offset = 0,
+                .range = VK_WHOLE_SIZE};
+
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = descriptorSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(m_device.get(), static_cast<uint32_t>(buffers.size()), writes.data(), 0, nullptr);
+    };
+
+    for (FrameResources& frame : m_frames) {
+        frame.descriptorSet = allocate(*m_computeLayout);
+        std::array<const vk::Buffer*, 6> buffers = {&m_particles, &m_deadList, &m_aliveLists, &m_counters, &frame.emitters, &frame.stats};
+        write(frame.descriptorSet, buffers);
+    }
+
+    m_drawDescriptorSet = allocate(*m_drawLayout);
+    std::array<const vk::Buffer*, 2> drawBuffers = {&m_particles, &m_aliveLists};
+    write(m_drawDescriptorSet, drawBuffers);
+}
+
+void ParticleSystem::_bind(const vk::CommandBuffer& cmd, uint32_t stage) const {
+    const FrameResources& frame = m_frames[m_frameIndex];
+    ParticleConstants constants{
+        .gravityDrag = glm::vec4(0.0f, 0.0f, -GRAVITY, DRAG),
+        .deltaTime = frame.deltaTime,
+        .capacity = m_capacity,
+        .current = m_current,
+        .requested = frame.requested,
+        .emitterCount = frame.emitterCount,
+        .seed = m_seed};
+
+    cmd.bindPipeline(m_computePipelines[stage], VK_PIPELINE_BIND_POINT_COMPUTE);
+    cmd.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, m_computeLayout->layout, &frame.descriptorSet);
+    cmd.pushConstants(m_computeLayout->layout, VK_SHADER_STAGE_COMPUTE_BIT, constants);
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <span>
+#include <glm/glm.hpp>
+#include "shared.h"
+#include "shader/layout_cache.h"
+#include "shader/shader_library.h"
+#include "wrapper/vk/buffer.h"
+#include "wrapper/vk/command_buffer.h"
+
+namespace eng {
+
+struct ParticleEmitter {
+    glm::vec3 position;  // world space
+    float radius;        // particles spawn within the sphere
+    glm::vec3 velocity;
+    float spread;        // plus up to this much in a random direction
+    glm::vec4 color;     // alpha fades to zero over the lifetime
+    float rate;          // particles per second
+    float lifetime;      // seconds
+};
+
+// of one frame, the ParticleStats block of particle_update.comp read back once the
+// frame's fence was waited on
+struct ParticleStats {
+    uint32_t aliveCount = 0;
+    uint32_t emitted = 0;
+    uint32_t requested = 0;  // more than emitted when the particles ran out
+};
+
+// particles simulated and drawn on the gpu. the particles, a dead list of the free
+// ones and two alive lists that swap every frame live in device local memory and
+// never pass through the host. each frame emits from the dead list, simulates and
+// compacts the alive list, and draws the survivors with an indirect draw whose
+// instance count the simulation wrote. the host only hands over the emitters.
+class ParticleSystem {
+public:
+    // the particles are drawn in a subpass of renderPass with a depth attachment
+    ParticleSystem(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, VkRenderPass renderPass, uint32_t capacity, uint32_t frameCount);
+    ~ParticleSystem();
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    // after the frame's fence was waited on, collects the stats of its last use
+    void beginFrame(uint32_t frameIndex);
+    // the emission of the frame, the only data going to the gpu per frame
+    void setEmitters(std::span<const ParticleEmitter> emitters, float deltaTime);
+
+    // outside of a render pass, before draw()
+    void simulate(const vk::CommandBuffer& cmd);
+    // inside the render pass, blends over what is there without writing depth
+    void draw(const vk::CommandBuffer& cmd, const glm::mat4& view, const glm::mat4& viewProjection, float size) const;
+
+    inline uint32_t getCapacity() const { return m_capacity; }
+    inline const ParticleStats& getStats() const { return m_stats; }
+
+    // logs the averages since the last report
+    void report();
+
+private:
+    static constexpr uint32_t m_MAX_EMITTERS = 64;
+
+    // the Emitter struct of particle_update.comp, std430
+    struct EmitterData {
+        glm::vec4 positionRadius;
+        glm::vec4 velocitySpread;
+        glm::vec4 color;
+        float lifetime;
+        uint32_t firstParticle;
+        uint32_t particleCount;
+        uint32_t padding;
+    };
+
+    struct FrameResources {
+        FrameResources(const vk::Device& device, const vk::PhysicalDevice& physicalDevice);
+
+        vk::Buffer emitters;  // host visible
+        vk::Buffer stats;     // host visible
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        uint32_t emitterCount = 0;
+        uint32_t requested = 0;
+        float deltaTime = 0.0f;
+        bool isPending = false;  // simulated, its stats are read on the next begin
+    };
+
+    const vk::Device& m_device;
+    uint32_t m_capacity;
+
+    vk::Buffer m_particles;
+    vk::Buffer m_deadList;
+    vk::Buffer m_aliveLists;
+    vk::Buffer m_counters;  // also the indirect dispatches and draw
+
+    const PipelineLayout* m_computeLayout = nullptr;
+    std::array<VkPipeline, 5> m_computePipelines{};  // by stage of particle_update.comp
+    const PipelineLayout* m_drawLayout = nullptr;
+    VkPipeline m_drawPipeline = VK_NULL_HANDLE;
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet m_drawDescriptorSet = VK_NULL_HANDLE;
+    std::vector<FrameResources> m_frames;
+    uint32_t m_frameIndex = 0;
+
+    bool m_isInitialized = false;
+    uint32_t m_current = 0;  // alive list the last simulation compacted into, drawn and simulated next
+    uint32_t m_seed = 0;
+    std::array<float, m_MAX_EMITTERS> m_emitRemainders{};  // fractions of particles carried to the next frame
+
+    ParticleStats m_stats;
+    uint32_t m_reportFrames = 0;
+    uint64_t m_reportAlive = 0;
+    uint64_t m_reportEmitted = 0;
+    uint64_t m_reportRequested = 0;
+
+private:
+    void _createComputePipelines(const ShaderLibrary& shaders, LayoutCache& layoutCache);
+    void _createDrawPipeline(const ShaderLibrary& shaders, LayoutCache& layoutCache, VkRenderPass renderPass);
+    void _createDescriptorSets();
+    void _bind(const vk::CommandBuffer& cmd, uint32_t stage) const;
+};
+
+}  // namespace eng
\ No newline at end of file
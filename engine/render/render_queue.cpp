@@ -0,0 +1,129 @@
+#include "render/render_queue.h"
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t ID_BITS = 12;
+constexpr uint32_t DEPTH_BITS = 24;
+constexpr uint64_t ID_MASK = (1ull << ID_BITS) - 1;
+constexpr uint32_t MESH_INDEX_TYPE_BIT = 1u << (ID_BITS - 1);  // meshes sharing an index buffer sort together
+
+constexpr uint32_t RADIX_BITS = 8;
+constexpr uint32_t RADIX_SIZE = 1u << RADIX_BITS;
+constexpr uint32_t RADIX_PASSES = 64 / RADIX_BITS;
+
+template <typename Map, typename Key>
+uint32_t getId(Map& ids, const Key& key) {
+    auto [it, isNew] = ids.try_emplace(key, static_cast<uint32_t>(ids.size()));
+    return it->second;
+}
+
+}  // namespace
+
+uint64_t makeSortKey(DrawPass pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth) {
+    uint64_t quantizedDepth = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * ((1u << DEPTH_BITS) - 1));
+    uint64_t state = (pipeline & ID_MASK) << (2 * ID_BITS) | (material & ID_MASK) << ID_BITS | (mesh & ID_MASK);
+
+    // 4 bits pass, then 36 bits state and 24 bits depth, or the other way around
+    uint64_t key = static_cast<uint64_t>(pass) << 60;
+    if (pass == DrawPass::Transparent) {
+        uint64_t farToNear = ((1u << DEPTH_BITS) - 1) - quantizedDepth;
+        return key | farToNear << (3 * ID_BITS) | state;
+    }
+    return key | state << DEPTH_BITS | quantizedDepth;
+}
+
+RenderQueue::RenderQueue(const GeometryBuffer& geometry)
+:m_geometry(geometry) {}
+
+void RenderQueue::clear(std::pmr::memory_resource& memory) {
+    m_packets.clear();
+    m_entries.clear();
+
+    m_ids.reset();
+    m_ids.emplace(&memory);
+}
+
+void RenderQueue::submit(DrawPass pass, const DrawPacket& packet, float depth) {
+    if (!m_ids) {
+        throw std::runtime_error("render queue was not cleared for the frame!");
+    }
+
+    uint64_t key = makeSortKey(pass, getId(m_ids->pipelines, packet.pipeline), getId(m_ids->materials, packet.descriptorSet), _getMeshId(packet.mesh), depth);
+    m_entries.push_back({key, static_cast<uint32_t>(m_packets.size())});
+    m_packets.push_back(packet);
+}
+
+void RenderQueue::sort() {
+    // lsd radix sort, a byte per pass. one sweep builds every histogram, and passes
+    // over bytes that are the same in every key are skipped, like the unused high
+    // bits of the ids.
+    uint32_t histograms[RADIX_PASSES][RADIX_SIZE] = {};
+    for (const SortEntry& entry : m_entries) {
+        for (uint32_t pass = 0; pass < RADIX_PASSES; pass++) {
+            histograms[pass][(entry.key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++;
+        }
+    }
+
+    m_scratch.resize(m_entries.size());
+    for (uint32_t pass = 0; pass < RADIX_PASSES; pass++) {
+        uint32_t* histogram = histograms[pass];
+        uint32_t firstDigit = m_entries.empty() ? 0 : (m_entries[0].key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1);
+        if (histogram[firstDigit] == m_entries.size()) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit < RADIX_SIZE; digit++) {
+            uint32_t count = histogram[digit];
+            histogram[digit] = offset;
+            offset += count;
+        }
+        for (const SortEntry& entry : m_entries) {
+            m_scratch[histogram[(entry.key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++] = entry;
+        }
+        m_entries.swap(m_scratch);
+    }
+}
+
+void RenderQueue::record(const vk::CommandBuffer& cmd, VkShaderStageFlags pushConstantStages) const {
+    VkPipelineLayout pushedLayout = VK_NULL_HANDLE;
+    const MeshRange* pushedMesh = nullptr;
+
+    for (const SortEntry& entry : m_entries) {
+        const DrawPacket& packet = m_packets[entry.packet];
+        cmd.bindPipeline(packet.pipeline);
+        cmd.bindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, packet.pipelineLayout, &packet.descriptorSet);
+        m_geometry.bind(cmd, packet.mesh.indexType);
+
+        bool isSameMesh = pushedMesh != nullptr && pushedMesh->firstIndex == packet.mesh.firstIndex && pushedMesh->indexType == packet.mesh.indexType;
+        if (pushedLayout != packet.pipelineLayout || !isSameMesh) {
+            cmd.pushConstants(packet.pipelineLayout, pushConstantStages, packet.mesh.dequantization);
+            pushedLayout = packet.pipelineLayout;
+            pushedMesh = &packet.mesh;
+        }
+
+        if (packet.indirectBuffer != VK_NULL_HANDLE) {
+            m_geometry.drawIndirect(cmd, packet.indirectBuffer, packet.indirectOffset, packet.indirectDrawCount);
+        } else {
+            m_geometry.draw(cmd, packet.mesh, packet.instanceCount, packet.firstInstance, packet.lod);
+        }
+    }
+}
+
+void RenderQueue::report(const vk::CommandBuffer& cmd) const {
+    const vk::CommandBufferStats& stats = cmd.getStats();
+    std::cout << "render queue: " << getDrawCount() << " packets, " << stats.draws << " draws, "
+              << stats.pipelineBinds << " pipeline, " << stats.descriptorSetBinds << " descriptor set, "
+              << stats.vertexBufferBinds << " vertex buffer and " << stats.indexBufferBinds << " index buffer binds, "
+              << stats.skippedBinds << " redundant binds skipped" << std::endl;
+}
+
+uint32_t RenderQueue::_getMeshId(const MeshRange& mesh) {
+    bool isWide = mesh.indexType == VK_INDEX_TYPE_UINT32;
+    uint32_t id = getId(m_ids->meshes, static_cast<uint64_t>(isWide) << 32 | mesh.firstIndex);
+    return (isWide ? MESH_INDEX_TYPE_BIT : 0) | (id & (MESH_INDEX_TYPE_BIT - 1));
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <memory_resource>
+#include <unordered_map>
+#include "shared.h"
+#include "geometry/geometry_buffer.h"
+#include "wrapper/vk/command_buffer.h"
+
+namespace eng {
+
+// passes record in this order
+enum class DrawPass : uint8_t {
+    Opaque,      // grouped by state, front to back within the same state
+    Transparent  // back to front, state only breaks ties
+};
+
+// everything one draw of a mesh in the geometry buffer needs. the instance buffer
+// is bound by the caller, the packet only picks the range of instances.
+struct DrawPacket {
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;  // set 0
+    MeshRange mesh;
+    uint32_t lod = 0;
+    uint32_t instanceCount = 1;
+    uint32_t firstInstance = 0;
+    // when set the draws are read from there instead, written on the gpu for meshes
+    // in the same index buffer. mesh still picks the index buffer and dequantization.
+    VkBuffer indirectBuffer = VK_NULL_HANDLE;
+    VkDeviceSize indirectOffset = 0;
+    uint32_t indirectDrawCount = 0;
+};
+
+// packs pass, pipeline, material, mesh and depth so that sorting the keys orders the
+// draws, most expensive state change in the highest bits. ids wrap at 12 bits, which
+// only costs grouping. depth is the view distance normalized to [0, 1].
+uint64_t makeSortKey(DrawPass pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+
+// collects the draws of a frame, sorts them by key and records them so that every
+// pipeline, descriptor set and index buffer is bound once per group of draws. binds
+// that would repeat the current state are dropped by vk::CommandBuffer.
+class RenderQueue {
+public:
+    RenderQueue(const GeometryBuffer& geometry);
+
+    // the id tables of the frame live in memory, which must outlast the next clear
+    void clear(std::pmr::memory_resource& memory);
+    void submit(DrawPass pass, const DrawPacket& packet, float depth);
+    void sort();
+
+    // the mesh's dequantization is pushed at offset 0 whenever the mesh changes,
+    // where the DrawConstants block of the shaders expects it
+    void record(const vk::CommandBuffer& cmd, VkShaderStageFlags pushConstantStages) const;
+
+    inline uint32_t getDrawCount() const { return static_cast<uint32_t>(m_packets.size()); }
+
+    // logs the binds of the frame recorded into cmd against the number of draws
+    void report(const vk::CommandBuffer& cmd) const;
+
+private:
+    struct SortEntry {
+        uint64_t key;
+        uint32_t packet;
+    };
+
+    const GeometryBuffer& m_geometry;
+
+    std::vector<DrawPacket> m_packets;
+    std::vector<SortEntry> m_entries;
+    std::vector<SortEntry> m_scratch;
+
+    // small ids for the key fields, handed out in order of first use every frame
+    struct IdTables {
+        explicit IdTables(std::pmr::memory_resource* memory)
+        :pipelines(memory), materials(memory), meshes(memory) {}
+
+        std::pmr::unordered_map<VkPipeline, uint32_t> pipelines;
+        std::pmr::unordered_map<VkDescriptorSet, uint32_t> materials;
+        std::pmr::unordered_map<uint64_t, uint32_t> meshes;
+    };
+
+    // built in place on each frame's memory, assigning would keep the first allocator
+    std::optional<IdTables> m_ids;
+
+private:
+    uint32_t _getMeshId(const MeshRange& mesh);
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "render/skinning_pass.h"
+
+namespace eng {
+
+namespace {
+
+vk::Buffer createBuffer(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
+    VkBufferCreateInfo bufferInfo = vk::bufferCreateInfo();
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    return vk::Buffer(device, physicalDevice, bufferInfo, properties);
+}
+
+glm::vec4 inverseExtent(const glm::vec3& extent) {
+    return glm::vec4(extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+                     extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+                     extent.z > 0.0f ? 1.0f / extent.z : 0.0f, 0.0f);
+}
+
+}  // namespace
+
+SkinningPass::FrameResources::FrameResources(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, uint32_t jointCapacity)
+    : joints(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(jointCapacity) * sizeof(JointMatrix), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+}
+
+SkinningPass::SkinningPass(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, GeometryBuffer& geometry,
+                           uint32_t weightCapacity, uint32_t instanceCapacity, uint32_t jointCapacity, uint32_t frameCount)
+    : m_device(device),
+      m_geometry(geometry),
+      m_weightCapacity(weightCapacity),
+      m_instanceCapacity(instanceCapacity),
+      m_jointCapacity(jointCapacity),
+      m_weights(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(weightCapacity) * sizeof(SkinWeights),
+                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)),
+      m_instanceBuffer(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(instanceCapacity) * sizeof(InstanceData), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)),
+      m_draws(createBuffer(device, physicalDevice, static_cast<VkDeviceSize>(instanceCapacity) * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+    m_instances.reserve(instanceCapacity);
+    m_frames.reserve(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++) {
+        m_frames.emplace_back(device, physicalDevice, jointCapacity);
+    }
+
+    _createComputePipeline(shaders, layoutCache);
+    _createDescriptorSets();
+}
+
+SkinningPass::~SkinningPass() {
+    vkDestroyDescriptorPool(m_device.get(), m_descriptorPool, nullptr);
+    vkDestroyPipeline(m_device.get(), m_pipeline, nullptr);
+}
+
+SkinnedMesh SkinningPass::addMesh(const MeshRange& mesh, std::span<const SkinWeights> weights, uint32_t jointCount) {
+    if (weights.size() != mesh.vertexCount) {
+        throw std::runtime_error("skin weights do not match the mesh!");
+    }
+    if (m_weightCount + mesh.vertexCount > m_weightCapacity) {
+        throw std::runtime_error("too many skinned vertices!");
+    }
+
+    SkinnedMesh skinned{.mesh = mesh, .firstWeight = m_weightCount, .jointCount = jointCount};
+    m_geometry.upload(m_weights, static_cast<VkDeviceSize>(m_weightCount) * sizeof(SkinWeights), weights.data(), weights.size_bytes());
+    m_weightCount += mesh.vertexCount;
+    return skinned;
+}
+
+MeshRange SkinningPass::addInstance(const SkinnedMesh& mesh, const Aabb& poseBounds, uint32_t transform) {
+    if (m_instances.size() == m_instanceCapacity) {
+        throw std::runtime_error("too many skinned instances!");
+    }
+    if (m_jointCount + mesh.jointCount > m_jointCapacity) {
+        throw std::runtime_error("too many skinned joints!");
+    }
+
+    MeshRange copy = m_geometry.addCopy(mesh.mesh);
+    copy.dequantization.positionOffset = glm::vec4(poseBounds.min, 0.0f);
+    copy.dequantization.positionScale = glm::vec4(poseBounds.max - poseBounds.min, 0.0f);
+    // the skinned copy has every vertex of the mesh, its levels of detail would not save any skinning
+    copy.lodCount = 1;
+
+    const InstanceData& instance = m_instances.emplace_back(InstanceData{
+        .sourceOffset = mesh.mesh.dequantization.positionOffset,
+        .sourceScale = mesh.mesh.dequantization.positionScale,
+        .targetOffset = copy.dequantization.positionOffset,
+        .targetInverseScale = inverseExtent(poseBounds.max - poseBounds.min),
+        .sourceVertex = static_cast<uint32_t>(mesh.mesh.vertexOffset),
+        .targetVertex = static_cast<uint32_t>(copy.vertexOffset),
+        .firstWeight = mesh.firstWeight,
+        .vertexCount = mesh.mesh.vertexCount,
+        .firstJoint = m_jointCount});
+    uint32_t index = static_cast<uint32_t>(m_instances.size() - 1);
+    m_instanceBuffer.setData(&instance, sizeof(InstanceData), index * sizeof(InstanceData));
+
+    VkDrawIndexedIndirectCommand draw{
+        .indexCount = copy.indexCount,
+        .instanceCount = 1,
+        .firstIndex = copy.firstIndex,
+        .vertexOffset = copy.vertexOffset,
+        .firstInstance = transform};
+    m_draws.setData(&draw, sizeof(draw), index * sizeof(draw));
+
+    m_jointCount += mesh.jointCount;
+    m_vertexCount += mesh.mesh.vertexCount;
+    m_maxVertexCount = std::max(m_maxVertexCount, mesh.mesh.vertexCount);
+    return copy;
+}
+
+void SkinningPass::beginFrame(uint32_t frameIndex) {
+    m_frameIndex = frameIndex;
+}
+
+void SkinningPass::setJoints(std::span<const JointMatrix> joints) {
+    if (joints.size() != m_jointCount) {
+        throw std::runtime_error("joint count does not match the skinned instances!");
+    }
+    m_frames[m_frameIndex].joints.setData(joints.data(), joints.size_bytes());
+}
+
+void SkinningPass::skin(const vk::CommandBuffer& cmd) {
+    if (m_instances.empty()) {
+        return;
+    }
+
+    // the copies were read as vertices by the frame before
+    VkMemoryBarrier barrier = vk::memoryBarrier();
+    cmd.pipelineBarrier(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, barrier);
+
+    // a row of groups per instance, the groups past its vertices return right away
+    cmd.bindPipeline(m_pipeline, VK_PIPELINE_BIND_POINT_COMPUTE);
+    cmd.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout->layout, &m_frames[m_frameIndex].descriptorSet);
+    cmd.dispatch((m_maxVertexCount + m_GROUP_SIZE - 1) / m_GROUP_SIZE, static_cast<uint32_t>(m_instances.size()), 1);
+
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    cmd.pipelineBarrier(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, barrier);
+
+    m_reportFrames++;
+    m_reportVertices += m_vertexCount;
+}
+
+void SkinningPass::report() {
+    uint32_t frames = std::max(m_reportFrames, 1u);
+    std::cout << "skinning: " << m_instances.size() << " instances, " << m_jointCount << " joints and "
+              << m_reportVertices / frames << " vertices skinned per frame, once for every pass" << std::endl;
+
+    m_reportFrames = 0;
+    m_reportVertices = 0;
+}
+
+void SkinningPass::_createComputePipeline(const ShaderLibrary& shaders, LayoutCache& layoutCache) {
+    Asset code = shaders.load("shaders/bin/skinning_comp.spv");
+    ShaderReflection reflection = reflectShader(code.getSpan());
+    m_pipelineLayout = &layoutCache.get({&reflection, 1});
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = code.getSize();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code.getData());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(m_device.get(), &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create shader module!");
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = shaderModule,
+            .pName = "main"},
+        .layout = m_pipelineLayout->layout};
+
+    VkResult result = vkCreateComputePipelines(m_device.get(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
+    vkDestroyShaderModule(m_device.get(), shaderModule, nullptr);
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create skinning pipeline!");
+    }
+}
+
+void SkinningPass::_createDescriptorSets() {
+    uint32_t frameCount = static_cast<uint32_t>(m_frames.size());
+    std::vector<VkDescriptorPoolSize> poolSizes = m_pipelineLayout->getPoolSizes(0, frameCount);
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    {
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = frameCount;
+    }
+
+    if (vkCreateDescriptorPool(m_device.get(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create skinning descriptor pool!");
+    }
+
+    for (FrameResources& frame : m_frames) {
+        VkDescriptorSetAllocateInfo allocInfo{};
+        {
+            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            allocInfo.descriptorPool = m_descriptorPool;
+            allocInfo.descriptorSetCount = 1;
+            allocInfo.pSetLayouts = &m_pipelineLayout->setLayouts[0];
+        }
+
+        if (vkAllocateDescriptorSets(m_device.get(), &allocInfo, &frame.descriptorSet) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate skinning descriptor set!");
+        }
+
+        std::array<const vk::Buffer*, 4> buffers = {&m_instanceBuffer, &frame.joints, &m_weights, &m_geometry.getVertexBuffer()};
+        std::array<VkDescriptorBufferInfo, 4> bufferInfos;
+        std::array<VkWriteDescriptorSet, 4> writes{};
+        for (uint32_t i = 0; i < buffers.size(); i++) {
+            bufferInfos[i] = {
+                .buffer = buffers[i]->get(),
+                .offset = 0,
+                .range = VK_WHOLE_SIZE};
+
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = frame.descriptorSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorCount = 1;
+            writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[i].pBufferInfo = &bufferInfos[i];
+        }
+        vkUpdateDescriptorSets(m_device.get(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <span>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include "shared.h"
+#include "geometry/bounds.h"
+#include "geometry/geometry_buffer.h"
+#include "scene/skeletal_animation.h"
+#include "shader/layout_cache.h"
+#include "shader/shader_library.h"
+#include "wrapper/vk/buffer.h"
+#include "wrapper/vk/command_buffer.h"
+
+namespace eng {
+
+// the joints moving a vertex, weights sum to 255
+struct SkinWeights {
+    glm::u8vec4 joints;
+    glm::u8vec4 weights;
+};
+
+// a skinned mesh in the geometry buffer, its vertices in bind pose
+struct SkinnedMesh {
+    MeshRange mesh;
+    uint32_t firstWeight = 0;
+    uint32_t jointCount = 0;
+};
+
+// skins every instance of the skinned meshes once per frame in a single compute
+// dispatch. each instance owns a copy of its mesh's vertices in the geometry buffer
+// and the pass writes the posed vertices there, encoded like any other mesh, so
+// every pass that draws the copy reads the same skinned vertices instead of skinning
+// them again. the copies are quantized to bounds given up front for every pose.
+class SkinningPass {
+public:
+    // weightCapacity in vertices of skinned meshes, jointCapacity in joints of all instances
+    SkinningPass(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, GeometryBuffer& geometry,
+                 uint32_t weightCapacity, uint32_t instanceCapacity, uint32_t jointCapacity, uint32_t frameCount);
+    ~SkinningPass();
+
+    SkinningPass(const SkinningPass&) = delete;
+    SkinningPass& operator=(const SkinningPass&) = delete;
+
+    // uploads a weight per vertex of the mesh and waits, meant for load time
+    SkinnedMesh addMesh(const MeshRange& mesh, std::span<const SkinWeights> weights, uint32_t jointCount);
+    // a copy of the mesh skinned every frame, drawn with the returned range and with
+    // transform as its instance. poseBounds holds the mesh in every pose, in model space.
+    // meant for load time, not while a frame in flight skins.
+    MeshRange addInstance(const SkinnedMesh& mesh, const Aabb& poseBounds, uint32_t transform);
+
+    void beginFrame(uint32_t frameIndex);
+    // the skinning matrices of the frame, the joints of every instance in the order they were added
+    void setJoints(std::span<const JointMatrix> joints);
+    // outside of a render pass, before any pass draws the copies
+    void skin(const vk::CommandBuffer& cmd);
+
+    // a VkDrawIndexedIndirectCommand per instance, drawing its copy at lod 0 with its transform
+    inline const vk::Buffer& getDraws() const { return m_draws; }
+    inline uint32_t getInstanceCount() const { return static_cast<uint32_t>(m_instances.size()); }
+    inline uint32_t getVertexCount() const { return m_vertexCount; }
+
+    // logs the averages since the last report
+    void report();
+
+private:
+    static constexpr uint32_t m_GROUP_SIZE = 64;  // local_size_x of skinning.comp
+
+    // the Instance struct of skinning.comp, std430
+    struct InstanceData {
+        glm::vec4 sourceOffset;  // dequantization of the bind pose
+        glm::vec4 sourceScale;
+        glm::vec4 targetOffset;  // quantization of the copy
+        glm::vec4 targetInverseScale;
+        uint32_t sourceVertex;
+        uint32_t targetVertex;
+        uint32_t firstWeight;
+        uint32_t vertexCount;
+        uint32_t firstJoint;
+        uint32_t padding[3];
+    };
+
+    struct FrameResources {
+        FrameResources(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, uint32_t jointCapacity);
+
+        vk::Buffer joints;  // host visible
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    };
+
+    const vk::Device& m_device;
+    GeometryBuffer& m_geometry;
+    uint32_t m_weightCapacity;
+    uint32_t m_instanceCapacity;
+    uint32_t m_jointCapacity;
+
+    vk::Buffer m_weights;
+    vk::Buffer m_instanceBuffer;  // host visible
+    vk::Buffer m_draws;           // host visible
+    std::vector<InstanceData> m_instances;
+    uint32_t m_weightCount = 0;
+    uint32_t m_jointCount = 0;
+    uint32_t m_vertexCount = 0;
+    uint32_t m_maxVertexCount = 0;  // of one instance, the dispatch covers it for all
+
+    const PipelineLayout* m_pipelineLayout = nullptr;
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+    std::vector<FrameResources> m_frames;
+    uint32_t m_frameIndex = 0;
+
+    uint32_t m_reportFrames = 0;
+    uint64_t m_reportVertices = 0;
+
+private:
+    void _createComputePipeline(const ShaderLibrary& shaders, LayoutCache& layoutCache);
+    void _createDescriptorSets();
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace eng {
+
+// asset pack layout: header | blobs, each aligned to ASSET_PACK_ALIGNMENT | entries sorted by name hash | names.
+// kept free of engine includes so the packer tool can share it.
+
+constexpr uint32_t ASSET_PACK_MAGIC = 0x4b415056;  // "VPAK"
+constexpr uint32_t ASSET_PACK_VERSION = 1;
+constexpr uint64_t ASSET_PACK_ALIGNMENT = 64;
+
+struct AssetPackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t entriesOffset;
+    uint64_t namesOffset;
+};
+
+struct AssetPackEntry {
+    uint64_t nameHash;
+    uint32_t nameOffset;  // into the names block
+    uint32_t nameLength;
+    uint64_t offset;      // from the start of the pack
+    uint64_t size;
+};
+
+static_assert(sizeof(AssetPackHeader) == 32, "asset pack header must be tightly packed");
+static_assert(sizeof(AssetPackEntry) == 32, "asset pack entry must be tightly packed");
+
+// fnv-1a over the resource relative path with forward slashes
+inline uint64_t hashAssetName(std::string_view name) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+}  // namespace eng
\ No newline at end of file
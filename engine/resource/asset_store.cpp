@@ -0,0 +1,144 @@
+#include "resource/asset_store.h"
+
+#include <cstring>
+#include <filesystem>
+
+namespace eng {
+
+AssetStore::AssetStore(const std::string& packName) {
+    std::string path = RESOURCE_DIR + packName;
+    if (!std::filesystem::exists(path)) {
+        std::cout << "no asset pack at " << path << ", loading loose files" << std::endl;
+        return;
+    }
+
+    _openPack(path);
+}
+
+Asset AssetStore::load(const std::string& name) const {
+    if (const AssetPackEntry* entry = _findCurrent(name)) {
+        m_packLoads++;
+        m_packBytes += entry->size;
+        return Asset(std::span<const char>(m_pack->getData() + entry->offset, entry->size));
+    }
+
+    // loose file fallback, new and edited files show up without repacking
+    std::vector<char> file = help::readResource(name);
+    m_looseLoads++;
+    m_looseBytes += file.size();
+    return Asset(std::move(file));
+}
+
+bool AssetStore::isPacked(const std::string& name) const {
+    return _findCurrent(name) != nullptr;
+}
+
+AssetStamp AssetStore::getStamp(const std::string& name) const {
+    if (const AssetPackEntry* entry = _findCurrent(name)) {
+        return {
+            .size = entry->size,
+            .writeTime = m_packWriteTime,
+            .offset = entry->offset};
+    }
+
+    std::string absolute = RESOURCE_DIR + name;
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(absolute, error);
+    std::filesystem::file_time_type writeTime;
+    if (!error) {
+        writeTime = std::filesystem::last_write_time(absolute, error);
+    }
+    if (error) {
+        throw std::runtime_error("failed to open file: " + absolute);
+    }
+
+    return {
+        .size = size,
+        .writeTime = static_cast<uint64_t>(writeTime.time_since_epoch().count()),
+        .offset = 0};
+}
+
+AssetStats AssetStore::getStats() const {
+    return {
+        .packLoads = m_packLoads,
+        .looseLoads = m_looseLoads,
+        .packBytes = m_packBytes,
+        .looseBytes = m_looseBytes};
+}
+
+void AssetStore::report() const {
+    AssetStats stats = getStats();
+    std::cout << "assets: " << stats.packLoads << " from pack (" << stats.packBytes / 1024 << " KiB, no copies)"
+              << " | " << stats.looseLoads << " loose files (" << stats.looseBytes / 1024 << " KiB read, "
+              << stats.looseLoads << " allocations)" << std::endl;
+}
+
+void AssetStore::_openPack(const std::string& path) {
+    m_pack = std::make_unique<MappedFile>(path);
+    m_packWriteTime = static_cast<uint64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+
+    AssetPackHeader header;
+    if (m_pack->getSize() < sizeof(header)) {
+        throw std::runtime_error("invalid asset pack: " + path);
+    }
+    memcpy(&header, m_pack->getData(), sizeof(header));
+
+    uint64_t entriesSize = static_cast<uint64_t>(header.entryCount) * sizeof(AssetPackEntry);
+    if (header.magic != ASSET_PACK_MAGIC || header.version != ASSET_PACK_VERSION ||
+        header.entriesOffset % alignof(AssetPackEntry) != 0 || header.entriesOffset + entriesSize > m_pack->getSize() ||
+        header.namesOffset > m_pack->getSize()) {
+        throw std::runtime_error("invalid asset pack: " + path);
+    }
+
+    m_entries = reinterpret_cast<const AssetPackEntry*>(m_pack->getData() + header.entriesOffset);
+    m_entryCount = header.entryCount;
+    m_names = m_pack->getData() + header.namesOffset;
+
+    uint64_t namesSize = m_pack->getSize() - header.namesOffset;
+    for (uint32_t i = 0; i < m_entryCount; i++) {
+        const AssetPackEntry& entry = m_entries[i];
+        if (entry.offset + entry.size > m_pack->getSize() || static_cast<uint64_t>(entry.nameOffset) + entry.nameLength > namesSize) {
+            throw std::runtime_error("invalid asset pack entry in " + path);
+        }
+    }
+
+    std::cout << "asset pack: " << m_entryCount << " assets, " << m_pack->getSize() / 1024 << " KiB mapped" << std::endl;
+}
+
+const AssetPackEntry* AssetStore::_find(std::string_view name) const {
+    if (m_entryCount == 0) {
+        return nullptr;
+    }
+
+    uint64_t hash = hashAssetName(name);
+    const AssetPackEntry* end = m_entries + m_entryCount;
+    const AssetPackEntry* entry = std::lower_bound(m_entries, end, hash, [](const AssetPackEntry& entry, uint64_t hash) {
+        return entry.nameHash < hash;
+    });
+
+    for (; entry != end && entry->nameHash == hash; entry++) {
+        if (std::string_view(m_names + entry->nameOffset, entry->nameLength) == name) {
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+const AssetPackEntry* AssetStore::_findCurrent(const std::string& name) const {
+    const AssetPackEntry* entry = _find(name);
+    if (entry == nullptr) {
+        return nullptr;
+    }
+
+    // the packer copies the files, so a loose file written after the pack was edited since
+    std::error_code error;
+    std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(RESOURCE_DIR + name, error);
+    if (!error && static_cast<uint64_t>(writeTime.time_since_epoch().count()) > m_packWriteTime) {
+        return nullptr;
+    }
+
+    return entry;
+}
+
+}  // namespace eng
\ No newline at end of file
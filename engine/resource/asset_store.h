@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include "shared.h"
+#include "resource/asset_pack_format.h"
+#include "resource/mapped_file.h"
+
+namespace eng {
+
+// bytes of one asset. points straight into the mapped pack, or owns the
+// contents of a loose file that was read instead.
+class Asset {
+public:
+    Asset() = default;
+    explicit Asset(std::span<const char> data) : m_data(data) {}
+    explicit Asset(std::vector<char>&& storage) : m_storage(std::move(storage)), m_data(m_storage) {}
+
+    Asset(Asset&&) = default;
+    Asset& operator=(Asset&&) = default;
+    Asset(const Asset&) = delete;
+    Asset& operator=(const Asset&) = delete;
+
+    inline const char* getData() const { return m_data.data(); }
+    inline size_t getSize() const { return m_data.size(); }
+    inline std::span<const char> getSpan() const { return m_data; }
+    inline bool isMapped() const { return m_storage.empty() && !m_data.empty(); }
+
+private:
+    std::vector<char> m_storage;  // moving the vector keeps its buffer, so the span stays valid
+    std::span<const char> m_data;
+};
+
+// identifies the contents of an asset without reading them, changes whenever they do
+struct AssetStamp {
+    uint64_t size;
+    uint64_t writeTime;  // of the loose file, or of the pack holding the asset
+    uint64_t offset;     // into the pack, zero for a loose file
+};
+
+struct AssetStats {
+    uint32_t packLoads = 0;
+    uint32_t looseLoads = 0;
+    uint64_t packBytes = 0;   // handed out without a copy
+    uint64_t looseBytes = 0;  // read into a fresh allocation
+};
+
+// resolves resource paths against a memory mapped asset pack built by the asset_packer
+// tool, anything not in the pack (or everything, without a pack) is read from the
+// loose files under RESOURCE_DIR, as is a loose file edited after the pack was built.
+// safe to call from several threads.
+class AssetStore {
+public:
+    explicit AssetStore(const std::string& packName = "assets.pak");
+
+    Asset load(const std::string& name) const;
+    bool isPacked(const std::string& name) const;
+    // of what load would return, a pack lookup or a stat of the loose file
+    AssetStamp getStamp(const std::string& name) const;
+
+    AssetStats getStats() const;
+    void report() const;
+
+private:
+    std::unique_ptr<MappedFile> m_pack;
+    uint64_t m_packWriteTime = 0;
+    const AssetPackEntry* m_entries = nullptr;
+    uint32_t m_entryCount = 0;
+    const char* m_names = nullptr;
+
+    mutable std::atomic<uint32_t> m_packLoads = 0;
+    mutable std::atomic<uint32_t> m_looseLoads = 0;
+    mutable std::atomic<uint64_t> m_packBytes = 0;
+    mutable std::atomic<uint64_t> m_looseBytes = 0;
+
+private:
+    void _openPack(const std::string& path);
+    const AssetPackEntry* _find(std::string_view name) const;
+    // the entry, unless the loose file is newer than the pack
+    const AssetPackEntry* _findCurrent(const std::string& name) const;
+};
+
+}  // namespace eng
\ No newline at end of file
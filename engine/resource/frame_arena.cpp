@@ -0,0 +1,76 @@
+#include "resource/frame_arena.h"
+
+namespace eng {
+
+FrameArena::FrameArena(size_t blockSize) {
+    _addBlock(blockSize);
+}
+
+void FrameArena::reset() {
+    // merge the chain into one block large enough for the frame that needed it
+    if (m_blocks.size() > 1) {
+        size_t capacity = m_capacity;
+        m_blocks.clear();
+        m_capacity = 0;
+        _addBlock(capacity);
+    }
+
+    m_head = 0;
+    m_used = 0;
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    Block* block = &m_blocks.back();
+    size_t offset = (reinterpret_cast<uintptr_t>(block->data.get()) + m_head + alignment - 1) / alignment * alignment -
+                    reinterpret_cast<uintptr_t>(block->data.get());
+
+    if (offset + bytes > block->size) {
+        _addBlock(std::max(block->size * 2, bytes + alignment));
+        block = &m_blocks.back();
+        offset = (reinterpret_cast<uintptr_t>(block->data.get()) + alignment - 1) / alignment * alignment -
+                 reinterpret_cast<uintptr_t>(block->data.get());
+    }
+
+    m_head = offset + bytes;
+    m_used += bytes;
+    m_peak = std::max(m_peak, m_used);
+    return block->data.get() + offset;
+}
+
+void FrameArena::_addBlock(size_t size) {
+    m_blocks.push_back({std::make_unique<std::byte[]>(size), size});
+    m_capacity += size;
+    m_head = 0;
+}
+
+FrameAllocator::FrameAllocator(uint32_t frameCount, uint32_t threadCount, size_t blockSize)
+:m_threadCount(threadCount) {
+    for (uint32_t i = 0; i < frameCount * threadCount; i++) {
+        m_arenas.push_back(std::make_unique<FrameArena>(blockSize));
+    }
+}
+
+void FrameAllocator::beginFrame(uint32_t frameIndex) {
+    m_frameIndex = frameIndex;
+    for (uint32_t thread = 0; thread < m_threadCount; thread++) {
+        getArena(thread).reset();
+    }
+}
+
+size_t FrameAllocator::getUsed() const {
+    size_t used = 0;
+    for (uint32_t thread = 0; thread < m_threadCount; thread++) {
+        used += m_arenas[m_frameIndex * m_threadCount + thread]->getUsed();
+    }
+    return used;
+}
+
+size_t FrameAllocator::getCapacity() const {
+    size_t capacity = 0;
+    for (const auto& arena : m_arenas) {
+        capacity += arena->getCapacity();
+    }
+    return capacity;
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include "shared.h"
+
+namespace eng {
+
+// bump allocator for data that lives no longer than a frame, usable by any pmr
+// container. deallocation does nothing, reset() frees everything at once. a frame
+// that outgrows the arena chains more blocks, which are merged into one on the next
+// reset, so after the first frames it stops touching the heap.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(size_t blockSize = 1 << 16);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // nothing allocated since the last reset may be used anymore
+    void reset();
+
+    inline size_t getUsed() const { return m_used; }
+    inline size_t getCapacity() const { return m_capacity; }
+    inline size_t getPeak() const { return m_peak; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_head = 0;  // in the last block
+    size_t m_used = 0;
+    size_t m_capacity = 0;
+    size_t m_peak = 0;
+
+private:
+    void _addBlock(size_t size);
+};
+
+// an arena per frame in flight and thread. a frame's arenas are reset when the frame
+// slot comes around again, after its fence was waited on, so whatever the previous
+// use of the slot handed to the gpu or kept until presentation is gone by then.
+class FrameAllocator {
+public:
+    FrameAllocator(uint32_t frameCount, uint32_t threadCount = 1, size_t blockSize = 1 << 16);
+
+    // resets the slot's arenas and makes them the current ones
+    void beginFrame(uint32_t frameIndex);
+
+    // thread is a worker index in [0, threadCount), 0 for the main thread
+    inline FrameArena& getArena(uint32_t thread = 0) { return *m_arenas[m_frameIndex * m_threadCount + thread]; }
+
+    size_t getUsed() const;     // by the current frame
+    size_t getCapacity() const;  // of every arena
+
+private:
+    uint32_t m_threadCount;
+    uint32_t m_frameIndex = 0;
+    std::vector<std::unique_ptr<FrameArena>> m_arenas;  // by frame, then thread
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "resource/heap_tracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace eng {
+
+namespace {
+
+std::atomic<uint64_t> allocationCount{0};
+
+void* allocate(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+}  // namespace
+
+uint64_t getHeapAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+}  // namespace eng
+
+// replaces the global allocation functions of the whole program. the nothrow forms
+// call these, over-aligned allocations keep the default ones and aren't counted.
+void* operator new(size_t size) {
+    return eng::allocate(size);
+}
+
+void* operator new[](size_t size) {
+    return eng::allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "shared.h"
+
+namespace eng {
+
+// calls to the global operator new since the start, from any thread. the difference
+// across a frame is how often the frame went to the heap.
+uint64_t getHeapAllocationCount();
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "resource/mapped_file.h"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace eng {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_file = nullptr;
+        throw std::runtime_error("failed to open file: " + path);
+    }
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_file, &size);
+    m_size = static_cast<size_t>(size.QuadPart);
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr) {
+        CloseHandle(m_file);
+        throw std::runtime_error("failed to map file: " + path);
+    }
+
+    m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        throw std::runtime_error("failed to map file: " + path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw std::runtime_error("failed to open file: " + path);
+    }
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0) {
+        close(file);
+        throw std::runtime_error("failed to map file: " + path);
+    }
+    m_size = static_cast<size_t>(status.st_size);
+
+    // the mapping stays valid after the descriptor is closed
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("failed to map file: " + path);
+    }
+
+    m_data = static_cast<const char*>(data);
+}
+
+MappedFile::~MappedFile() {
+    munmap(const_cast<char*>(m_data), m_size);
+}
+
+#endif
+
+}  // namespace eng
\ No newline at end of file
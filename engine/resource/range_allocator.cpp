@@ -0,0 +1,76 @@
+#include "resource/range_allocator.h"
+
+namespace eng {
+
+RangeAllocator::RangeAllocator(uint64_t capacity)
+    : m_capacity(capacity) {
+    if (capacity > 0) {
+        m_freeRanges.emplace(0, capacity);
+    }
+}
+
+std::optional<uint64_t> RangeAllocator::allocate(uint64_t size, uint64_t alignment) {
+    if (size == 0) {
+        return std::nullopt;
+    }
+
+    for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); it++) {
+        auto [rangeOffset, rangeSize] = *it;
+        uint64_t offset = (rangeOffset + alignment - 1) / alignment * alignment;
+        uint64_t padding = offset - rangeOffset;
+        if (padding + size > rangeSize) {
+            continue;
+        }
+
+        // the alignment padding stays free in front, the remainder behind
+        m_freeRanges.erase(it);
+        if (padding > 0) {
+            m_freeRanges.emplace(rangeOffset, padding);
+        }
+        if (padding + size < rangeSize) {
+            m_freeRanges.emplace(offset + size, rangeSize - padding - size);
+        }
+
+        m_used += size;
+        return offset;
+    }
+
+    return std::nullopt;
+}
+
+void RangeAllocator::free(uint64_t offset, uint64_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    auto [it, inserted] = m_freeRanges.emplace(offset, size);
+    if (!inserted) {
+        throw std::runtime_error("range freed twice!");
+    }
+    m_used -= size;
+
+    auto next = std::next(it);
+    if (next != m_freeRanges.end() && it->first + it->second == next->first) {
+        it->second += next->second;
+        m_freeRanges.erase(next);
+    }
+
+    if (it != m_freeRanges.begin()) {
+        auto previous = std::prev(it);
+        if (previous->first + previous->second == it->first) {
+            previous->second += it->second;
+            m_freeRanges.erase(it);
+        }
+    }
+}
+
+uint64_t RangeAllocator::getLargestFree() const {
+    uint64_t largest = 0;
+    for (const auto& [offset, size] : m_freeRanges) {
+        largest = std::max(largest, size);
+    }
+
+    return largest;
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <map>
+#include "shared.h"
+
+namespace eng {
+
+// first fit sub-allocator over [0, capacity), in whatever unit the caller uses.
+// freed ranges are merged with their neighbours so the space doesn't fragment into
+// slivers when meshes of similar size come and go.
+class RangeAllocator {
+public:
+    explicit RangeAllocator(uint64_t capacity);
+
+    std::optional<uint64_t> allocate(uint64_t size, uint64_t alignment = 1);
+    void free(uint64_t offset, uint64_t size);
+
+    inline uint64_t getCapacity() const { return m_capacity; }
+    inline uint64_t getUsed() const { return m_used; }
+    uint64_t getLargestFree() const;
+
+private:
+    uint64_t m_capacity;
+    uint64_t m_used = 0;
+    std::map<uint64_t, uint64_t> m_freeRanges;  // offset to size
+};
+
+}  // namespace eng
\ No newline at end of file
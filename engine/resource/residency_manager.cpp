@@ -0,0 +1,71 @@
+#include "resource/residency_manager.h"
+
+namespace eng {
+
+ResidencyManager::ResidencyManager(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, float budgetScale)
+    : m_device(device),
+      m_physicalDevice(physicalDevice),
+      m_budgetScale(budgetScale),
+      m_hasMemoryBudget(physicalDevice.isExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+    const VkPhysicalDeviceMemoryProperties& memoryProperties = m_physicalDevice.getMemoryProperties();
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+            m_deviceLocalHeap = memoryProperties.memoryTypes[i].heapIndex;
+            break;
+        }
+    }
+
+    _queryBudgets();
+
+    std::cout << "device local heap: " << m_heaps[m_deviceLocalHeap].budget / (1024 * 1024) << " MiB budget"
+              << (m_hasMemoryBudget ? " (VK_EXT_memory_budget)" : " (heap size)") << std::endl;
+}
+
+void ResidencyManager::update() {
+    _queryBudgets();
+    m_frame++;
+}
+
+void ResidencyManager::_queryBudgets() {
+    const VkPhysicalDeviceMemoryProperties& memoryProperties = m_physicalDevice.getMemoryProperties();
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT};
+    if (m_hasMemoryBudget) {
+        VkPhysicalDeviceMemoryProperties2 properties{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+            .pNext = &budgetProperties};
+        vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice.get(), &properties);
+    }
+
+    for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+        m_trackedUsage[i] = m_device.getHeapUsage(i);
+
+        if (m_hasMemoryBudget) {
+            m_heaps[i].budget = static_cast<VkDeviceSize>(budgetProperties.heapBudget[i] * m_budgetScale);
+            m_heaps[i].usage = budgetProperties.heapUsage[i];
+        } else {
+            m_heaps[i].budget = static_cast<VkDeviceSize>(memoryProperties.memoryHeaps[i].size * m_budgetScale);
+            m_heaps[i].usage = m_trackedUsage[i];
+        }
+        m_heaps[i].budget = std::min(m_heaps[i].budget, m_budgetLimit);
+    }
+}
+
+VkDeviceSize ResidencyManager::getUsage(uint32_t heapIndex) const {
+    VkDeviceSize tracked = m_device.getHeapUsage(heapIndex);
+    VkDeviceSize usage = m_heaps[heapIndex].usage + tracked;
+    return usage > m_trackedUsage[heapIndex] ? usage - m_trackedUsage[heapIndex] : 0;
+}
+
+VkDeviceSize ResidencyManager::getAvailable(uint32_t heapIndex) const {
+    VkDeviceSize usage = getUsage(heapIndex);
+    return usage < m_heaps[heapIndex].budget ? m_heaps[heapIndex].budget - usage : 0;
+}
+
+VkDeviceSize ResidencyManager::getOverBudget(uint32_t heapIndex) const {
+    VkDeviceSize usage = getUsage(heapIndex);
+    return usage > m_heaps[heapIndex].budget ? usage - m_heaps[heapIndex].budget : 0;
+}
+
+}  // namespace eng
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "shared.h"
+#include "wrapper/vk/device.h"
+#include "wrapper/vk/physical_device.h"
+
+namespace eng {
+
+struct HeapBudget {
+    VkDeviceSize budget = 0;  // what the process should stay below
+    VkDeviceSize usage = 0;   // as of the last update
+};
+
+// tracks how much device memory each heap can still take. with VK_EXT_memory_budget
+// the driver reports budget and usage, otherwise the budget is a fraction of the heap
+// size and the usage is what was allocated through vk::Device.
+class ResidencyManager {
+public:
+    ResidencyManager(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, float budgetScale = 0.8f);
+
+    // refreshes the budgets and advances the frame counter, call once per frame
+    void update();
+
+    inline uint64_t getFrame() const { return m_frame; }
+    inline bool hasMemoryBudget() const { return m_hasMemoryBudget; }
+    inline uint32_t getDeviceLocalHeap() const { return m_deviceLocalHeap; }
+    inline const HeapBudget& getHeapBudget(uint32_t heapIndex) const { return m_heaps[heapIndex]; }
+
+    // usage including what was allocated since the last update
+    VkDeviceSize getUsage(uint32_t heapIndex) const;
+    VkDeviceSize getAvailable(uint32_t heapIndex) const;
+    VkDeviceSize getOverBudget(uint32_t heapIndex) const;
+
+    // caps every heap budget, to exercise eviction on machines with plenty of memory
+    inline void setBudgetLimit(VkDeviceSize limit) { m_budgetLimit = limit; }
+
+private:
+    const vk::Device& m_device;
+    const vk::PhysicalDevice& m_physicalDevice;
+
+    float m_budgetScale;
+    bool m_hasMemoryBudget;
+    uint32_t m_deviceLocalHeap = 0;
+    VkDeviceSize m_budgetLimit = std::numeric_limits<VkDeviceSize>::max();
+    uint64_t m_frame = 0;
+
+    std::array<HeapBudget, VK_MAX_MEMORY_HEAPS> m_heaps{};
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> m_trackedUsage{};  // device counters at the last update
+
+private:
+    void _queryBudgets();
+};
+
+}  // namespace eng
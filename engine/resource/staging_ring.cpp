@@ -0,0 +1,60 @@
+#include "resource/staging_ring.h"
+
+namespace eng {
+
+namespace {
+
+VkBufferCreateInfo _stagingBufferInfo(VkDeviceSize size) {
+    VkBufferCreateInfo bufferInfo = vk::bufferCreateInfo();
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    return bufferInfo;
+}
+
+}  // namespace
+
+StagingRing::StagingRing(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, VkDeviceSize size, uint32_t frameCount)
+    : m_buffer(device, physicalDevice, _stagingBufferInfo(size), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT),
+      m_size(size),
+      m_frameBytes(frameCount, 0) {
+}
+
+std::optional<VkDeviceSize> StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    if (size > m_size) {
+        return std::nullopt;
+    }
+
+    VkDeviceSize offset = (m_head + alignment - 1) / alignment * alignment;
+    if (offset + size > m_size) {
+        // not enough room before the end, skip the tail and wrap around
+        offset = 0;
+    }
+
+    // bytes consumed including alignment padding or the skipped tail
+    VkDeviceSize consumed = (offset >= m_head ? offset - m_head : m_size - m_head) + size;
+    if (m_used + consumed > m_size) {
+        return std::nullopt;
+    }
+
+    m_head = (offset + size) % m_size;
+    m_used += consumed;
+    m_pending += consumed;
+
+    return offset;
+}
+
+void StagingRing::write(VkDeviceSize offset, const void* data, VkDeviceSize size) {
+    m_buffer.setData(data, size, offset);
+}
+
+void StagingRing::retireFrame(uint32_t frameIndex) {
+    m_used -= m_frameBytes[frameIndex];
+    m_frameBytes[frameIndex] = 0;
+}
+
+void StagingRing::endFrame(uint32_t frameIndex) {
+    m_frameBytes[frameIndex] += m_pending;
+    m_pending = 0;
+}
+
+}  // namespace eng
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "shared.h"
+#include "wrapper/vk/buffer.h"
+#include "wrapper/vk/device.h"
+#include "wrapper/vk/physical_device.h"
+
+namespace eng {
+
+// persistently mapped host visible buffer shared by all uploads.
+// allocations are owned by the frame they were recorded in and reclaimed once
+// that frame's fence has been waited on, so the ring never stalls the gpu.
+class StagingRing {
+public:
+    StagingRing(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, VkDeviceSize size, uint32_t frameCount);
+
+    inline const vk::Buffer& getBuffer() const { return m_buffer; }
+    inline VkDeviceSize getSize() const { return m_size; }
+    inline VkDeviceSize getUsed() const { return m_used; }
+
+    // returns the offset of the allocation, or nothing if the ring is full until older frames retire
+    std::optional<VkDeviceSize> allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+    void write(VkDeviceSize offset, const void* data, VkDeviceSize size);
+
+    // call after the frame's fence was waited on, before recording new uploads
+    void retireFrame(uint32_t frameIndex);
+    // hands every allocation since the last call over to the frame
+    void endFrame(uint32_t frameIndex);
+
+private:
+    vk::Buffer m_buffer;
+
+    VkDeviceSize m_size;
+    VkDeviceSize m_head = 0;
+    VkDeviceSize m_used = 0;
+    VkDeviceSize m_pending = 0;
+    std::vector<VkDeviceSize> m_frameBytes;
+};
+
+}  // namespace eng
@@ -0,0 +1,247 @@
+#include "scene/bvh.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <xmmintrin.h>
+    #define ENGINE_BVH_SSE 1
+#endif
+
+namespace eng {
+
+void Bvh::build(std::span<const Aabb> bounds) {
+    m_bounds.assign(bounds.begin(), bounds.end());
+    m_objects.resize(bounds.size());
+    m_objectNodes.assign(bounds.size(), NO_NODE);
+    m_nodes.clear();
+    m_moved.clear();
+
+    std::vector<glm::vec3> centers(bounds.size());
+    for (uint32_t i = 0; i < bounds.size(); i++) {
+        m_objects[i] = i;
+        centers[i] = bounds[i].getCenter();
+    }
+
+    if (!bounds.empty()) {
+        // every node has at least two children, so n objects need fewer than n nodes
+        m_nodes.reserve(bounds.size());
+        _build(NO_NODE, 0, static_cast<uint32_t>(bounds.size()), centers);
+    }
+
+    m_nodeDirty.assign(m_nodes.size(), 0);
+    m_area = 0.0;
+    for (const Node& node : m_nodes) {
+        m_area += _getNodeBounds(node).getSurfaceArea();
+    }
+    m_builtArea = m_area;
+}
+
+void Bvh::update(uint32_t object, const Aabb& bounds) {
+    m_bounds[object] = bounds;
+    m_moved.push_back(object);
+}
+
+uint32_t Bvh::refit() {
+    // collect the leaves of moved objects and everything above them, once each
+    std::vector<uint32_t>& dirty = m_dirty;
+    dirty.clear();
+    for (uint32_t object : m_moved) {
+        for (uint32_t node = m_objectNodes[object]; node != NO_NODE && !m_nodeDirty[node]; node = m_nodes[node].parent) {
+            m_nodeDirty[node] = 1;
+            dirty.push_back(node);
+        }
+    }
+    m_moved.clear();
+
+    // children have higher indices than their parents, so refit from the back
+    std::sort(dirty.begin(), dirty.end(), std::greater<uint32_t>());
+    for (uint32_t node : dirty) {
+        m_area -= _getNodeBounds(m_nodes[node]).getSurfaceArea();
+        _refitNode(m_nodes[node]);
+        m_area += _getNodeBounds(m_nodes[node]).getSurfaceArea();
+        m_nodeDirty[node] = 0;
+    }
+
+    return static_cast<uint32_t>(dirty.size());
+}
+
+void Bvh::cull(const Frustum& frustum, std::vector<uint32_t>& visible, BvhCullStats* stats) const {
+    if (m_nodes.empty()) {
+        return;
+    }
+
+    uint32_t stack[64];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        if (stats != nullptr) {
+            stats->nodesVisited++;
+            stats->boxesTested += node.childCount;
+        }
+
+        // bit i of outside: child i is behind a plane, bit i of partial: it crosses one
+        uint32_t outside = 0;
+        uint32_t partial = 0;
+
+#ifdef ENGINE_BVH_SSE
+        __m128 outsideMask = _mm_setzero_ps();
+        __m128 partialMask = _mm_setzero_ps();
+        const __m128 zero = _mm_setzero_ps();
+        for (const glm::vec4& plane : frustum.planes) {
+            // the normal's signs pick the nearest and furthest corner for all four boxes
+            const float* farX = plane.x >= 0.0f ? node.maxX : node.minX;
+            const float* farY = plane.y >= 0.0f ? node.maxY : node.minY;
+            const float* farZ = plane.z >= 0.0f ? node.maxZ : node.minZ;
+            const float* nearX = plane.x >= 0.0f ? node.minX : node.maxX;
+            const float* nearY = plane.y >= 0.0f ? node.minY : node.maxY;
+            const float* nearZ = plane.z >= 0.0f ? node.minZ : node.maxZ;
+
+            __m128 nx = _mm_set1_ps(plane.x), ny = _mm_set1_ps(plane.y), nz = _mm_set1_ps(plane.z), d = _mm_set1_ps(plane.w);
+            __m128 farDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_load_ps(farX)), _mm_mul_ps(ny, _mm_load_ps(farY))),
+                                            _mm_add_ps(_mm_mul_ps(nz, _mm_load_ps(farZ)), d));
+            __m128 nearDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, _mm_load_ps(nearX)), _mm_mul_ps(ny, _mm_load_ps(nearY))),
+                                             _mm_add_ps(_mm_mul_ps(nz, _mm_load_ps(nearZ)), d));
+            outsideMask = _mm_or_ps(outsideMask, _mm_cmplt_ps(farDistance, zero));
+            partialMask = _mm_or_ps(partialMask, _mm_cmplt_ps(nearDistance, zero));
+        }
+        outside = static_cast<uint32_t>(_mm_movemask_ps(outsideMask));
+        partial = static_cast<uint32_t>(_mm_movemask_ps(partialMask));
+#else
+        for (uint32_t i = 0; i < node.childCount; i++) {
+            for (const glm::vec4& plane : frustum.planes) {
+                float farDistance = plane.x * (plane.x >= 0.0f ? node.maxX[i] : node.minX[i]) +
+                                    plane.y * (plane.y >= 0.0f ? node.maxY[i] : node.minY[i]) +
+                                    plane.z * (plane.z >= 0.0f ? node.maxZ[i] : node.minZ[i]) + plane.w;
+                float nearDistance = plane.x * (plane.x >= 0.0f ? node.minX[i] : node.maxX[i]) +
+                                     plane.y * (plane.y >= 0.0f ? node.minY[i] : node.maxY[i]) +
+                                     plane.z * (plane.z >= 0.0f ? node.minZ[i] : node.maxZ[i]) + plane.w;
+                outside |= (farDistance < 0.0f ? 1u : 0u) << i;
+                partial |= (nearDistance < 0.0f ? 1u : 0u) << i;
+            }
+        }
+#endif
+
+        for (uint32_t i = 0; i < node.childCount; i++) {
+            if (outside & (1u << i)) {
+                continue;
+            }
+
+            uint32_t child = node.children[i];
+            if ((child & LEAF_BIT) || !(partial & (1u << i))) {
+                _appendSubtree(node, i, visible);
+            } else {
+                if (stackSize == std::size(stack)) {
+                    throw std::runtime_error("bvh is too deep to cull!");
+                }
+                stack[stackSize++] = child;
+            }
+        }
+    }
+}
+
+float Bvh::getDegradation() const {
+    if (m_builtArea <= 0.0) {
+        return 1.0f;
+    }
+
+    return static_cast<float>(m_area / m_builtArea);
+}
+
+uint32_t Bvh::_build(uint32_t parent, uint32_t first, uint32_t count, std::vector<glm::vec3>& centers) {
+    uint32_t index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back(Node{.parent = parent, .firstObject = first, .objectCount = count});
+
+    // split at the median of the widest centroid axis, then split both halves again
+    auto split = [&](uint32_t begin, uint32_t size) -> uint32_t {
+        Aabb centroidBounds;
+        for (uint32_t i = begin; i < begin + size; i++) {
+            centroidBounds.merge({centers[m_objects[i]], centers[m_objects[i]]});
+        }
+        glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+        uint32_t middle = begin + size / 2;
+        std::nth_element(m_objects.begin() + begin, m_objects.begin() + middle, m_objects.begin() + begin + size, [&](uint32_t a, uint32_t b) {
+            return centers[a][axis] < centers[b][axis];
+        });
+        return middle;
+    };
+
+    std::array<std::pair<uint32_t, uint32_t>, WIDTH> groups;  // first, count
+    uint32_t groupCount = 0;
+    if (count <= WIDTH) {
+        for (uint32_t i = 0; i < count; i++) {
+            groups[groupCount++] = {first + i, 1};
+        }
+    } else {
+        uint32_t middle = split(first, count);
+        uint32_t lowerMiddle = split(first, middle - first);
+        uint32_t upperMiddle = split(middle, first + count - middle);
+        groups = {{{first, lowerMiddle - first}, {lowerMiddle, middle - lowerMiddle}, {middle, upperMiddle - middle}, {upperMiddle, first + count - upperMiddle}}};
+        groupCount = WIDTH;
+    }
+
+    for (uint32_t slot = 0; slot < WIDTH; slot++) {
+        _setSlot(m_nodes[index], slot, Aabb{});
+    }
+
+    for (uint32_t slot = 0; slot < groupCount; slot++) {
+        auto [groupFirst, groupSize] = groups[slot];
+        if (groupSize == 1) {
+            uint32_t object = m_objects[groupFirst];
+            m_objectNodes[object] = index;
+            m_nodes[index].children[slot] = LEAF_BIT | groupFirst;
+            _setSlot(m_nodes[index], slot, m_bounds[object]);
+        } else {
+            // recursion may reallocate the nodes, index again afterwards
+            uint32_t child = _build(index, groupFirst, groupSize, centers);
+            m_nodes[index].children[slot] = child;
+            _setSlot(m_nodes[index], slot, _getNodeBounds(m_nodes[child]));
+        }
+    }
+    m_nodes[index].childCount = groupCount;
+
+    return index;
+}
+
+void Bvh::_setSlot(Node& node, uint32_t slot, const Aabb& bounds) const {
+    // empty slots keep inverted bounds, every plane rejects them
+    node.minX[slot] = bounds.min.x;
+    node.minY[slot] = bounds.min.y;
+    node.minZ[slot] = bounds.min.z;
+    node.maxX[slot] = bounds.max.x;
+    node.maxY[slot] = bounds.max.y;
+    node.maxZ[slot] = bounds.max.z;
+}
+
+Aabb Bvh::_getNodeBounds(const Node& node) const {
+    Aabb bounds;
+    for (uint32_t slot = 0; slot < node.childCount; slot++) {
+        bounds.merge({glm::vec3(node.minX[slot], node.minY[slot], node.minZ[slot]), glm::vec3(node.maxX[slot], node.maxY[slot], node.maxZ[slot])});
+    }
+    return bounds;
+}
+
+void Bvh::_refitNode(Node& node) {
+    for (uint32_t slot = 0; slot < node.childCount; slot++) {
+        uint32_t child = node.children[slot];
+        if (child & LEAF_BIT) {
+            _setSlot(node, slot, m_bounds[m_objects[child & ~LEAF_BIT]]);
+        } else {
+            _setSlot(node, slot, _getNodeBounds(m_nodes[child]));
+        }
+    }
+}
+
+void Bvh::_appendSubtree(const Node& node, uint32_t slot, std::vector<uint32_t>& visible) const {
+    uint32_t child = node.children[slot];
+    if (child & LEAF_BIT) {
+        visible.push_back(m_objects[child & ~LEAF_BIT]);
+        return;
+    }
+
+    const Node& subtree = m_nodes[child];
+    visible.insert(visible.end(), m_objects.begin() + subtree.firstObject, m_objects.begin() + subtree.firstObject + subtree.objectCount);
+}
+
+}  // namespace eng
\ No newline at end of file
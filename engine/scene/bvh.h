@@ -0,0 +1,71 @@
+#pragma once
+
+#include <span>
+#include "shared.h"
+#include "geometry/bounds.h"
+
+namespace eng {
+
+struct BvhCullStats {
+    uint32_t nodesVisited = 0;
+    uint32_t boxesTested = 0;
+};
+
+// four wide bounding volume hierarchy over object boxes. a node keeps the bounds of
+// its four children side by side, so one sse instruction tests all four against a
+// frustum plane. nodes are stored parents first and every subtree covers a contiguous
+// run of objects, so a subtree fully inside the frustum is accepted without descending.
+class Bvh {
+public:
+    static constexpr uint32_t WIDTH = 4;
+
+    // rebuilds from scratch, objects are identified by their index in bounds
+    void build(std::span<const Aabb> bounds);
+
+    // moves an object, the tree sees it on the next refit
+    void update(uint32_t object, const Aabb& bounds);
+    // grows the nodes above moved objects, returns how many nodes were touched
+    uint32_t refit();
+
+    // appends the objects whose bounds touch the frustum, in no particular order
+    void cull(const Frustum& frustum, std::vector<uint32_t>& visible, BvhCullStats* stats = nullptr) const;
+
+    inline uint32_t getObjectCount() const { return static_cast<uint32_t>(m_bounds.size()); }
+    inline uint32_t getNodeCount() const { return static_cast<uint32_t>(m_nodes.size()); }
+
+    // how much the summed node area, the traversal cost, has grown through refits since the last build
+    float getDegradation() const;
+
+private:
+    struct alignas(16) Node {
+        float minX[WIDTH], minY[WIDTH], minZ[WIDTH];
+        float maxX[WIDTH], maxY[WIDTH], maxZ[WIDTH];
+        uint32_t children[WIDTH];  // node index, or LEAF_BIT | slot in m_objects
+        uint32_t parent;
+        uint32_t firstObject;  // the subtree covers m_objects[firstObject, firstObject + objectCount)
+        uint32_t objectCount;
+        uint32_t childCount;
+    };
+
+    static constexpr uint32_t LEAF_BIT = 1u << 31;
+    static constexpr uint32_t NO_NODE = ~0u;
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_objects;     // object ids in tree order
+    std::vector<Aabb> m_bounds;          // by object id
+    std::vector<uint32_t> m_objectNodes;  // leaf node of each object
+    std::vector<uint32_t> m_moved;
+    std::vector<uint32_t> m_dirty;  // refit scratch, kept to reuse its memory
+    std::vector<uint8_t> m_nodeDirty;
+    double m_area = 0.0;  // surface area of all nodes
+    double m_builtArea = 0.0;
+
+private:
+    uint32_t _build(uint32_t parent, uint32_t first, uint32_t count, std::vector<glm::vec3>& centers);
+    void _setSlot(Node& node, uint32_t slot, const Aabb& bounds) const;
+    Aabb _getNodeBounds(const Node& node) const;
+    void _refitNode(Node& node);
+    void _appendSubtree(const Node& node, uint32_t slot, std::vector<uint32_t>& visible) const;
+};
+
+}  // namespace eng
\ No newline at end of file
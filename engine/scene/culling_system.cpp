@@ -0,0 +1,97 @@
+#include "scene/culling_system.h"
+
+namespace eng {
+
+uint32_t CullingSystem::add(const TransformSystem& transforms, TransformHandle transform, const Aabb& localBounds) {
+    uint32_t object = static_cast<uint32_t>(m_transforms.size());
+    m_transforms.push_back(transform);
+    m_localBounds.push_back(localBounds);
+    m_worldBounds.push_back(transformAabb(localBounds, transforms.getWorldMatrix(transform)));
+
+    if (transform >= m_objects.size()) {
+        m_objects.resize(transform + 1, m_NO_OBJECT);
+    }
+    m_objects[transform] = object;
+    m_isBvhStale = true;
+
+    return object;
+}
+
+void CullingSystem::update(const TransformSystem& transforms, std::span<const uint32_t> updated) {
+    auto start = std::chrono::high_resolution_clock::now();
+    m_stats = CullingStats{};
+
+    for (uint32_t transform : updated) {
+        uint32_t object = transform < m_objects.size() ? m_objects[transform] : m_NO_OBJECT;
+        if (object == m_NO_OBJECT) {
+            continue;
+        }
+
+        m_worldBounds[object] = transformAabb(m_localBounds[object], transforms.getWorldMatrix(transform));
+        if (!m_isBvhStale) {
+            m_bvh.update(object, m_worldBounds[object]);
+        }
+    }
+
+    if (!m_isBvhStale) {
+        m_stats.refittedNodes = m_bvh.refit();
+        m_isBvhStale = m_bvh.getDegradation() > m_MAX_DEGRADATION;
+    }
+    if (m_isBvhStale) {
+        m_bvh.build(m_worldBounds);
+        m_isBvhStale = false;
+        m_stats.isRebuilt = true;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_stats.milliseconds += std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+std::span<const TransformHandle> CullingSystem::cull(const glm::mat4& viewProjection) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    BvhCullStats bvhStats;
+    m_visibleObjects.clear();
+    m_bvh.cull(Frustum::fromMatrix(viewProjection), m_visibleObjects, &bvhStats);
+
+    m_visible.clear();
+    for (uint32_t object : m_visibleObjects) {
+        m_visible.push_back(m_transforms[object]);
+    }
+    std::sort(m_visible.begin(), m_visible.end());
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_stats.total = getObjectCount();
+    m_stats.visible = static_cast<uint32_t>(m_visible.size());
+    m_stats.nodesVisited = bvhStats.nodesVisited;
+    m_stats.milliseconds += std::chrono::duration<float, std::milli>(end - start).count();
+
+    m_reportFrames++;
+    m_reportVisible += m_stats.visible;
+    m_reportTotal += m_stats.total;
+    m_reportRebuilds += m_stats.isRebuilt ? 1 : 0;
+    m_reportMilliseconds += m_stats.milliseconds;
+    m_reportMaxMilliseconds = std::max(m_reportMaxMilliseconds, m_stats.milliseconds);
+
+    return m_visible;
+}
+
+void CullingSystem::report() {
+    if (m_reportFrames == 0) {
+        return;
+    }
+
+    std::cout << "culling: " << m_reportVisible / m_reportFrames << "/" << m_reportTotal / m_reportFrames << " visible ("
+              << (m_reportTotal > 0 ? 100.0 * m_reportVisible / m_reportTotal : 0.0) << "%), "
+              << m_reportMilliseconds / m_reportFrames << " ms avg, " << m_reportMaxMilliseconds << " ms max, "
+              << m_reportRebuilds << " rebuilds over " << m_reportFrames << " frames" << std::endl;
+
+    m_reportFrames = 0;
+    m_reportVisible = 0;
+    m_reportTotal = 0;
+    m_reportRebuilds = 0;
+    m_reportMilliseconds = 0.0;
+    m_reportMaxMilliseconds = 0.0f;
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <span>
+#include "shared.h"
+#include "geometry/bounds.h"
+#include "scene/bvh.h"
+#include "scene/transform_system.h"
+
+namespace eng {
+
+struct CullingStats {
+    uint32_t total = 0;
+    uint32_t visible = 0;
+    uint32_t nodesVisited = 0;
+    uint32_t refittedNodes = 0;
+    bool isRebuilt = false;
+    float milliseconds = 0.0f;  // refit or rebuild plus traversal
+};
+
+// frustum culling of scene objects, a transform with the bounds of its mesh. world
+// bounds follow the transform updates and the bvh is refit above the moved objects,
+// or rebuilt after objects were added or once refits have loosened it too much.
+class CullingSystem {
+public:
+    uint32_t add(const TransformSystem& transforms, TransformHandle transform, const Aabb& localBounds);
+
+    // once per frame before culling, updated is what TransformSystem::update returned
+    void update(const TransformSystem& transforms, std::span<const uint32_t> updated);
+
+    // visible transforms in ascending order, so consecutive handles can share an instanced draw
+    std::span<const TransformHandle> cull(const glm::mat4& viewProjection);
+
+    inline const CullingStats& getStats() const { return m_stats; }
+    inline uint32_t getObjectCount() const { return static_cast<uint32_t>(m_transforms.size()); }
+    // as of the last update
+    inline const Aabb& getWorldBounds(TransformHandle transform) const { return m_worldBounds[m_objects[transform]]; }
+
+    // logs the averages since the last report
+    void report();
+
+private:
+    static constexpr uint32_t m_NO_OBJECT = ~0u;
+    static constexpr float m_MAX_DEGRADATION = 1.5f;  // root area growth through refits before a rebuild
+
+    std::vector<TransformHandle> m_transforms;
+    std::vector<Aabb> m_localBounds;
+    std::vector<Aabb> m_worldBounds;
+    std::vector<uint32_t> m_objects;  // by transform handle
+    Bvh m_bvh;
+    bool m_isBvhStale = true;
+
+    std::vector<uint32_t> m_visibleObjects;
+    std::vector<TransformHandle> m_visible;
+
+    CullingStats m_stats;
+    uint32_t m_reportFrames = 0;
+    uint64_t m_reportVisible = 0;
+    uint64_t m_reportTotal = 0;
+    uint32_t m_reportRebuilds = 0;
+    double m_reportMilliseconds = 0.0;
+    float m_reportMaxMilliseconds = 0.0f;
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "scene/instance_buffer.h"
+
+namespace eng {
+
+static_assert(sizeof(InstanceLayout) == sizeof(glm::mat4), "instance layout must match a world matrix");
+
+InstanceBuffer::InstanceBuffer(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, uint32_t capacity, uint32_t frameCount)
+    : m_capacity(capacity), m_pending(frameCount) {
+    VkBufferCreateInfo bufferInfo = vk::bufferCreateInfo();
+    bufferInfo.size = static_cast<VkDeviceSize>(capacity) * sizeof(glm::mat4);
+    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+    m_buffers.reserve(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++) {
+        m_buffers.emplace_back(device, physicalDevice, bufferInfo, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    }
+}
+
+void InstanceBuffer::write(uint32_t frameIndex, const TransformSystem& transforms, std::span<const uint32_t> updated) {
+    if (transforms.getCount() > m_capacity) {
+        throw std::runtime_error("instance buffer is too small for the scene!");
+    }
+
+    std::span<const glm::mat4> matrices = transforms.getWorldMatrices();
+    std::vector<uint32_t>& pending = m_pending[frameIndex];
+    if (pending.size() >= transforms.getCount()) {
+        // cheaper to copy everything than to chase the list
+        m_buffers[frameIndex].setData(matrices.data(), matrices.size_bytes());
+    } else {
+        _copy(m_buffers[frameIndex], matrices, pending);
+        _copy(m_buffers[frameIndex], matrices, updated);
+    }
+    pending.clear();
+
+    for (uint32_t i = 0; i < m_pending.size(); i++) {
+        if (i != frameIndex) {
+            m_pending[i].insert(m_pending[i].end(), updated.begin(), updated.end());
+        }
+    }
+}
+
+void InstanceBuffer::_copy(vk::Buffer& buffer, std::span<const glm::mat4> matrices, std::span<const uint32_t> nodes) {
+    // nodes come in ascending runs, each run is one copy
+    for (size_t i = 0; i < nodes.size();) {
+        size_t end = i + 1;
+        while (end < nodes.size() && nodes[end] == nodes[end - 1] + 1) {
+            end++;
+        }
+
+        size_t count = end - i;
+        buffer.setData(&matrices[nodes[i]], count * sizeof(glm::mat4), static_cast<VkDeviceSize>(nodes[i]) * sizeof(glm::mat4));
+        i = end;
+    }
+}
+
+}  // namespace eng
\ No newline at end of file
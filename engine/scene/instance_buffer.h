@@ -0,0 +1,38 @@
+#pragma once
+
+#include <span>
+#include "shared.h"
+#include "geometry/vertex_layout.h"
+#include "scene/transform_system.h"
+#include "wrapper/vk/buffer.h"
+#include "wrapper/vk/device.h"
+#include "wrapper/vk/physical_device.h"
+
+namespace eng {
+
+// a world matrix per instance, read as four vec4 columns
+using InstanceLayout = VertexLayout<glm::vec4, glm::vec4, glm::vec4, glm::vec4>;
+
+// per frame, persistently mapped copies of the world matrices, indexed by transform
+// handle and bound as a per instance vertex stream. each copy only receives the
+// matrices that changed since it was last written.
+class InstanceBuffer {
+public:
+    InstanceBuffer(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, uint32_t capacity, uint32_t frameCount);
+
+    // updated is what TransformSystem::update returned, call once per update
+    void write(uint32_t frameIndex, const TransformSystem& transforms, std::span<const uint32_t> updated);
+
+    inline const vk::Buffer& getBuffer(uint32_t frameIndex) const { return m_buffers[frameIndex]; }
+    inline uint32_t getCapacity() const { return m_capacity; }
+
+private:
+    uint32_t m_capacity;
+    std::vector<vk::Buffer> m_buffers;
+    std::vector<std::vector<uint32_t>> m_pending;  // changed since the frame's copy was written
+
+private:
+    void _copy(vk::Buffer& buffer, std::span<const glm::mat4> matrices, std::span<const uint32_t> nodes);
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "scene/skeletal_animation.h"
+#include <cmath>
+
+namespace eng {
+
+namespace {
+
+// q = a * b
+inline void _multiply(float ax, float ay, float az, float aw, float bx, float by, float bz, float bw, float& x, float& y, float& z, float& w) {
+    x = aw * bx + ax * bw + ay * bz - az * by;
+    y = aw * by - ax * bz + ay * bw + az * bx;
+    z = aw * bz + ax * by - ay * bx + az * bw;
+    w = aw * bw - ax * bx - ay * by - az * bz;
+}
+
+// v rotated by q, v + 2w (q x v) + 2 q x (q x v)
+inline void _rotate(float qx, float qy, float qz, float qw, float& vx, float& vy, float& vz) {
+    float tx = 2.0f * (qy * vz - qz * vy);
+    float ty = 2.0f * (qz * vx - qx * vz);
+    float tz = 2.0f * (qx * vy - qy * vx);
+    float rx = vx + qw * tx + (qy * tz - qz * ty);
+    float ry = vy + qw * ty + (qz * tx - qx * tz);
+    float rz = vz + qw * tz + (qx * ty - qy * tx);
+    vx = rx;
+    vy = ry;
+    vz = rz;
+}
+
+}  // namespace
+
+AnimationSystem::AnimationSystem(const Skeleton& skeleton, uint32_t capacity)
+    : m_capacity(capacity),
+      m_jointCount(skeleton.getJointCount()),
+      m_parents(skeleton.parents),
+      m_translations(skeleton.translations) {
+    // the inverse of the bind pose in model space takes a vertex to the joint's space
+    std::vector<glm::quat> bindRotations(m_jointCount);
+    std::vector<glm::vec3> bindPositions(m_jointCount);
+    m_inverseBindRotations.resize(m_jointCount);
+    m_inverseBindTranslations.resize(m_jointCount);
+    for (uint32_t joint = 0; joint < m_jointCount; joint++) {
+        uint32_t parent = m_parents[joint];
+        if (parent == NO_JOINT) {
+            bindRotations[joint] = skeleton.rotations[joint];
+            bindPositions[joint] = skeleton.translations[joint];
+        } else if (parent < joint) {
+            bindRotations[joint] = bindRotations[parent] * skeleton.rotations[joint];
+            bindPositions[joint] = bindPositions[parent] + bindRotations[parent] * skeleton.translations[joint];
+        } else {
+            throw std::runtime_error("joint parent does not come before the joint!");
+        }
+        m_inverseBindRotations[joint] = glm::conjugate(bindRotations[joint]);
+        m_inverseBindTranslations[joint] = -(m_inverseBindRotations[joint] * bindPositions[joint]);
+    }
+
+    size_t poseSize = static_cast<size_t>(m_jointCount) * capacity;
+    for (std::vector<float>* values : {&m_rotationX, &m_rotationY, &m_rotationZ, &m_rotationW, &m_positionX, &m_positionY, &m_positionZ}) {
+        values->resize(poseSize);
+    }
+    for (std::vector<float>* values : {&m_localX, &m_localY, &m_localZ, &m_localW}) {
+        values->resize(capacity);
+    }
+    m_clips.reserve(capacity);
+    m_startTimes.reserve(capacity);
+    m_speeds.reserve(capacity);
+    m_keys.resize(capacity);
+    m_blends.resize(capacity);
+    m_skinMatrices.reserve(poseSize);
+}
+
+uint32_t AnimationSystem::create(const AnimationClip& clip, float startTime, float speed) {
+    if (getCount() == m_capacity) {
+        throw std::runtime_error("too many animated characters!");
+    }
+    if (clip.keyCount == 0 || clip.rotations.size() != static_cast<size_t>(clip.keyCount) * m_jointCount) {
+        throw std::runtime_error("animation clip does not match the skeleton!");
+    }
+
+    m_clips.push_back(&clip);
+    m_startTimes.push_back(startTime);
+    m_speeds.push_back(speed);
+    m_skinMatrices.resize(m_skinMatrices.size() + m_jointCount);
+    return getCount() - 1;
+}
+
+std::span<const JointMatrix> AnimationSystem::update(float time) {
+    uint32_t count = getCount();
+    for (uint32_t character = 0; character < count; character++) {
+        const AnimationClip& clip = *m_clips[character];
+        float phase = (m_startTimes[character] + time * m_speeds[character]) / clip.duration;
+        float key = (phase - std::floor(phase)) * clip.keyCount;
+        m_keys[character] = std::min(static_cast<uint32_t>(key), clip.keyCount - 1);
+        m_blends[character] = key - m_keys[character];
+    }
+
+    for (uint32_t joint = 0; joint < m_jointCount; joint++) {
+        _sample(joint);
+
+        float* rx = m_rotationX.data() + joint * m_capacity;
+        float* ry = m_rotationY.data() + joint * m_capacity;
+        float* rz = m_rotationZ.data() + joint * m_capacity;
+        float* rw = m_rotationW.data() + joint * m_capacity;
+        float* px = m_positionX.data() + joint * m_capacity;
+        float* py = m_positionY.data() + joint * m_capacity;
+        float* pz = m_positionZ.data() + joint * m_capacity;
+        const glm::vec3& translation = m_translations[joint];
+
+        // the pose of the joint in model space, the parent's is already there
+        uint32_t parent = m_parents[joint];
+        if (parent == NO_JOINT) {
+            for (uint32_t character = 0; character < count; character++) {
+                rx[character] = m_localX[character];
+                ry[character] = m_localY[character];
+                rz[character] = m_localZ[character];
+                rw[character] = m_localW[character];
+                px[character] = translation.x;
+                py[character] = translation.y;
+                pz[character] = translation.z;
+            }
+        } else {
+            const float* parentX = m_rotationX.data() + parent * m_capacity;
+            const float* parentY = m_rotationY.data() + parent * m_capacity;
+            const float* parentZ = m_rotationZ.data() + parent * m_capacity;
+            const float* parentW = m_rotationW.data() + parent * m_capacity;
+            const float* parentPositionX = m_positionX.data() + parent * m_capacity;
+            const float* parentPositionY = m_positionY.data() + parent * m_capacity;
+            const float* parentPositionZ = m_positionZ.data() + parent * m_capacity;
+            for (uint32_t character = 0; character < count; character++) {
+                _multiply(parentX[character], parentY[character], parentZ[character], parentW[character],
+                          m_localX[character], m_localY[character], m_localZ[character], m_localW[character],
+                          rx[character], ry[character], rz[character], rw[character]);
+                float x = translation.x, y = translation.y, z = translation.z;
+                _rotate(parentX[character], parentY[character], parentZ[character], parentW[character], x, y, z);
+                px[character] = parentPositionX[character] + x;
+                py[character] = parentPositionY[character] + y;
+                pz[character] = parentPositionZ[character] + z;
+            }
+        }
+
+        // skinning matrix = model pose * inverse bind pose
+        const glm::quat& inverseRotation = m_inverseBindRotations[joint];
+        const glm::vec3& inverseTranslation = m_inverseBindTranslations[joint];
+        for (uint32_t character = 0; character < count; character++) {
+            float x, y, z, w;
+            _multiply(rx[character], ry[character], rz[character], rw[character],
+                      inverseRotation.x, inverseRotation.y, inverseRotation.z, inverseRotation.w, x, y, z, w);
+            float tx = inverseTranslation.x, ty = inverseTranslation.y, tz = inverseTranslation.z;
+            _rotate(rx[character], ry[character], rz[character], rw[character], tx, ty, tz);
+
+            JointMatrix& matrix = m_skinMatrices[static_cast<size_t>(character) * m_jointCount + joint];
+            matrix.rows[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - w * z), 2.0f * (x * z + w * y), px[character] + tx);
+            matrix.rows[1] = glm::vec4(2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - w * x), py[character] + ty);
+            matrix.rows[2] = glm::vec4(2.0f * (x * z - w * y), 2.0f * (y * z + w * x), 1.0f - 2.0f * (x * x + y * y), pz[character] + tz);
+        }
+    }
+
+    return m_skinMatrices;
+}
+
+// the joint's rotation of every character, blended between the keys around its time
+void AnimationSystem::_sample(uint32_t joint) {
+    uint32_t count = getCount();
+    for (uint32_t character = 0; character < count; character++) {
+        const AnimationClip& clip = *m_clips[character];
+        uint32_t key = m_keys[character];
+        const glm::quat& from = clip.rotations[static_cast<size_t>(key) * m_jointCount + joint];
+        glm::quat to = clip.rotations[static_cast<size_t>((key + 1) % clip.keyCount) * m_jointCount + joint];
+        if (glm::dot(from, to) < 0.0f) {
+            to = -to;  // the shorter way around
+        }
+
+        glm::quat rotation = glm::normalize(from + (to - from) * m_blends[character]);
+        m_localX[character] = rotation.x;
+        m_localY[character] = rotation.y;
+        m_localZ[character] = rotation.z;
+        m_localW[character] = rotation.w;
+    }
+}
+
+}  // namespace eng
\ No newline at end of file
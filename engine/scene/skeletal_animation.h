@@ -0,0 +1,80 @@
+#pragma once
+
+#include <span>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "shared.h"
+
+namespace eng {
+
+constexpr uint32_t NO_JOINT = ~0u;
+
+// joints relative to their parent in the bind pose, a parent always comes before its
+// children
+struct Skeleton {
+    std::vector<uint32_t> parents;  // NO_JOINT for a root
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+
+    inline uint32_t getJointCount() const { return static_cast<uint32_t>(parents.size()); }
+};
+
+// a looping clip of joint rotations sampled at even intervals, the joints keep the
+// translations of the bind pose
+struct AnimationClip {
+    float duration = 1.0f;
+    uint32_t keyCount = 0;              // the last key blends back into the first
+    std::vector<glm::quat> rotations;  // a rotation per joint for every key, key after key
+};
+
+// the rows of an affine model space transform, std430 as read by skinning.comp
+struct JointMatrix {
+    glm::vec4 rows[3];
+};
+
+// evaluates the skinning matrices of every character sharing a skeleton on the cpu.
+// joint rotations and translations are kept in structure of arrays layout, joint
+// after joint with a run of every character for each, so sampling, composing along
+// the skeleton and applying the inverse bind pose are loops over the characters of
+// one joint that the compiler vectorizes.
+class AnimationSystem {
+public:
+    AnimationSystem(const Skeleton& skeleton, uint32_t capacity);
+
+    // a character playing the clip at the given speed, startTime seconds into it at time zero.
+    // the clip must outlive the system.
+    uint32_t create(const AnimationClip& clip, float startTime = 0.0f, float speed = 1.0f);
+
+    // samples the clip of every character at time and returns the skinning matrices,
+    // the joints of one character after the other. valid until the next update.
+    std::span<const JointMatrix> update(float time);
+
+    inline uint32_t getJointCount() const { return m_jointCount; }
+    inline uint32_t getCount() const { return static_cast<uint32_t>(m_clips.size()); }
+
+private:
+    uint32_t m_capacity;
+    uint32_t m_jointCount;
+    std::vector<uint32_t> m_parents;
+    std::vector<glm::vec3> m_translations;  // bind pose, relative to the parent
+    std::vector<glm::quat> m_inverseBindRotations;
+    std::vector<glm::vec3> m_inverseBindTranslations;
+
+    std::vector<const AnimationClip*> m_clips;
+    std::vector<float> m_startTimes;
+    std::vector<float> m_speeds;
+    std::vector<uint32_t> m_keys;    // per character, the key before the sampled time
+    std::vector<float> m_blends;     // towards the key after it
+
+    // model space pose, joint * capacity + character
+    std::vector<float> m_rotationX, m_rotationY, m_rotationZ, m_rotationW;
+    std::vector<float> m_positionX, m_positionY, m_positionZ;
+    std::vector<float> m_localX, m_localY, m_localZ, m_localW;  // scratch, the sampled rotations of one joint
+
+    std::vector<JointMatrix> m_skinMatrices;
+
+private:
+    void _sample(uint32_t joint);
+};
+
+}  // namespace eng
\ No newline at end of file
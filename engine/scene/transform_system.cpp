@@ -0,0 +1,220 @@
+#include "scene/transform_system.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <xmmintrin.h>
+    #define ENGINE_TRANSFORM_SSE 1
+#endif
+
+namespace eng {
+
+namespace {
+
+#ifdef ENGINE_TRANSFORM_SSE
+
+// out = parent * local, column by column
+void _multiply(const glm::mat4& parent, const glm::mat4& local, glm::mat4& out) {
+    const float* p = glm::value_ptr(parent);
+    const float* l = glm::value_ptr(local);
+    float* o = glm::value_ptr(out);
+
+    __m128 p0 = _mm_loadu_ps(p);
+    __m128 p1 = _mm_loadu_ps(p + 4);
+    __m128 p2 = _mm_loadu_ps(p + 8);
+    __m128 p3 = _mm_loadu_ps(p + 12);
+    for (int c = 0; c < 4; c++) {
+        __m128 column = _mm_mul_ps(p0, _mm_set1_ps(l[c * 4]));
+        column = _mm_add_ps(column, _mm_mul_ps(p1, _mm_set1_ps(l[c * 4 + 1])));
+        column = _mm_add_ps(column, _mm_mul_ps(p2, _mm_set1_ps(l[c * 4 + 2])));
+        column = _mm_add_ps(column, _mm_mul_ps(p3, _mm_set1_ps(l[c * 4 + 3])));
+        _mm_storeu_ps(o + c * 4, column);
+    }
+}
+
+// one lane per node, contiguous nodes are loaded directly
+__m128 _gather(const std::vector<float>& values, const uint32_t* nodes) {
+    if (nodes[3] - nodes[0] == 3) {
+        return _mm_loadu_ps(values.data() + nodes[0]);
+    }
+    return _mm_setr_ps(values[nodes[0]], values[nodes[1]], values[nodes[2]], values[nodes[3]]);
+}
+
+#else
+
+void _multiply(const glm::mat4& parent, const glm::mat4& local, glm::mat4& out) {
+    out = parent * local;
+}
+
+#endif
+
+}  // namespace
+
+TransformSystem::TransformSystem(uint32_t capacity) {
+    for (std::vector<float>* values : {&m_positionX, &m_positionY, &m_positionZ, &m_rotationX, &m_rotationY, &m_rotationZ, &m_rotationW, &m_scaleX, &m_scaleY, &m_scaleZ}) {
+        values->reserve(capacity);
+    }
+    m_parents.reserve(capacity);
+    m_dirty.reserve(capacity);
+    m_worldMatrices.reserve(capacity);
+}
+
+TransformHandle TransformSystem::create(TransformHandle parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+    if (parent != NO_PARENT && parent >= getCount()) {
+        throw std::runtime_error("transform parent does not exist!");
+    }
+
+    m_positionX.push_back(position.x);
+    m_positionY.push_back(position.y);
+    m_positionZ.push_back(position.z);
+    m_rotationX.push_back(rotation.x);
+    m_rotationY.push_back(rotation.y);
+    m_rotationZ.push_back(rotation.z);
+    m_rotationW.push_back(rotation.w);
+    m_scaleX.push_back(scale.x);
+    m_scaleY.push_back(scale.y);
+    m_scaleZ.push_back(scale.z);
+    m_parents.push_back(parent);
+    m_dirty.push_back(1);
+    m_worldMatrices.push_back(glm::mat4(1.0f));
+
+    return getCount() - 1;
+}
+
+void TransformSystem::setPosition(TransformHandle node, const glm::vec3& position) {
+    m_positionX[node] = position.x;
+    m_positionY[node] = position.y;
+    m_positionZ[node] = position.z;
+    m_dirty[node] = 1;
+}
+
+void TransformSystem::setRotation(TransformHandle node, const glm::quat& rotation) {
+    m_rotationX[node] = rotation.x;
+    m_rotationY[node] = rotation.y;
+    m_rotationZ[node] = rotation.z;
+    m_rotationW[node] = rotation.w;
+    m_dirty[node] = 1;
+}
+
+void TransformSystem::setScale(TransformHandle node, const glm::vec3& scale) {
+    m_scaleX[node] = scale.x;
+    m_scaleY[node] = scale.y;
+    m_scaleZ[node] = scale.z;
+    m_dirty[node] = 1;
+}
+
+glm::vec3 TransformSystem::getPosition(TransformHandle node) const {
+    return glm::vec3(m_positionX[node], m_positionY[node], m_positionZ[node]);
+}
+
+glm::quat TransformSystem::getRotation(TransformHandle node) const {
+    return glm::quat(m_rotationW[node], m_rotationX[node], m_rotationY[node], m_rotationZ[node]);
+}
+
+glm::vec3 TransformSystem::getScale(TransformHandle node) const {
+    return glm::vec3(m_scaleX[node], m_scaleY[node], m_scaleZ[node]);
+}
+
+std::span<const uint32_t> TransformSystem::update() {
+    // parents come first, so their flag is final by the time a child reads it
+    m_updated.clear();
+    for (uint32_t node = 0; node < getCount(); node++) {
+        TransformHandle parent = m_parents[node];
+        if (parent != NO_PARENT && m_dirty[parent]) {
+            m_dirty[node] = 1;
+        }
+        if (m_dirty[node]) {
+            m_updated.push_back(node);
+        }
+    }
+
+    m_localMatrices.resize(m_updated.size());
+    _composeLocal(m_updated, m_localMatrices.data());
+
+    for (size_t i = 0; i < m_updated.size(); i++) {
+        uint32_t node = m_updated[i];
+        TransformHandle parent = m_parents[node];
+        if (parent == NO_PARENT) {
+            m_worldMatrices[node] = m_localMatrices[i];
+        } else {
+            _multiply(m_worldMatrices[parent], m_localMatrices[i], m_worldMatrices[node]);
+        }
+        m_dirty[node] = 0;
+    }
+
+    return m_updated;
+}
+
+void TransformSystem::_composeLocal(std::span<const uint32_t> nodes, glm::mat4* out) const {
+    size_t i = 0;
+
+#ifdef ENGINE_TRANSFORM_SSE
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= nodes.size(); i += 4) {
+        const uint32_t* batch = nodes.data() + i;
+        __m128 x = _gather(m_rotationX, batch);
+        __m128 y = _gather(m_rotationY, batch);
+        __m128 z = _gather(m_rotationZ, batch);
+        __m128 w = _gather(m_rotationW, batch);
+        __m128 scaleX = _gather(m_scaleX, batch);
+        __m128 scaleY = _gather(m_scaleY, batch);
+        __m128 scaleZ = _gather(m_scaleZ, batch);
+
+        __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+        __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+        __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+        // rotation matrix scaled per column, element mCR is column C row R
+        __m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), scaleX);
+        __m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), scaleX);
+        __m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), scaleX);
+        __m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), scaleY);
+        __m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), scaleY);
+        __m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), scaleY);
+        __m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), scaleZ);
+        __m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), scaleZ);
+        __m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), scaleZ);
+        __m128 m30 = _gather(m_positionX, batch);
+        __m128 m31 = _gather(m_positionY, batch);
+        __m128 m32 = _gather(m_positionZ, batch);
+        __m128 m03 = zero, m13 = zero, m23 = zero, m33 = one;
+
+        // lanes to matrices, after a transpose register k holds one column of node k
+        _MM_TRANSPOSE4_PS(m00, m01, m02, m03);
+        _MM_TRANSPOSE4_PS(m10, m11, m12, m13);
+        _MM_TRANSPOSE4_PS(m20, m21, m22, m23);
+        _MM_TRANSPOSE4_PS(m30, m31, m32, m33);
+
+        const __m128 columns[4][4] = {
+            {m00, m10, m20, m30},
+            {m01, m11, m21, m31},
+            {m02, m12, m22, m32},
+            {m03, m13, m23, m33}};
+        for (int k = 0; k < 4; k++) {
+            float* matrix = glm::value_ptr(out[i + k]);
+            for (int c = 0; c < 4; c++) {
+                _mm_storeu_ps(matrix + c * 4, columns[k][c]);
+            }
+        }
+    }
+#endif
+
+    for (; i < nodes.size(); i++) {
+        _composeLocalScalar(nodes[i], out[i]);
+    }
+}
+
+void TransformSystem::_composeLocalScalar(uint32_t node, glm::mat4& out) const {
+    float x = m_rotationX[node], y = m_rotationY[node], z = m_rotationZ[node], w = m_rotationW[node];
+    float sx = m_scaleX[node], sy = m_scaleY[node], sz = m_scaleZ[node];
+
+    out[0] = glm::vec4((1.0f - 2.0f * (y * y + z * z)) * sx, 2.0f * (x * y + w * z) * sx, 2.0f * (x * z - w * y) * sx, 0.0f);
+    out[1] = glm::vec4(2.0f * (x * y - w * z) * sy, (1.0f - 2.0f * (x * x + z * z)) * sy, 2.0f * (y * z + w * x) * sy, 0.0f);
+    out[2] = glm::vec4(2.0f * (x * z + w * y) * sz, 2.0f * (y * z - w * x) * sz, (1.0f - 2.0f * (x * x + y * y)) * sz, 0.0f);
+    out[3] = glm::vec4(m_positionX[node], m_positionY[node], m_positionZ[node], 1.0f);
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <span>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "shared.h"
+
+namespace eng {
+
+using TransformHandle = uint32_t;
+constexpr TransformHandle NO_PARENT = ~0u;
+
+// transforms of every scene node in structure of arrays layout. a parent is always
+// created before its children, so one pass in index order sees every parent's world
+// matrix before its children need it. only dirty nodes and their descendants are
+// recomposed, four at a time with sse where available.
+class TransformSystem {
+public:
+    explicit TransformSystem(uint32_t capacity = 0);
+
+    TransformHandle create(TransformHandle parent = NO_PARENT,
+                           const glm::vec3& position = glm::vec3(0.0f),
+                           const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                           const glm::vec3& scale = glm::vec3(1.0f));
+
+    void setPosition(TransformHandle node, const glm::vec3& position);
+    void setRotation(TransformHandle node, const glm::quat& rotation);
+    void setScale(TransformHandle node, const glm::vec3& scale);
+
+    glm::vec3 getPosition(TransformHandle node) const;
+    glm::quat getRotation(TransformHandle node) const;
+    glm::vec3 getScale(TransformHandle node) const;
+    inline TransformHandle getParent(TransformHandle node) const { return m_parents[node]; }
+    inline const glm::mat4& getWorldMatrix(TransformHandle node) const { return m_worldMatrices[node]; }
+    inline std::span<const glm::mat4> getWorldMatrices() const { return m_worldMatrices; }
+    inline uint32_t getCount() const { return static_cast<uint32_t>(m_parents.size()); }
+
+    // recomposes the world matrices of dirty nodes and their descendants and returns
+    // the nodes that changed, in ascending order. valid until the next update.
+    std::span<const uint32_t> update();
+
+private:
+    std::vector<float> m_positionX, m_positionY, m_positionZ;
+    std::vector<float> m_rotationX, m_rotationY, m_rotationZ, m_rotationW;
+    std::vector<float> m_scaleX, m_scaleY, m_scaleZ;
+    std::vector<TransformHandle> m_parents;
+    std::vector<uint8_t> m_dirty;
+    std::vector<glm::mat4> m_worldMatrices;
+
+    std::vector<uint32_t> m_updated;
+    std::vector<glm::mat4> m_localMatrices;  // scratch, one per updated node
+
+private:
+    void _composeLocal(std::span<const uint32_t> nodes, glm::mat4* out) const;
+    void _composeLocalScalar(uint32_t node, glm::mat4& out) const;
+};
+
+}  // namespace eng
\ No newline at end of file
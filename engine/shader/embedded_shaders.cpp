@@ -0,0 +1,31 @@
+#include "shader/embedded_shaders.h"
+
+namespace eng {
+
+namespace {
+
+struct EmbeddedShader {
+    std::string_view name;
+    std::span<const uint32_t> code;
+};
+
+#ifdef ENGINE_EMBEDDED_SHADERS
+    // generated by cmake, defines the word arrays and EMBEDDED_SHADERS
+    #include "embedded_shaders.inc"
+#endif
+
+}  // namespace
+
+std::span<const uint32_t> findEmbeddedShader([[maybe_unused]] std::string_view name) {
+#ifdef ENGINE_EMBEDDED_SHADERS
+    for (const EmbeddedShader& shader : EMBEDDED_SHADERS) {
+        if (shader.name == name) {
+            return shader.code;
+        }
+    }
+#endif
+
+    return {};
+}
+
+}  // namespace eng
\ No newline at end of file
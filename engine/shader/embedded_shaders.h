@@ -0,0 +1,13 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+#include "shared.h"
+
+namespace eng {
+
+// spir-v compiled into the binary at build time, looked up by its resource path
+// (eg. "shaders/bin/default_vert.spv"). empty if the shader was not embedded.
+std::span<const uint32_t> findEmbeddedShader(std::string_view name);
+
+}  // namespace eng
\ No newline at end of file
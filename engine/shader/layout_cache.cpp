@@ -0,0 +1,180 @@
+#include "shader/layout_cache.h"
+
+namespace eng {
+
+std::vector<VkDescriptorPoolSize> PipelineLayout::getPoolSizes(uint32_t set, uint32_t setCount) const {
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    for (const VkDescriptorSetLayoutBinding& binding : setBindings.at(set)) {
+        auto it = std::find_if(poolSizes.begin(), poolSizes.end(), [&](const VkDescriptorPoolSize& size) {
+            return size.type == binding.descriptorType;
+        });
+        if (it == poolSizes.end()) {
+            it = poolSizes.insert(poolSizes.end(), {binding.descriptorType, 0});
+        }
+        it->descriptorCount += binding.descriptorCount * setCount;
+    }
+    return poolSizes;
+}
+
+VkShaderStageFlags PipelineLayout::getPushConstantStages(uint32_t offset, uint32_t size) const {
+    VkShaderStageFlags stages = 0;
+    for (const VkPushConstantRange& range : pushConstants) {
+        if (range.offset < offset + size && offset < range.offset + range.size) {
+            stages |= range.stageFlags;
+        }
+    }
+
+    if (stages == 0) {
+        throw std::runtime_error("pipeline layout has no push constants at the given range!");
+    }
+    return stages;
+}
+
+LayoutCache::LayoutCache(const vk::Device& device)
+    : m_device(device) {
+}
+
+LayoutCache::~LayoutCache() {
+    for (auto& [key, pipelineLayout] : m_pipelineLayouts) {
+        vkDestroyPipelineLayout(m_device.get(), pipelineLayout->layout, nullptr);
+    }
+    for (auto& [key, setLayout] : m_setLayouts) {
+        vkDestroyDescriptorSetLayout(m_device.get(), setLayout, nullptr);
+    }
+}
+
+const PipelineLayout& LayoutCache::get(std::span<const ShaderReflection> stages) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::vector<std::vector<VkDescriptorSetLayoutBinding>> setBindings;
+
+    for (const ShaderReflection& stage : stages) {
+        for (const ReflectedBinding& reflected : stage.bindings) {
+            if (setBindings.size() <= reflected.set) {
+                setBindings.resize(reflected.set + 1);
+            }
+
+            std::vector<VkDescriptorSetLayoutBinding>& bindings = setBindings[reflected.set];
+            auto it = std::find_if(bindings.begin(), bindings.end(), [&](const VkDescriptorSetLayoutBinding& binding) {
+                return binding.binding == reflected.binding;
+            });
+
+            if (it == bindings.end()) {
+                bindings.push_back({reflected.binding, reflected.type, reflected.count, reflected.stages, nullptr});
+                continue;
+            }
+            if (it->descriptorType != reflected.type) {
+                throw std::runtime_error("shader stages disagree on the type of set " + std::to_string(reflected.set) +
+                                         " binding " + std::to_string(reflected.binding) + "!");
+            }
+            it->descriptorCount = std::max(it->descriptorCount, reflected.count);
+            it->stageFlags |= reflected.stages;
+        }
+    }
+
+    for (std::vector<VkDescriptorSetLayoutBinding>& bindings : setBindings) {
+        std::sort(bindings.begin(), bindings.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+            return a.binding < b.binding;
+        });
+    }
+
+    PipelineKey key;
+    for (const std::vector<VkDescriptorSetLayoutBinding>& bindings : setBindings) {
+        key.first.push_back(getSetLayout(bindings));
+    }
+
+    std::vector<VkPushConstantRange> pushConstants = _mergePushConstants(stages);
+    for (const VkPushConstantRange& range : pushConstants) {
+        key.second.push_back({range.stageFlags, range.offset, range.size});
+    }
+
+    auto it = m_pipelineLayouts.find(key);
+    if (it != m_pipelineLayouts.end()) {
+        return *it->second;
+    }
+
+    auto pipelineLayout = std::make_unique<PipelineLayout>();
+    pipelineLayout->setLayouts = key.first;
+    pipelineLayout->setBindings = std::move(setBindings);
+    pipelineLayout->pushConstants = std::move(pushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    {
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(pipelineLayout->setLayouts.size());
+        pipelineLayoutInfo.pSetLayouts = pipelineLayout->setLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pipelineLayout->pushConstants.size());
+        pipelineLayoutInfo.pPushConstantRanges = pipelineLayout->pushConstants.data();
+    }
+
+    if (vkCreatePipelineLayout(m_device.get(), &pipelineLayoutInfo, nullptr, &pipelineLayout->layout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    return *m_pipelineLayouts.emplace(std::move(key), std::move(pipelineLayout)).first->second;
+}
+
+VkDescriptorSetLayout LayoutCache::getSetLayout(std::span<const VkDescriptorSetLayoutBinding> bindings) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    SetKey key;
+    for (const VkDescriptorSetLayoutBinding& binding : bindings) {
+        if (binding.pImmutableSamplers != nullptr) {
+            throw std::runtime_error("layout cache does not support immutable samplers!");
+        }
+        key.push_back({binding.binding, static_cast<uint32_t>(binding.descriptorType), binding.descriptorCount, binding.stageFlags});
+    }
+
+    auto it = m_setLayouts.find(key);
+    if (it != m_setLayouts.end()) {
+        return it->second;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    {
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+    }
+
+    VkDescriptorSetLayout setLayout;
+    if (vkCreateDescriptorSetLayout(m_device.get(), &layoutInfo, nullptr, &setLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    m_setLayouts.emplace(std::move(key), setLayout);
+    return setLayout;
+}
+
+// one range per stage covering exactly what the stage declares, stages with an
+// identical range share it. vulkan allows every stage in at most one range.
+std::vector<VkPushConstantRange> LayoutCache::_mergePushConstants(std::span<const ShaderReflection> stages) {
+    std::vector<VkPushConstantRange> ranges;
+
+    for (const ShaderReflection& stage : stages) {
+        if (stage.pushConstants.empty()) {
+            continue;
+        }
+
+        uint32_t begin = UINT32_MAX;
+        uint32_t end = 0;
+        for (const VkPushConstantRange& range : stage.pushConstants) {
+            begin = std::min(begin, range.offset);
+            end = std::max(end, range.offset + range.size);
+        }
+
+        auto it = std::find_if(ranges.begin(), ranges.end(), [&](const VkPushConstantRange& range) {
+            return range.offset == begin && range.size == end - begin;
+        });
+        if (it != ranges.end()) {
+            it->stageFlags |= stage.stage;
+        } else {
+            ranges.push_back({static_cast<VkShaderStageFlags>(stage.stage), begin, end - begin});
+        }
+    }
+
+    std::sort(ranges.begin(), ranges.end(), [](const VkPushConstantRange& a, const VkPushConstantRange& b) {
+        return a.offset != b.offset ? a.offset < b.offset : a.stageFlags < b.stageFlags;
+    });
+    return ranges;
+}
+
+}  // namespace eng
\ No newline at end of file
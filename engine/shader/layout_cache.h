@@ -0,0 +1,60 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include "shared.h"
+#include "shader/spirv_reflection.h"
+#include "wrapper/vk/device.h"
+
+namespace eng {
+
+// layout of a pipeline merged from the reflection of all of its stages. owned by the cache.
+struct PipelineLayout {
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSetLayout> setLayouts;  // indexed by set, unused sets get an empty layout
+    std::vector<std::vector<VkDescriptorSetLayoutBinding>> setBindings;
+    std::vector<VkPushConstantRange> pushConstants;
+
+    // pool sizes for setCount descriptor sets of the given layout
+    std::vector<VkDescriptorPoolSize> getPoolSizes(uint32_t set, uint32_t setCount) const;
+    // stages vkCmdPushConstants has to name, those of every range overlapping the bytes
+    VkShaderStageFlags getPushConstantStages(uint32_t offset, uint32_t size) const;
+};
+
+// dedupes descriptor set and pipeline layouts by their contents, so shader variants
+// sharing an interface share their layouts and sets stay compatible across pipelines.
+// safe to call from several threads, returned layouts live as long as the cache.
+class LayoutCache {
+public:
+    explicit LayoutCache(const vk::Device& device);
+    ~LayoutCache();
+
+    LayoutCache(const LayoutCache&) = delete;
+    LayoutCache& operator=(const LayoutCache&) = delete;
+
+    // bindings of the same slot are merged across stages, their stage masks are or'ed
+    const PipelineLayout& get(std::span<const ShaderReflection> stages);
+    VkDescriptorSetLayout getSetLayout(std::span<const VkDescriptorSetLayoutBinding> bindings);
+
+    inline size_t getSetLayoutCount() const { return m_setLayouts.size(); }
+    inline size_t getPipelineLayoutCount() const { return m_pipelineLayouts.size(); }
+
+private:
+    // binding, type, count, stages
+    using SetKey = std::vector<std::array<uint32_t, 4>>;
+    // set layouts, then stages, offset, size of every push constant range
+    using PipelineKey = std::pair<std::vector<VkDescriptorSetLayout>, std::vector<std::array<uint32_t, 3>>>;
+
+    const vk::Device& m_device;
+
+    std::recursive_mutex m_mutex;  // get() takes it again through getSetLayout()
+    std::map<SetKey, VkDescriptorSetLayout> m_setLayouts;
+    std::map<PipelineKey, std::unique_ptr<PipelineLayout>> m_pipelineLayouts;
+
+private:
+    static std::vector<VkPushConstantRange> _mergePushConstants(std::span<const ShaderReflection> stages);
+};
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "shader/pipeline_variants.h"
+
+namespace eng {
+
+PipelineVariants::PipelineVariants(const vk::Device& device, Builder builder)
+    : m_device(device), m_builder(std::move(builder)) {
+}
+
+PipelineVariants::~PipelineVariants() {
+    for (auto& [constants, pipeline] : m_variants) {
+        vkDestroyPipeline(m_device.get(), pipeline, nullptr);
+    }
+}
+
+VkPipeline PipelineVariants::get(const SpecializationConstants& constants) {
+    auto it = m_variants.find(constants);
+    if (it != m_variants.end()) {
+        return it->second;
+    }
+
+    VkPipeline pipeline = m_builder(constants);
+    m_variants.emplace(constants, pipeline);
+    return pipeline;
+}
+
+std::vector<SpecializationConstants> PipelineVariants::getKeys() const {
+    std::vector<SpecializationConstants> keys;
+    keys.reserve(m_variants.size());
+    for (const auto& [constants, pipeline] : m_variants) {
+        keys.push_back(constants);
+    }
+    return keys;
+}
+
+PipelineVariants::Variants PipelineVariants::build(const std::vector<SpecializationConstants>& keys) const {
+    Variants variants;
+    try {
+        for (const SpecializationConstants& constants : keys) {
+            variants.emplace_back(constants, m_builder(constants));
+        }
+    } catch (...) {
+        // all or nothing, a half reloaded set of variants would mix shader versions
+        for (auto& [constants, pipeline] : variants) {
+            vkDestroyPipeline(m_device.get(), pipeline, nullptr);
+        }
+        throw;
+    }
+    return variants;
+}
+
+std::vector<VkPipeline> PipelineVariants::replace(Variants&& variants) {
+    std::vector<VkPipeline> retired;
+    for (auto& [constants, pipeline] : variants) {
+        auto it = m_variants.find(constants);
+        if (it != m_variants.end()) {
+            retired.push_back(it->second);
+            it->second = pipeline;
+        } else {
+            m_variants.emplace(std::move(constants), pipeline);
+        }
+    }
+    return retired;
+}
+
+}  // namespace eng
\ No newline at end of file
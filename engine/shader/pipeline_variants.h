@@ -0,0 +1,41 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include "shared.h"
+#include "shader/specialization_constants.h"
+#include "wrapper/vk/device.h"
+
+namespace eng {
+
+// specialized variants of one pipeline, built on first use. branches on specialization
+// constants are folded by the driver, so features toggled this way cost nothing at runtime.
+class PipelineVariants {
+public:
+    using Builder = std::function<VkPipeline(const SpecializationConstants&)>;
+    using Variants = std::vector<std::pair<SpecializationConstants, VkPipeline>>;
+
+    PipelineVariants(const vk::Device& device, Builder builder);
+    ~PipelineVariants();
+
+    PipelineVariants(const PipelineVariants&) = delete;
+    PipelineVariants& operator=(const PipelineVariants&) = delete;
+
+    VkPipeline get(const SpecializationConstants& constants);
+
+    // rebuilding every variant in use, eg. after a shader reload. build() only reads the
+    // builder so it may run on another thread, replace() returns the pipelines to retire.
+    std::vector<SpecializationConstants> getKeys() const;
+    Variants build(const std::vector<SpecializationConstants>& keys) const;
+    std::vector<VkPipeline> replace(Variants&& variants);
+
+    inline size_t size() const { return m_variants.size(); }
+
+private:
+    const vk::Device& m_device;
+    Builder m_builder;
+
+    std::unordered_map<SpecializationConstants, VkPipeline, SpecializationConstants::Hash> m_variants;
+};
+
+}  // namespace eng
\ No newline at end of file
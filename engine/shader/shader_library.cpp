@@ -0,0 +1,42 @@
+#include "shader/shader_library.h"
+
+#include "shader/embedded_shaders.h"
+
+namespace eng {
+
+ShaderLibrary::ShaderLibrary(const AssetStore& assets, bool preferFiles)
+    : m_assets(assets), m_preferFiles(preferFiles) {
+}
+
+Asset ShaderLibrary::load(const std::string& name) const {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_overrides.find(name);
+        if (it != m_overrides.end()) {
+            return Asset(std::vector<char>(it->second));
+        }
+    }
+
+    std::span<const uint32_t> embedded = findEmbeddedShader(name);
+
+    // straight from the loose file, a pack holds the code compiled when it was built
+    if (m_preferFiles) {
+        try {
+            return Asset(help::readResource(name));
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << ", using the " << (embedded.empty() ? "packed" : "embedded") << " shader" << std::endl;
+        }
+    }
+
+    if (embedded.empty()) {
+        return m_assets.load(name);
+    }
+    return Asset(std::span<const char>(reinterpret_cast<const char*>(embedded.data()), embedded.size_bytes()));
+}
+
+void ShaderLibrary::setOverride(const std::string& name, std::vector<char>&& code) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_overrides[name] = std::move(code);
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include "shared.h"
+#include "resource/asset_store.h"
+
+namespace eng {
+
+// hands out spir-v for pipeline creation. embedded shaders need no file access,
+// with preferFiles set the compiled loose files win, even over an asset pack, so
+// shaders can be iterated on without rebuilding. without embedded shaders the asset
+// store provides them. code handed to setOverride, eg. by the hot reload, beats
+// everything. safe to call from several threads.
+class ShaderLibrary {
+public:
+    explicit ShaderLibrary(const AssetStore& assets, bool preferFiles = false);
+
+    Asset load(const std::string& name) const;
+    void setOverride(const std::string& name, std::vector<char>&& code);
+
+    inline bool isPreferringFiles() const { return m_preferFiles; }
+
+private:
+    const AssetStore& m_assets;
+    bool m_preferFiles;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::vector<char>> m_overrides;
+};
+
+}  // namespace eng
\ No newline at end of file
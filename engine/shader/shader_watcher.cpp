@@ -0,0 +1,129 @@
+#include "shader/shader_watcher.h"
+
+#include <filesystem>
+#include <utility>
+
+#ifdef __linux__
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+#ifndef ENGINE_GLSLC
+    #define ENGINE_GLSLC "glslc"
+#endif
+
+namespace eng {
+
+namespace {
+
+constexpr const char* SOURCE_DIR = "shaders/";
+constexpr const char* BINARY_DIR = "shaders/bin/";
+
+bool _isShaderSource(const std::filesystem::path& file) {
+    return file.extension() == ".vert" || file.extension() == ".frag" || file.extension() == ".comp";
+}
+
+}  // namespace
+
+ShaderWatcher::ShaderWatcher(ShaderLibrary& shaders)
+    : m_shaders(shaders) {
+#ifdef __linux__
+    std::string directory = std::string(RESOURCE_DIR) + SOURCE_DIR;
+
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0) {
+        throw std::runtime_error("failed to initialize inotify!");
+    }
+    // saving through a temporary file and renaming it over the source shows up as a move
+    if (inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(m_inotify);
+        throw std::runtime_error("failed to watch shader directory: " + directory);
+    }
+
+    m_thread = std::thread(&ShaderWatcher::_run, this);
+    std::cout << "watching " << directory << " for shader changes" << std::endl;
+#else
+    std::cerr << "shader hot reload needs inotify, it is disabled on this platform" << std::endl;
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    m_stop = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+#ifdef __linux__
+    if (m_inotify >= 0) {
+        close(m_inotify);
+    }
+#endif
+}
+
+std::vector<std::string> ShaderWatcher::poll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::exchange(m_changed, {});
+}
+
+void ShaderWatcher::_run() {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    pollfd descriptor{.fd = m_inotify, .events = POLLIN};
+
+    while (!m_stop) {
+        if (::poll(&descriptor, 1, m_POLL_TIMEOUT_MS) <= 0) {
+            continue;
+        }
+
+        // drain the burst of events a save produces, then compile every file once
+        std::set<std::string> files;
+        do {
+            ssize_t length;
+            while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0) {
+                for (char* it = buffer; it < buffer + length;) {
+                    const inotify_event* event = reinterpret_cast<const inotify_event*>(it);
+                    if (event->len > 0 && _isShaderSource(event->name)) {
+                        files.insert(event->name);
+                    }
+                    it += sizeof(inotify_event) + event->len;
+                }
+            }
+        } while (::poll(&descriptor, 1, m_SETTLE_MS) > 0);
+
+        for (const std::string& file : files) {
+            _compile(file);
+        }
+    }
+#endif
+}
+
+// compiles next to what compile.bat produces, so the file override sees the same spir-v
+void ShaderWatcher::_compile(const std::string& file) {
+    std::filesystem::path source(file);
+    std::string name = std::string(BINARY_DIR) + source.stem().string() + "_" + source.extension().string().substr(1) + ".spv";
+
+    std::string sourcePath = std::string(RESOURCE_DIR) + SOURCE_DIR + file;
+    std::string outputPath = std::string(RESOURCE_DIR) + name;
+    std::filesystem::create_directories(std::filesystem::path(outputPath).parent_path());
+
+    std::string command = "\"" ENGINE_GLSLC "\" -o \"" + outputPath + "\" \"" + sourcePath + "\"";
+    if (std::system(command.c_str()) != 0) {
+        // glslc already printed the errors, keep running with the previous code
+        std::cerr << "failed to compile shader: " << file << std::endl;
+        return;
+    }
+
+    try {
+        m_shaders.setOverride(name, help::readResource(name));
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return;
+    }
+
+    std::cout << "recompiled shader: " << file << std::endl;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_changed.push_back(name);
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "shared.h"
+#include "shader/shader_library.h"
+
+namespace eng {
+
+// recompiles the glsl sources under RESOURCE_DIR/shaders when they change on disk and
+// hands the new spir-v to the shader library. compiling happens on a background thread,
+// poll() tells the renderer which pipelines to rebuild. needs inotify, elsewhere it stays idle.
+class ShaderWatcher {
+public:
+    explicit ShaderWatcher(ShaderLibrary& shaders);
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // names of the shaders recompiled since the last call, eg. "shaders/bin/default_vert.spv"
+    std::vector<std::string> poll();
+
+    inline bool isWatching() const { return m_thread.joinable(); }
+
+private:
+    ShaderLibrary& m_shaders;
+    int m_inotify = -1;
+
+    std::thread m_thread;
+    std::atomic<bool> m_stop = false;
+
+    std::mutex m_mutex;
+    std::vector<std::string> m_changed;
+
+    static constexpr int m_POLL_TIMEOUT_MS = 100;
+    static constexpr int m_SETTLE_MS = 50;  // editors tend to save in several writes
+
+private:
+    void _run();
+    void _compile(const std::string& file);
+};
+
+}  // namespace eng
\ No newline at end of file
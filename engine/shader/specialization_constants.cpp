@@ -0,0 +1,45 @@
+#include "shader/specialization_constants.h"
+
+namespace eng {
+
+VkSpecializationInfo SpecializationConstants::getInfo() const {
+    return VkSpecializationInfo{
+        .mapEntryCount = static_cast<uint32_t>(m_entries.size()),
+        .pMapEntries = m_entries.data(),
+        .dataSize = m_data.size() * sizeof(uint32_t),
+        .pData = m_data.data()};
+}
+
+bool SpecializationConstants::operator==(const SpecializationConstants& other) const {
+    return m_ids == other.m_ids && m_data == other.m_data;
+}
+
+size_t SpecializationConstants::Hash::operator()(const SpecializationConstants& constants) const {
+    size_t seed = constants.m_ids.size();
+    for (size_t i = 0; i < constants.m_ids.size(); i++) {
+        seed ^= std::hash<uint32_t>{}(constants.m_ids[i]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed ^= std::hash<uint32_t>{}(constants.m_data[i]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+}
+
+void SpecializationConstants::_set(uint32_t id, uint32_t bits) {
+    auto it = std::lower_bound(m_ids.begin(), m_ids.end(), id);
+    size_t index = it - m_ids.begin();
+
+    if (it != m_ids.end() && *it == id) {
+        m_data[index] = bits;
+        return;
+    }
+
+    m_ids.insert(it, id);
+    m_data.insert(m_data.begin() + index, bits);
+
+    // entries follow the data layout, offsets shift for everything behind the new constant
+    m_entries.resize(m_ids.size());
+    for (size_t i = 0; i < m_ids.size(); i++) {
+        m_entries[i] = {m_ids[i], static_cast<uint32_t>(i * sizeof(uint32_t)), sizeof(uint32_t)};
+    }
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+#include "shared.h"
+
+namespace eng {
+
+// values of specialization constants by constant id. used as a key for pipeline
+// variants and turned into the VkSpecializationInfo of their shader stages.
+class SpecializationConstants {
+public:
+    // bools become VkBool32, every other type must be 4 bytes like int, uint and float
+    template <typename T>
+    SpecializationConstants& set(uint32_t id, T value) {
+        static_assert(std::is_same_v<T, bool> || (sizeof(T) == sizeof(uint32_t) && std::is_trivially_copyable_v<T>),
+                      "specialization constants must be bool or 4 bytes wide");
+
+        uint32_t bits;
+        if constexpr (std::is_same_v<T, bool>) {
+            bits = value ? VK_TRUE : VK_FALSE;
+        } else {
+            std::memcpy(&bits, &value, sizeof(bits));
+        }
+        _set(id, bits);
+        return *this;
+    }
+
+    // points into this object, valid as long as it is neither changed nor destroyed
+    VkSpecializationInfo getInfo() const;
+
+    inline bool empty() const { return m_ids.empty(); }
+
+    bool operator==(const SpecializationConstants& other) const;
+
+    struct Hash {
+        size_t operator()(const SpecializationConstants& constants) const;
+    };
+
+private:
+    std::vector<uint32_t> m_ids;  // sorted, so equal sets compare equal whatever the order of set()
+    std::vector<uint32_t> m_data;
+    std::vector<VkSpecializationMapEntry> m_entries;
+
+private:
+    void _set(uint32_t id, uint32_t bits);
+};
+
+}  // namespace eng
\ No newline at end of file
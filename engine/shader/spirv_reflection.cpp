@@ -0,0 +1,407 @@
+#include "shader/spirv_reflection.h"
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+constexpr uint32_t SPIRV_HEADER_WORDS = 5;
+
+// the subset of the spir-v grammar the reflection reads
+enum Op : uint32_t {
+    OpEntryPoint = 15,
+    OpTypeBool = 20,
+    OpTypeInt = 21,
+    OpTypeFloat = 22,
+    OpTypeVector = 23,
+    OpTypeMatrix = 24,
+    OpTypeImage = 25,
+    OpTypeSampler = 26,
+    OpTypeSampledImage = 27,
+    OpTypeArray = 28,
+    OpTypeRuntimeArray = 29,
+    OpTypeStruct = 30,
+    OpTypePointer = 32,
+    OpConstant = 43,
+    OpSpecConstant = 50,
+    OpVariable = 59,
+    OpDecorate = 71,
+    OpMemberDecorate = 72,
+};
+
+enum Decoration : uint32_t {
+    DecorationBlock = 2,
+    DecorationBufferBlock = 3,
+    DecorationArrayStride = 6,
+    DecorationMatrixStride = 7,
+    DecorationBuiltIn = 11,
+    DecorationLocation = 30,
+    DecorationBinding = 33,
+    DecorationDescriptorSet = 34,
+    DecorationOffset = 35,
+};
+
+enum StorageClass : uint32_t {
+    StorageClassUniformConstant = 0,
+    StorageClassInput = 1,
+    StorageClassUniform = 2,
+    StorageClassPushConstant = 9,
+    StorageClassStorageBuffer = 12,
+};
+
+enum Dim : uint32_t {
+    DimBuffer = 5,
+    DimSubpassData = 6,
+};
+
+struct Id {
+    uint32_t opcode = 0;
+    std::vector<uint32_t> operands;  // the instruction words after the result id
+
+    // decorations
+    std::optional<uint32_t> set;
+    std::optional<uint32_t> binding;
+    std::optional<uint32_t> location;
+    std::optional<uint32_t> arrayStride;
+    bool isBlock = false;
+    bool isBufferBlock = false;
+    bool isBuiltIn = false;
+
+    std::vector<uint32_t> memberOffsets;
+    std::vector<uint32_t> memberMatrixStrides;
+};
+
+class Module {
+public:
+    explicit Module(std::span<const uint32_t> code) {
+        if (code.size() < SPIRV_HEADER_WORDS || code[0] != SPIRV_MAGIC) {
+            throw std::runtime_error("invalid spir-v module!");
+        }
+        m_ids.resize(code[3]);  // id bound
+
+        for (size_t i = SPIRV_HEADER_WORDS; i < code.size();) {
+            uint32_t wordCount = code[i] >> 16;
+            uint32_t opcode = code[i] & 0xffff;
+            if (wordCount == 0 || i + wordCount > code.size()) {
+                throw std::runtime_error("truncated spir-v instruction!");
+            }
+
+            _parseInstruction(opcode, code.subspan(i + 1, wordCount - 1));
+            i += wordCount;
+        }
+    }
+
+    inline const Id& get(uint32_t id) const { return m_ids.at(id); }
+    inline const std::vector<uint32_t>& getVariables() const { return m_variables; }
+    inline uint32_t getExecutionModel() const { return m_executionModel.value(); }
+    inline bool hasEntryPoint() const { return m_executionModel.has_value(); }
+
+    // strips arrays from a type, multiplying their lengths into count
+    uint32_t getElementType(uint32_t type, uint32_t& count) const {
+        count = 1;
+        while (get(type).opcode == OpTypeArray || get(type).opcode == OpTypeRuntimeArray) {
+            const Id& array = get(type);
+            // runtime arrays are sized by the application, reserve a single descriptor
+            if (array.opcode == OpTypeArray) {
+                count *= getConstant(array.operands[1]);
+            }
+            type = array.operands[0];
+        }
+        return type;
+    }
+
+    uint32_t getConstant(uint32_t id) const {
+        const Id& constant = get(id);
+        if (constant.opcode != OpConstant && constant.opcode != OpSpecConstant) {
+            throw std::runtime_error("spir-v array length is not a constant!");
+        }
+        return constant.operands[2];  // operands: result type, result, value. the low word is enough for any length
+    }
+
+    // bytes a type occupies inside an explicitly laid out block
+    uint32_t getSize(uint32_t type, uint32_t matrixStride = 0) const {
+        const Id& id = get(type);
+        switch (id.opcode) {
+            case OpTypeBool:
+                return 4;
+            case OpTypeInt:
+            case OpTypeFloat:
+                return id.operands[0] / 8;
+            case OpTypeVector:
+                return getSize(id.operands[0]) * id.operands[1];
+            case OpTypeMatrix:
+                // column major, column count times the stride of a column
+                return (matrixStride ? matrixStride : getSize(id.operands[0])) * id.operands[1];
+            case OpTypeArray:
+                return (id.arrayStride ? *id.arrayStride : getSize(id.operands[0])) * getConstant(id.operands[1]);
+            case OpTypeRuntimeArray:
+                return 0;
+            case OpTypeStruct: {
+                uint32_t size = 0;
+                for (size_t i = 0; i < id.operands.size(); i++) {
+                    uint32_t offset = i < id.memberOffsets.size() ? id.memberOffsets[i] : 0;
+                    uint32_t stride = i < id.memberMatrixStrides.size() ? id.memberMatrixStrides[i] : 0;
+                    size = std::max(size, offset + getSize(id.operands[i], stride));
+                }
+                return size;
+            }
+            default:
+                throw std::runtime_error("unsupported spir-v type in block!");
+        }
+    }
+
+    // the lowest member offset, push constant blocks of later stages often start past 0
+    uint32_t getFirstOffset(uint32_t type) const {
+        const Id& id = get(type);
+        if (id.memberOffsets.empty()) {
+            return 0;
+        }
+        return *std::min_element(id.memberOffsets.begin(), id.memberOffsets.end());
+    }
+
+private:
+    std::vector<Id> m_ids;
+    std::vector<uint32_t> m_variables;
+    std::optional<uint32_t> m_executionModel;
+
+private:
+    void _parseInstruction(uint32_t opcode, std::span<const uint32_t> words) {
+        switch (opcode) {
+            case OpEntryPoint:
+                if (m_executionModel) {
+                    throw std::runtime_error("spir-v modules with several entry points are not supported!");
+                }
+                m_executionModel = words[0];
+                break;
+            case OpDecorate:
+                _decorate(m_ids.at(words[0]), words[1], words.size() > 2 ? words[2] : 0);
+                break;
+            case OpMemberDecorate: {
+                Id& id = m_ids.at(words[0]);
+                uint32_t member = words[1];
+                if (words[2] == DecorationOffset) {
+                    _setMember(id.memberOffsets, member, words[3]);
+                } else if (words[2] == DecorationMatrixStride) {
+                    _setMember(id.memberMatrixStrides, member, words[3]);
+                } else if (words[2] == DecorationBuiltIn) {
+                    id.isBuiltIn = true;
+                }
+                break;
+            }
+            case OpTypeBool:
+            case OpTypeInt:
+            case OpTypeFloat:
+            case OpTypeVector:
+            case OpTypeMatrix:
+            case OpTypeImage:
+            case OpTypeSampler:
+            case OpTypeSampledImage:
+            case OpTypeArray:
+            case OpTypeRuntimeArray:
+            case OpTypeStruct:
+            case OpTypePointer:
+                _define(words[0], opcode, words.subspan(1));
+                break;
+            case OpConstant:
+            case OpSpecConstant:
+                _define(words[1], opcode, words);  // keeps the result type in front of the value
+                break;
+            case OpVariable:
+                _define(words[1], opcode, words);
+                m_variables.push_back(words[1]);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void _define(uint32_t result, uint32_t opcode, std::span<const uint32_t> operands) {
+        Id& id = m_ids.at(result);
+        id.opcode = opcode;
+        id.operands.assign(operands.begin(), operands.end());
+    }
+
+    static void _decorate(Id& id, uint32_t decoration, uint32_t value) {
+        switch (decoration) {
+            case DecorationBlock: id.isBlock = true; break;
+            case DecorationBufferBlock: id.isBufferBlock = true; break;
+            case DecorationArrayStride: id.arrayStride = value; break;
+            case DecorationBuiltIn: id.isBuiltIn = true; break;
+            case DecorationLocation: id.location = value; break;
+            case DecorationBinding: id.binding = value; break;
+            case DecorationDescriptorSet: id.set = value; break;
+            default: break;
+        }
+    }
+
+    static void _setMember(std::vector<uint32_t>& values, uint32_t member, uint32_t value) {
+        if (values.size() <= member) {
+            values.resize(member + 1, 0);
+        }
+        values[member] = value;
+    }
+};
+
+VkShaderStageFlagBits _getStage(uint32_t executionModel) {
+    switch (executionModel) {
+        case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+        case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+        case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+        case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+        default: throw std::runtime_error("unsupported spir-v execution model!");
+    }
+}
+
+VkDescriptorType _getDescriptorType(const Module& module, uint32_t storageClass, uint32_t type) {
+    const Id& id = module.get(type);
+
+    if (storageClass == StorageClassStorageBuffer) {
+        return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    }
+    if (storageClass == StorageClassUniform) {
+        // glsl before 4.3 style storage buffers are uniform BufferBlocks
+        return id.isBufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    }
+
+    switch (id.opcode) {
+        case OpTypeSampler:
+            return VK_DESCRIPTOR_TYPE_SAMPLER;
+        case OpTypeSampledImage:
+            return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        case OpTypeImage: {
+            // operands: sampled type, dim, depth, arrayed, ms, sampled, format
+            uint32_t dim = id.operands[1];
+            bool isStorage = id.operands[5] == 2;
+            if (dim == DimSubpassData) {
+                return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            }
+            if (dim == DimBuffer) {
+                return isStorage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+            }
+            return isStorage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+        }
+        default:
+            throw std::runtime_error("unsupported spir-v resource type!");
+    }
+}
+
+VkFormat _getVertexFormat(const Module& module, uint32_t type) {
+    const Id& id = module.get(type);
+    uint32_t componentCount = 1;
+    const Id* component = &id;
+    if (id.opcode == OpTypeVector) {
+        component = &module.get(id.operands[0]);
+        componentCount = id.operands[1];
+    }
+
+    static constexpr VkFormat FLOAT32_FORMATS[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+    static constexpr VkFormat FLOAT16_FORMATS[] = {VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT};
+    static constexpr VkFormat SINT32_FORMATS[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+    static constexpr VkFormat UINT32_FORMATS[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+
+    uint32_t width = component->operands[0];
+    if (component->opcode == OpTypeFloat && width == 32) {
+        return FLOAT32_FORMATS[componentCount - 1];
+    }
+    if (component->opcode == OpTypeFloat && width == 16) {
+        return FLOAT16_FORMATS[componentCount - 1];
+    }
+    if (component->opcode == OpTypeInt && width == 32) {
+        return component->operands[1] ? SINT32_FORMATS[componentCount - 1] : UINT32_FORMATS[componentCount - 1];
+    }
+    throw std::runtime_error("unsupported vertex input type!");
+}
+
+void _reflectVertexInput(const Module& module, const Id& variable, uint32_t type, ShaderReflection& reflection) {
+    const Id& id = module.get(type);
+    if (variable.isBuiltIn || id.isBuiltIn || !variable.location) {
+        return;
+    }
+
+    // matrices take one location per column
+    if (id.opcode == OpTypeMatrix) {
+        for (uint32_t i = 0; i < id.operands[1]; i++) {
+            reflection.vertexInputs.push_back({*variable.location + i, _getVertexFormat(module, id.operands[0])});
+        }
+        return;
+    }
+
+    reflection.vertexInputs.push_back({*variable.location, _getVertexFormat(module, type)});
+}
+
+}  // namespace
+
+ShaderReflection reflectShader(std::span<const uint32_t> code) {
+    Module module(code);
+    if (!module.hasEntryPoint()) {
+        throw std::runtime_error("spir-v module has no entry point!");
+    }
+
+    ShaderReflection reflection;
+    reflection.stage = _getStage(module.getExecutionModel());
+
+    for (uint32_t variableId : module.getVariables()) {
+        const Id& variable = module.get(variableId);
+        const Id& pointer = module.get(variable.operands[0]);
+        uint32_t storageClass = variable.operands[2];
+        uint32_t type = pointer.operands[1];
+
+        switch (storageClass) {
+            case StorageClassUniformConstant:
+            case StorageClassUniform:
+            case StorageClassStorageBuffer: {
+                ReflectedBinding binding;
+                binding.set = variable.set.value_or(0);
+                binding.binding = variable.binding.value_or(0);
+                binding.type = _getDescriptorType(module, storageClass, module.getElementType(type, binding.count));
+                binding.stages = reflection.stage;
+                reflection.bindings.push_back(binding);
+                break;
+            }
+            case StorageClassPushConstant: {
+                uint32_t offset = module.getFirstOffset(type);
+                uint32_t size = module.getSize(type) - offset;
+                reflection.pushConstants.push_back({static_cast<VkShaderStageFlags>(reflection.stage), offset, size});
+                break;
+            }
+            case StorageClassInput:
+                if (reflection.stage == VK_SHADER_STAGE_VERTEX_BIT) {
+                    _reflectVertexInput(module, variable, type, reflection);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::sort(reflection.bindings.begin(), reflection.bindings.end(), [](const ReflectedBinding& a, const ReflectedBinding& b) {
+        return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+    });
+    std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(), [](const ReflectedVertexInput& a, const ReflectedVertexInput& b) {
+        return a.location < b.location;
+    });
+
+    return reflection;
+}
+
+ShaderReflection reflectShader(std::span<const char> code) {
+    if (code.size() % sizeof(uint32_t) != 0) {
+        throw std::runtime_error("spir-v size is not a multiple of 4!");
+    }
+    return reflectShader(std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(code.data()), code.size() / sizeof(uint32_t)));
+}
+
+void validateVertexInputs(const ShaderReflection& reflection, std::span<const VkVertexInputAttributeDescription> attributes) {
+    for (const ReflectedVertexInput& input : reflection.vertexInputs) {
+        bool found = std::any_of(attributes.begin(), attributes.end(), [&](const VkVertexInputAttributeDescription& attribute) {
+            return attribute.location == input.location;
+        });
+        if (!found) {
+            throw std::runtime_error("vertex input location " + std::to_string(input.location) + " is not provided by the vertex layout!");
+        }
+    }
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <span>
+#include "shared.h"
+
+namespace eng {
+
+struct ReflectedBinding {
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+    uint32_t count = 1;
+    VkShaderStageFlags stages = 0;
+};
+
+struct ReflectedVertexInput {
+    uint32_t location = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;  // the type the shader reads, not necessarily the stored one
+};
+
+struct ShaderReflection {
+    VkShaderStageFlagBits stage = VK_SHADER_STAGE_ALL;
+    std::vector<ReflectedBinding> bindings;        // sorted by set and binding
+    std::vector<VkPushConstantRange> pushConstants;  // bytes the stage actually declares
+    std::vector<ReflectedVertexInput> vertexInputs;  // vertex stage only, sorted by location
+};
+
+// extracts the resource interface of a spir-v module with a single entry point
+ShaderReflection reflectShader(std::span<const uint32_t> code);
+ShaderReflection reflectShader(std::span<const char> code);
+
+// throws if the vertex stage reads a location the attributes do not provide
+void validateVertexInputs(const ShaderReflection& reflection, std::span<const VkVertexInputAttributeDescription> attributes);
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include "texture/bc_decoder.h"
+
+#include <cstring>
+#include <utility>
+
+namespace eng {
+
+namespace {
+
+// bc7 partition layouts, for two subsets a bit per texel, for three subsets a subset per texel
+const uint16_t BC7_PARTITIONS_2[64] = {
+    0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+    0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+    0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+    0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+    0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+    0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+    0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+    0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22};
+
+const uint8_t BC7_PARTITIONS_3[64][16] = {
+    {0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 1, 2, 2, 2, 2}, {0, 0, 0, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 2, 0, 0, 1, 2, 2, 1, 1, 2, 2, 1, 1}, {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 1, 0, 1, 1, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2}, {0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 2, 2},
+    {0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1}, {0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2}, {0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2},
+    {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2},
+    {0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2}, {0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2},
+    {0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2, 1, 2, 2, 2}, {0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0},
+    {0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2}, {0, 1, 1, 1, 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0},
+    {0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2}, {0, 0, 2, 2, 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1},
+    {0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2, 0, 2, 2, 2}, {0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2}, {0, 0, 0, 0, 1, 1, 0, 0, 2, 2, 1, 0, 2, 2, 1, 0},
+    {0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1, 0, 0, 0, 0}, {0, 0, 1, 2, 0, 0, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2},
+    {0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1, 0, 1, 1, 0}, {0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1},
+    {0, 0, 2, 2, 1, 1, 0, 2, 1, 1, 0, 2, 0, 0, 2, 2}, {0, 1, 1, 0, 0, 1, 1, 0, 2, 0, 0, 2, 2, 2, 2, 2},
+    {0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1}, {0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 1, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 2, 2, 2}, {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 2, 0, 0, 1, 1},
+    {0, 0, 1, 1, 0, 0, 1, 2, 0, 0, 2, 2, 0, 2, 2, 2}, {0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0},
+    {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0}, {0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0},
+    {0, 1, 2, 0, 2, 0, 1, 2, 1, 2, 0, 1, 0, 1, 2, 0}, {0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2, 0, 0, 1, 1},
+    {0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1}, {0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2},
+    {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1}, {0, 0, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2, 1, 1, 2, 2},
+    {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 1, 1}, {0, 2, 2, 0, 1, 2, 2, 1, 0, 2, 2, 0, 1, 2, 2, 1},
+    {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 0, 1, 0, 1}, {0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1},
+    {0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2}, {0, 2, 2, 2, 0, 1, 1, 1, 0, 2, 2, 2, 0, 1, 1, 1},
+    {0, 0, 0, 2, 1, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 2}, {0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2},
+    {0, 2, 2, 2, 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2}, {0, 0, 0, 2, 1, 1, 1, 2, 1, 1, 1, 2, 0, 0, 0, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2}, {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2},
+    {0, 0, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2},
+    {0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 1}, {0, 2, 2, 2, 1, 2, 2, 2, 0, 2, 2, 2, 1, 2, 2, 2},
+    {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 1, 1, 1, 2, 0, 1, 1, 2, 2, 0, 1, 2, 2, 2, 0}};
+
+// texel whose index drops its top bit, per partition and subset
+const uint8_t BC7_ANCHORS_2[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+    15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+    6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15};
+
+const uint8_t BC7_ANCHORS_3_SECOND[64] = {
+    3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+    3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+    8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+    3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3};
+
+const uint8_t BC7_ANCHORS_3_THIRD[64] = {
+    15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+    15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+    15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+    15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8};
+
+const uint8_t BC7_WEIGHTS_2[4] = {0, 21, 43, 64};
+const uint8_t BC7_WEIGHTS_3[8] = {0, 9, 18, 27, 37, 46, 55, 64};
+const uint8_t BC7_WEIGHTS_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct BC7Mode {
+    uint8_t subsets;
+    uint8_t partitionBits;
+    uint8_t rotationBits;
+    uint8_t indexSelectionBits;
+    uint8_t colorBits;
+    uint8_t alphaBits;
+    uint8_t endpointPBits;
+    uint8_t sharedPBits;
+    uint8_t indexBits;
+    uint8_t secondaryIndexBits;
+};
+
+const BC7Mode BC7_MODES[8] = {
+    {3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+    {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+    {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+    {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+    {1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+    {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+    {1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+    {2, 6, 0, 0, 5, 5, 1, 0, 2, 0}};
+
+class BitReader {
+public:
+    explicit BitReader(const uint8_t* data) : m_data(data) {}
+
+    uint32_t read(uint32_t count) {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < count; i++, m_position++) {
+            value |= ((m_data[m_position >> 3] >> (m_position & 7)) & 1u) << i;
+        }
+        return value;
+    }
+
+private:
+    const uint8_t* m_data;
+    uint32_t m_position = 0;
+};
+
+void _expand565(uint16_t color, uint8_t* rgb) {
+    uint8_t r = (color >> 11) & 0x1f;
+    uint8_t g = (color >> 5) & 0x3f;
+    uint8_t b = color & 0x1f;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+void _decodeColorBlock(const uint8_t* block, uint8_t* rgba, bool allowPunchThrough) {
+    uint16_t c0 = block[0] | (block[1] << 8);
+    uint16_t c1 = block[2] | (block[3] << 8);
+    uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+
+    uint8_t palette[4][4];
+    _expand565(c0, palette[0]);
+    _expand565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+    if (c0 > c1 || !allowPunchThrough) {
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c] + 1) / 3);
+            palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c] + 1) / 3);
+        }
+    } else {
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+            palette[3][c] = 0;
+        }
+        palette[3][3] = 0;
+    }
+
+    for (int i = 0; i < 16; i++) {
+        memcpy(rgba + i * 4, palette[(indices >> (i * 2)) & 3], 4);
+    }
+}
+
+uint8_t _unquantize(uint32_t value, uint32_t bits) {
+    value <<= 8 - bits;
+    return static_cast<uint8_t>(value | (value >> bits));
+}
+
+uint8_t _interpolate(uint8_t e0, uint8_t e1, uint32_t index, uint32_t indexBits) {
+    const uint8_t* weights = indexBits == 2 ? BC7_WEIGHTS_2 : indexBits == 3 ? BC7_WEIGHTS_3 : BC7_WEIGHTS_4;
+    return static_cast<uint8_t>(((64 - weights[index]) * e0 + weights[index] * e1 + 32) >> 6);
+}
+
+uint32_t _subsetOf(const BC7Mode& mode, uint32_t partition, uint32_t texel) {
+    if (mode.subsets == 2) {
+        return (BC7_PARTITIONS_2[partition] >> texel) & 1;
+    }
+    if (mode.subsets == 3) {
+        return BC7_PARTITIONS_3[partition][texel];
+    }
+    return 0;
+}
+
+bool _isAnchor(const BC7Mode& mode, uint32_t partition, uint32_t texel) {
+    if (texel == 0) {
+        return true;
+    }
+    if (mode.subsets == 2) {
+        return texel == BC7_ANCHORS_2[partition];
+    }
+    if (mode.subsets == 3) {
+        return texel == BC7_ANCHORS_3_SECOND[partition] || texel == BC7_ANCHORS_3_THIRD[partition];
+    }
+    return false;
+}
+
+}  // namespace
+
+void decodeBC1Block(const uint8_t* block, uint8_t* rgba, bool hasAlpha) {
+    _decodeColorBlock(block, rgba, true);
+
+    if (!hasAlpha) {
+        for (int i = 0; i < 16; i++) {
+            rgba[i * 4 + 3] = 255;
+        }
+    }
+}
+
+void decodeBC3Block(const uint8_t* block, uint8_t* rgba) {
+    _decodeColorBlock(block + 8, rgba, false);
+
+    uint8_t a0 = block[0];
+    uint8_t a1 = block[1];
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; i++) {
+        indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+    }
+
+    uint8_t palette[8] = {a0, a1};
+    if (a0 > a1) {
+        for (int i = 1; i < 7; i++) {
+            palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1 + 3) / 7);
+        }
+    } else {
+        for (int i = 1; i < 5; i++) {
+            palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1 + 2) / 5);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    for (int i = 0; i < 16; i++) {
+        rgba[i * 4 + 3] = palette[(indices >> (i * 3)) & 7];
+    }
+}
+
+void decodeBC7Block(const uint8_t* block, uint8_t* rgba) {
+    uint32_t modeIndex = 0;
+    while (modeIndex < 8 && !(block[0] & (1 << modeIndex))) {
+        modeIndex++;
+    }
+
+    // reserved mode, decodes to transparent black
+    if (modeIndex == 8) {
+        memset(rgba, 0, 64);
+        return;
+    }
+
+    const BC7Mode& mode = BC7_MODES[modeIndex];
+    BitReader bits(block);
+    bits.read(modeIndex + 1);
+
+    uint32_t partition = bits.read(mode.partitionBits);
+    uint32_t rotation = bits.read(mode.rotationBits);
+    uint32_t indexSelection = bits.read(mode.indexSelectionBits);
+
+    uint32_t endpointCount = mode.subsets * 2;
+    uint8_t endpoints[6][4] = {};
+    uint32_t raw[6][4] = {};
+
+    for (uint32_t c = 0; c < 3; c++) {
+        for (uint32_t e = 0; e < endpointCount; e++) {
+            raw[e][c] = bits.read(mode.colorBits);
+        }
+    }
+    for (uint32_t e = 0; e < endpointCount && mode.alphaBits > 0; e++) {
+        raw[e][3] = bits.read(mode.alphaBits);
+    }
+
+    uint32_t colorBits = mode.colorBits;
+    uint32_t alphaBits = mode.alphaBits;
+    if (mode.endpointPBits || mode.sharedPBits) {
+        uint32_t pBits[6];
+        if (mode.endpointPBits) {
+            for (uint32_t e = 0; e < endpointCount; e++) {
+                pBits[e] = bits.read(1);
+            }
+        } else {
+            for (uint32_t s = 0; s < mode.subsets; s++) {
+                pBits[s * 2] = pBits[s * 2 + 1] = bits.read(1);
+            }
+        }
+
+        for (uint32_t e = 0; e < endpointCount; e++) {
+            for (uint32_t c = 0; c < 4; c++) {
+                raw[e][c] = (raw[e][c] << 1) | pBits[e];
+            }
+        }
+        colorBits++;
+        if (alphaBits > 0) {
+            alphaBits++;
+        }
+    }
+
+    for (uint32_t e = 0; e < endpointCount; e++) {
+        for (uint32_t c = 0; c < 3; c++) {
+            endpoints[e][c] = _unquantize(raw[e][c], colorBits);
+        }
+        endpoints[e][3] = alphaBits > 0 ? _unquantize(raw[e][3], alphaBits) : 255;
+    }
+
+    uint32_t primary[16];
+    for (uint32_t i = 0; i < 16; i++) {
+        primary[i] = bits.read(_isAnchor(mode, partition, i) ? mode.indexBits - 1 : mode.indexBits);
+    }
+
+    uint32_t secondary[16] = {};
+    if (mode.secondaryIndexBits > 0) {
+        for (uint32_t i = 0; i < 16; i++) {
+            secondary[i] = bits.read(i == 0 ? mode.secondaryIndexBits - 1 : mode.secondaryIndexBits);
+        }
+    }
+
+    for (uint32_t i = 0; i < 16; i++) {
+        uint32_t subset = _subsetOf(mode, partition, i);
+        const uint8_t* e0 = endpoints[subset * 2];
+        const uint8_t* e1 = endpoints[subset * 2 + 1];
+        uint8_t* texel = rgba + i * 4;
+
+        if (mode.secondaryIndexBits > 0) {
+            // mode 4 and 5 index color and alpha separately, mode 4 can swap the index sets
+            uint32_t colorIndex = indexSelection ? secondary[i] : primary[i];
+            uint32_t colorIndexBits = indexSelection ? mode.secondaryIndexBits : mode.indexBits;
+            uint32_t alphaIndex = indexSelection ? primary[i] : secondary[i];
+            uint32_t alphaIndexBits = indexSelection ? mode.indexBits : mode.secondaryIndexBits;
+
+            for (uint32_t c = 0; c < 3; c++) {
+                texel[c] = _interpolate(e0[c], e1[c], colorIndex, colorIndexBits);
+            }
+            texel[3] = _interpolate(e0[3], e1[3], alphaIndex, alphaIndexBits);
+        } else {
+            for (uint32_t c = 0; c < 4; c++) {
+                texel[c] = _interpolate(e0[c], e1[c], primary[i], mode.indexBits);
+            }
+        }
+
+        if (rotation > 0) {
+            std::swap(texel[3], texel[rotation - 1]);
+        }
+    }
+}
+
+}  // namespace eng
\ No newline at end of file
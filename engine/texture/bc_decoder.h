@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace eng {
+
+// cpu decoders for block compressed formats, used when the device can not sample them.
+// each call decodes one 4x4 block into 16 rgba8 texels in row major order.
+
+void decodeBC1Block(const uint8_t* block, uint8_t* rgba, bool hasAlpha);
+void decodeBC3Block(const uint8_t* block, uint8_t* rgba);
+void decodeBC7Block(const uint8_t* block, uint8_t* rgba);
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "texture/ktx2.h"
+
+#include <cstring>
+#include "texture/texture_format.h"
+
+namespace eng {
+
+namespace {
+
+const uint8_t KTX2_IDENTIFIER[12] = {0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n'};
+
+struct Ktx2Header {
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    // followed by the 64 bit supercompression global data offset and length, unused without supercompression
+};
+
+struct Ktx2LevelIndex {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+constexpr size_t LEVEL_INDEX_OFFSET = sizeof(KTX2_IDENTIFIER) + sizeof(Ktx2Header) + 2 * sizeof(uint64_t);
+
+static_assert(sizeof(Ktx2Header) == 52, "ktx2 header must be tightly packed");
+static_assert(sizeof(Ktx2LevelIndex) == 24, "ktx2 level index must be tightly packed");
+
+}  // namespace
+
+Ktx2Image parseKtx2(std::span<const char> file) {
+    if (file.size() < LEVEL_INDEX_OFFSET || memcmp(file.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        throw std::runtime_error("invalid ktx2 file!");
+    }
+
+    Ktx2Header header;
+    memcpy(&header, file.data() + sizeof(KTX2_IDENTIFIER), sizeof(header));
+
+    if (header.vkFormat == VK_FORMAT_UNDEFINED || header.supercompressionScheme != 0) {
+        throw std::runtime_error("ktx2 basis universal and supercompressed payloads are not supported!");
+    }
+    if (header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || header.pixelHeight == 0) {
+        throw std::runtime_error("only 2d ktx2 textures with a single layer are supported!");
+    }
+
+    VkFormat format = static_cast<VkFormat>(header.vkFormat);
+    std::optional<FormatInfo> info = getFormatInfo(format);
+    if (!info) {
+        throw std::runtime_error("unsupported ktx2 format: " + std::to_string(header.vkFormat));
+    }
+
+    Ktx2Image image{
+        .format = format,
+        .width = header.pixelWidth,
+        .height = header.pixelHeight,
+        .needsMips = header.levelCount == 0};
+
+    uint32_t levelCount = std::max(header.levelCount, 1u);
+    if (levelCount > 32 || file.size() < LEVEL_INDEX_OFFSET + levelCount * sizeof(Ktx2LevelIndex)) {
+        throw std::runtime_error("invalid ktx2 level index!");
+    }
+
+    image.levels.reserve(levelCount);
+    for (uint32_t level = 0; level < levelCount; level++) {
+        Ktx2LevelIndex index;
+        memcpy(&index, file.data() + LEVEL_INDEX_OFFSET + level * sizeof(Ktx2LevelIndex), sizeof(index));
+
+        uint32_t width = std::max(image.width >> level, 1u);
+        uint32_t height = std::max(image.height >> level, 1u);
+        if (index.byteLength != getLevelSize(*info, width, height) || index.byteOffset > file.size() || index.byteLength > file.size() - index.byteOffset) {
+            throw std::runtime_error("invalid ktx2 level " + std::to_string(level) + "!");
+        }
+
+        image.levels.push_back({.offset = static_cast<size_t>(index.byteOffset), .size = static_cast<size_t>(index.byteLength)});
+    }
+
+    return image;
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <span>
+#include "shared.h"
+
+namespace eng {
+
+struct Ktx2Level {
+    size_t offset;  // into the file
+    size_t size;
+};
+
+// 2d, single layer ktx2 container without supercompression
+struct Ktx2Image {
+    VkFormat format;
+    uint32_t width;
+    uint32_t height;
+    std::vector<Ktx2Level> levels;  // level 0 first
+    bool needsMips;                 // the file asked for the chain to be generated at load time
+};
+
+Ktx2Image parseKtx2(std::span<const char> file);
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,362 @@
+#include "texture/mip_generator.h"
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t WORKGROUP_SIZE = 8;
+
+}  // namespace
+
+MipGenerator::MipGenerator(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, SamplerCache& samplerCache, uint32_t frameCount)
+    : m_device(device), m_physicalDevice(physicalDevice), m_shaders(shaders), m_layoutCache(layoutCache), m_samplerCache(samplerCache), m_frames(frameCount) {
+}
+
+MipGenerator::~MipGenerator() {
+    for (uint32_t i = 0; i < m_frames.size(); i++) {
+        retireFrame(i);
+        for (VkDescriptorPool pool : m_frames[i].descriptorPools) {
+            vkDestroyDescriptorPool(m_device.get(), pool, nullptr);
+        }
+    }
+
+    for (VkPipeline pipeline : m_pipelines) {
+        if (pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(m_device.get(), pipeline, nullptr);
+        }
+    }
+}
+
+uint32_t MipGenerator::getMipLevelCount(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+        levels++;
+    }
+    return levels;
+}
+
+MipMode MipGenerator::getMode(VkFormat format) {
+    auto it = m_modes.find(format);
+    if (it != m_modes.end()) {
+        return it->second;
+    }
+
+    VkFormatFeatureFlags features = m_physicalDevice.getFormatProperties(format).optimalTilingFeatures;
+    VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    VkFormatFeatureFlags storageFeatures = m_physicalDevice.getFormatProperties(_getStorageFormat(format)).optimalTilingFeatures;
+
+    MipMode mode = MipMode::None;
+    if ((features & blitFeatures) == blitFeatures) {
+        mode = MipMode::Blit;
+    } else if ((features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) && (storageFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) {
+        mode = MipMode::Compute;
+    }
+
+    m_modes[format] = mode;
+    return mode;
+}
+
+VkImageUsageFlags MipGenerator::getRequiredUsage(VkFormat format) {
+    switch (getMode(format)) {
+        case MipMode::Blit:
+            return VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        case MipMode::Compute:
+            return VK_IMAGE_USAGE_STORAGE_BIT;
+        default:
+            return 0;
+    }
+}
+
+VkImageCreateFlags MipGenerator::getRequiredFlags(VkFormat format) {
+    // the storage view of an srgb image uses its unorm alias, the image itself carries a
+    // storage usage its srgb format does not support
+    if (getMode(format) == MipMode::Compute && _getStorageFormat(format) != format) {
+        return VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+    }
+    return 0;
+}
+
+void MipGenerator::generate(const vk::CommandBuffer& cmd, const vk::Image& image, uint32_t frameIndex) {
+    if (image.getMipLevels() > 1) {
+        switch (getMode(image.getFormat())) {
+            case MipMode::Blit:
+                _generateBlit(cmd, image);
+                return;
+            case MipMode::Compute:
+                _generateCompute(cmd, image, frameIndex);
+                return;
+            default:
+                throw std::runtime_error("image format does not support mip generation!");
+        }
+    }
+
+    cmd.transitionImageLayout(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+}
+
+void MipGenerator::retireFrame(uint32_t frameIndex) {
+    FrameResources& frame = m_frames[frameIndex];
+
+    for (VkImageView view : frame.views) {
+        vkDestroyImageView(m_device.get(), view, nullptr);
+    }
+    frame.views.clear();
+
+    for (uint32_t i = 0; i < frame.descriptorPools.size() && i <= frame.poolIndex; i++) {
+        vkResetDescriptorPool(m_device.get(), frame.descriptorPools[i], 0);
+    }
+    frame.poolIndex = 0;
+    frame.setCount = 0;
+}
+
+void MipGenerator::_generateBlit(const vk::CommandBuffer& cmd, const vk::Image& image) {
+    int32_t width = static_cast<int32_t>(image.getExtent().width);
+    int32_t height = static_cast<int32_t>(image.getExtent().height);
+
+    for (uint32_t level = 1; level < image.getMipLevels(); level++) {
+        cmd.transitionImageLayout(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                                  level - 1, 1);
+
+        int32_t nextWidth = std::max(width / 2, 1);
+        int32_t nextHeight = std::max(height / 2, 1);
+
+        VkImageBlit blit{
+            .srcSubresource = {
+                .aspectMask = image.getAspectMask(),
+                .mipLevel = level - 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1},
+            .srcOffsets = {{0, 0, 0}, {width, height, 1}},
+            .dstSubresource = {
+                .aspectMask = image.getAspectMask(),
+                .mipLevel = level,
+                .baseArrayLayer = 0,
+                .layerCount = 1},
+            .dstOffsets = {{0, 0, 0}, {nextWidth, nextHeight, 1}}};
+        cmd.blitImage(image, image, blit, VK_FILTER_LINEAR);
+
+        cmd.transitionImageLayout(image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                  level - 1, 1);
+
+        width = nextWidth;
+        height = nextHeight;
+    }
+
+    cmd.transitionImageLayout(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                              image.getMipLevels() - 1, 1);
+}
+
+void MipGenerator::_generateCompute(const vk::CommandBuffer& cmd, const vk::Image& image, uint32_t frameIndex) {
+    if (m_pipelineLayout == nullptr) {
+        _createComputePipeline();
+    }
+
+    FrameResources& frame = m_frames[frameIndex];
+    VkFormat storageFormat = _getStorageFormat(image.getFormat());
+
+    VkSamplerCreateInfo samplerInfo = vk::samplerCreateInfo();
+    {
+        samplerInfo.magFilter = VK_FILTER_NEAREST;
+        samplerInfo.minFilter = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    }
+    const vk::Sampler& sampler = m_samplerCache.get(samplerInfo);
+
+    cmd.bindPipeline(m_pipelines[_isSrgb(image.getFormat()) ? 1 : 0], VK_PIPELINE_BIND_POINT_COMPUTE);
+
+    uint32_t width = image.getExtent().width;
+    uint32_t height = image.getExtent().height;
+
+    for (uint32_t level = 1; level < image.getMipLevels(); level++) {
+        cmd.transitionImageLayout(image, level == 1 ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                  level == 1 ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                  level == 1 ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_WRITE_BIT,
+                                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                                  level - 1, 1);
+        cmd.transitionImageLayout(image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                  VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+                                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                                  level, 1);
+
+        VkDescriptorImageInfo srcInfo{
+            .sampler = sampler.get(),
+            .imageView = _createLevelView(image, image.getFormat(), VK_IMAGE_USAGE_SAMPLED_BIT, level - 1, frame),
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        VkDescriptorImageInfo dstInfo{
+            .sampler = VK_NULL_HANDLE,
+            .imageView = _createLevelView(image, storageFormat, VK_IMAGE_USAGE_STORAGE_BIT, level, frame),
+            .imageLayout = VK_IMAGE_LAYOUT_GENERAL};
+
+        VkDescriptorSet descriptorSet = _allocateDescriptorSet(frame);
+
+        std::array<VkWriteDescriptorSet, 2> writes{};
+        {
+            writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[0].dstSet = descriptorSet;
+            writes[0].dstBinding = 0;
+            writes[0].descriptorCount = 1;
+            writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[0].pImageInfo = &srcInfo;
+
+            writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[1].dstSet = descriptorSet;
+            writes[1].dstBinding = 1;
+            writes[1].descriptorCount = 1;
+            writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            writes[1].pImageInfo = &dstInfo;
+        }
+        vkUpdateDescriptorSets(m_device.get(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+        cmd.bindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout->layout, &descriptorSet);
+
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        cmd.dispatch((width + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, (height + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE);
+    }
+
+    uint32_t lastLevel = image.getMipLevels() - 1;
+    cmd.transitionImageLayout(image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                              lastLevel, 1);
+    cmd.transitionImageLayout(image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                              0, lastLevel);
+}
+
+void MipGenerator::_createComputePipeline() {
+    Asset code = m_shaders.load("shaders/bin/mip_downsample_comp.spv");
+    ShaderReflection reflection = reflectShader(code.getSpan());
+    m_pipelineLayout = &m_layoutCache.get({&reflection, 1});
+
+    VkShaderModuleCreateInfo moduleInfo{};
+    moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    moduleInfo.codeSize = code.getSize();
+    moduleInfo.pCode = reinterpret_cast<const uint32_t*>(code.getData());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(m_device.get(), &moduleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create shader module!");
+    }
+
+    for (uint32_t i = 0; i < m_pipelines.size(); i++) {
+        // constant 0 toggles the linear to srgb encode before the unorm storage write
+        SpecializationConstants constants;
+        constants.set(0, i == 1);
+        VkSpecializationInfo specializationInfo = constants.getInfo();
+
+        VkComputePipelineCreateInfo pipelineInfo{
+            .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+                .module = shaderModule,
+                .pName = "main",
+                .pSpecializationInfo = &specializationInfo},
+            .layout = m_pipelineLayout->layout};
+
+        if (vkCreateComputePipelines(m_device.get(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipelines[i]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create mip compute pipeline!");
+        }
+    }
+
+    vkDestroyShaderModule(m_device.get(), shaderModule, nullptr);
+}
+
+VkImageView MipGenerator::_createLevelView(const vk::Image& image, VkFormat format, VkImageUsageFlags usage, uint32_t level, FrameResources& frame) {
+    // only the unorm alias may carry the storage usage
+    VkImageViewUsageCreateInfo usageInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO,
+        .usage = usage};
+
+    VkImageViewCreateInfo viewInfo = vk::imageViewCreateInfo();
+    {
+        viewInfo.pNext = &usageInfo;
+        viewInfo.image = image.get();
+        viewInfo.format = format;
+        viewInfo.subresourceRange.aspectMask = image.getAspectMask();
+        viewInfo.subresourceRange.baseMipLevel = level;
+    }
+
+    VkImageView view;
+    if (vkCreateImageView(m_device.get(), &viewInfo, nullptr, &view) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mip level view!");
+    }
+
+    frame.views.push_back(view);
+    return view;
+}
+
+VkDescriptorSet MipGenerator::_allocateDescriptorSet(FrameResources& frame) {
+    // a burst of large textures may need more sets than one pool holds, grow instead of failing
+    if (frame.setCount == m_SETS_PER_POOL) {
+        frame.poolIndex++;
+        frame.setCount = 0;
+    }
+    if (frame.poolIndex == frame.descriptorPools.size()) {
+        frame.descriptorPools.push_back(_createDescriptorPool());
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    {
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = frame.descriptorPools[frame.poolIndex];
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &m_pipelineLayout->setLayouts[0];
+    }
+
+    VkDescriptorSet descriptorSet;
+    if (vkAllocateDescriptorSets(m_device.get(), &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate mip descriptor set!");
+    }
+
+    frame.setCount++;
+    return descriptorSet;
+}
+
+VkDescriptorPool MipGenerator::_createDescriptorPool() const {
+    std::vector<VkDescriptorPoolSize> poolSizes = m_pipelineLayout->getPoolSizes(0, m_SETS_PER_POOL);
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    {
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = m_SETS_PER_POOL;
+    }
+
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(m_device.get(), &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create mip descriptor pool!");
+    }
+
+    return pool;
+}
+
+VkFormat MipGenerator::_getStorageFormat(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            return VK_FORMAT_B8G8R8A8_UNORM;
+        default:
+            return format;
+    }
+}
+
+bool MipGenerator::_isSrgb(VkFormat format) {
+    return _getStorageFormat(format) != format;
+}
+
+}  // namespace eng
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <unordered_map>
+#include "shared.h"
+#include "shader/layout_cache.h"
+#include "shader/shader_library.h"
+#include "shader/specialization_constants.h"
+#include "texture/sampler_cache.h"
+#include "wrapper/vk/command_buffer.h"
+#include "wrapper/vk/image.h"
+
+namespace eng {
+
+enum class MipMode {
+    None,     // format can neither be blitted nor written from compute
+    Blit,     // vkCmdBlitImage with linear filtering
+    Compute   // 2x2 box filter in a compute pass
+};
+
+// builds mip chains on the gpu. blitting is used whenever the format supports
+// linear filtered blits, otherwise levels are downsampled in a compute pass.
+class MipGenerator {
+public:
+    MipGenerator(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const ShaderLibrary& shaders, LayoutCache& layoutCache, SamplerCache& samplerCache, uint32_t frameCount);
+    ~MipGenerator();
+
+    static uint32_t getMipLevelCount(uint32_t width, uint32_t height);
+
+    MipMode getMode(VkFormat format);
+    // extra usage and create flags an image needs for its mips to be generated
+    VkImageUsageFlags getRequiredUsage(VkFormat format);
+    VkImageCreateFlags getRequiredFlags(VkFormat format);
+
+    // expects every level in TRANSFER_DST_OPTIMAL with level 0 filled,
+    // leaves every level in SHADER_READ_ONLY_OPTIMAL
+    void generate(const vk::CommandBuffer& cmd, const vk::Image& image, uint32_t frameIndex);
+
+    // releases the compute views and descriptor sets of the frame, call after its fence was waited on
+    void retireFrame(uint32_t frameIndex);
+
+private:
+    struct FrameResources {
+        std::vector<VkDescriptorPool> descriptorPools;
+        uint32_t setCount = 0;  // sets allocated from the last pool in use
+        uint32_t poolIndex = 0;
+        std::vector<VkImageView> views;
+    };
+
+    const vk::Device& m_device;
+    const vk::PhysicalDevice& m_physicalDevice;
+    const ShaderLibrary& m_shaders;
+    LayoutCache& m_layoutCache;
+    SamplerCache& m_samplerCache;
+
+    std::unordered_map<VkFormat, MipMode> m_modes;
+
+    // compute fallback, created on first use
+    const PipelineLayout* m_pipelineLayout = nullptr;
+    std::array<VkPipeline, 2> m_pipelines{};  // indexed by whether the destination needs srgb encoding
+    std::vector<FrameResources> m_frames;
+
+    static constexpr uint32_t m_SETS_PER_POOL = 64;
+
+private:
+    void _generateBlit(const vk::CommandBuffer& cmd, const vk::Image& image);
+    void _generateCompute(const vk::CommandBuffer& cmd, const vk::Image& image, uint32_t frameIndex);
+
+    void _createComputePipeline();
+    VkImageView _createLevelView(const vk::Image& image, VkFormat format, VkImageUsageFlags usage, uint32_t level, FrameResources& frame);
+    VkDescriptorSet _allocateDescriptorSet(FrameResources& frame);
+    VkDescriptorPool _createDescriptorPool() const;
+
+    static VkFormat _getStorageFormat(VkFormat format);
+    static bool _isSrgb(VkFormat format);
+};
+
+}  // namespace eng
@@ -0,0 +1,102 @@
+#include "texture/sampler_cache.h"
+
+namespace eng {
+
+namespace {
+
+template <typename T>
+void _hashCombine(size_t& seed, const T& value) {
+    seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+}  // namespace
+
+SamplerCache::SamplerCache(const vk::Device& device, const vk::PhysicalDevice& physicalDevice)
+    : m_device(device), m_physicalDevice(physicalDevice) {
+}
+
+const vk::Sampler& SamplerCache::get(const VkSamplerCreateInfo& samplerInfo) {
+    if (samplerInfo.pNext != nullptr) {
+        throw std::runtime_error("sampler cache does not support extension chains!");
+    }
+
+    Key key{_normalize(samplerInfo)};
+
+    auto it = m_samplers.find(key);
+    if (it != m_samplers.end()) {
+        return *it->second;
+    }
+
+    if (m_samplers.size() >= m_physicalDevice.getProperties().limits.maxSamplerAllocationCount) {
+        throw std::runtime_error("sampler allocation limit reached!");
+    }
+
+    auto sampler = std::make_unique<vk::Sampler>(m_device, key.info);
+    return *m_samplers.emplace(key, std::move(sampler)).first->second;
+}
+
+// folds states the device can not honor so that they share a sampler
+VkSamplerCreateInfo SamplerCache::_normalize(const VkSamplerCreateInfo& samplerInfo) const {
+    VkSamplerCreateInfo info = samplerInfo;
+
+    if (!m_physicalDevice.getFeatures().samplerAnisotropy || info.maxAnisotropy <= 1.0f) {
+        info.anisotropyEnable = VK_FALSE;
+    }
+    if (info.anisotropyEnable) {
+        info.maxAnisotropy = std::min(info.maxAnisotropy, m_physicalDevice.getProperties().limits.maxSamplerAnisotropy);
+    } else {
+        info.maxAnisotropy = 1.0f;
+    }
+
+    if (!info.compareEnable) {
+        info.compareOp = VK_COMPARE_OP_ALWAYS;
+    }
+
+    return info;
+}
+
+bool SamplerCache::Key::operator==(const Key& other) const {
+    const VkSamplerCreateInfo& a = info;
+    const VkSamplerCreateInfo& b = other.info;
+    return a.flags == b.flags &&
+           a.magFilter == b.magFilter &&
+           a.minFilter == b.minFilter &&
+           a.mipmapMode == b.mipmapMode &&
+           a.addressModeU == b.addressModeU &&
+           a.addressModeV == b.addressModeV &&
+           a.addressModeW == b.addressModeW &&
+           a.mipLodBias == b.mipLodBias &&
+           a.anisotropyEnable == b.anisotropyEnable &&
+           a.maxAnisotropy == b.maxAnisotropy &&
+           a.compareEnable == b.compareEnable &&
+           a.compareOp == b.compareOp &&
+           a.minLod == b.minLod &&
+           a.maxLod == b.maxLod &&
+           a.borderColor == b.borderColor &&
+           a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+}
+
+size_t SamplerCache::KeyHash::operator()(const Key& key) const {
+    const VkSamplerCreateInfo& info = key.info;
+
+    size_t seed = 0;
+    _hashCombine(seed, info.flags);
+    _hashCombine(seed, info.magFilter);
+    _hashCombine(seed, info.minFilter);
+    _hashCombine(seed, info.mipmapMode);
+    _hashCombine(seed, info.addressModeU);
+    _hashCombine(seed, info.addressModeV);
+    _hashCombine(seed, info.addressModeW);
+    _hashCombine(seed, info.mipLodBias);
+    _hashCombine(seed, info.anisotropyEnable);
+    _hashCombine(seed, info.maxAnisotropy);
+    _hashCombine(seed, info.compareEnable);
+    _hashCombine(seed, info.compareOp);
+    _hashCombine(seed, info.minLod);
+    _hashCombine(seed, info.maxLod);
+    _hashCombine(seed, info.borderColor);
+    _hashCombine(seed, info.unnormalizedCoordinates);
+    return seed;
+}
+
+}  // namespace eng
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include "shared.h"
+#include "wrapper/vk/device.h"
+#include "wrapper/vk/physical_device.h"
+#include "wrapper/vk/sampler.h"
+
+namespace eng {
+
+// dedupes samplers by their create info. every texture asks for its sampler
+// here, so the sampler count stays bound by the distinct states in use and far
+// below maxSamplerAllocationCount.
+class SamplerCache {
+public:
+    SamplerCache(const vk::Device& device, const vk::PhysicalDevice& physicalDevice);
+
+    const vk::Sampler& get(const VkSamplerCreateInfo& samplerInfo);
+    inline size_t size() const { return m_samplers.size(); }
+
+private:
+    struct Key {
+        VkSamplerCreateInfo info;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    const vk::Device& m_device;
+    const vk::PhysicalDevice& m_physicalDevice;
+
+    std::unordered_map<Key, std::unique_ptr<vk::Sampler>, KeyHash> m_samplers;
+
+private:
+    VkSamplerCreateInfo _normalize(const VkSamplerCreateInfo& samplerInfo) const;
+};
+
+}  // namespace eng
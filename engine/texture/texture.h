@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include "shared.h"
+#include "wrapper/vk/image.h"
+
+namespace eng {
+
+typedef uint32_t TextureHandle;
+
+enum class TextureState {
+    Pending,
+    Resident,
+    Evicted,  // dropped to stay within the memory budget, streamed back in when used
+    Failed
+};
+
+struct Texture {
+    std::string path;
+    TextureState state = TextureState::Pending;
+    std::unique_ptr<vk::Image> image;  // null until the upload was recorded
+
+    uint64_t lastUsedFrame = 0;
+    uint32_t droppedLevels = 0;   // top mip levels given up to stay within the memory budget
+    VkDeviceSize fullSize = 0;    // memory of the complete chain, estimated while levels are dropped
+    bool isStreaming = false;     // a load is queued or being decoded
+};
+
+struct TextureStats {
+    uint32_t requested = 0;
+    uint32_t decoded = 0;
+    uint32_t uploaded = 0;
+    uint32_t failed = 0;
+    uint32_t transcoded = 0;         // decoded on the cpu because the device can not sample the format
+    uint32_t transcodeCacheHits = 0;
+
+    uint64_t decodedBytes = 0;
+    uint64_t uploadedBytes = 0;
+    double decodeSeconds = 0.0;  // summed over all workers
+
+    uint64_t residentBytes = 0;  // device memory of resident textures
+    uint64_t rgba8Bytes = 0;     // what the same mip chains would take as rgba8
+
+    uint32_t evicted = 0;
+    uint32_t droppedLevels = 0;
+    uint32_t restored = 0;
+};
+
+}  // namespace eng
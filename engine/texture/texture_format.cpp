@@ -0,0 +1,90 @@
+#include "texture/texture_format.h"
+
+#include <cstring>
+#include "texture/bc_decoder.h"
+
+namespace eng {
+
+std::optional<FormatInfo> getFormatInfo(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            return FormatInfo{1, 1, 4, false};
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            return FormatInfo{4, 4, 8, true};
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return FormatInfo{4, 4, 16, true};
+        default:
+            return std::nullopt;
+    }
+}
+
+VkDeviceSize getLevelSize(const FormatInfo& info, uint32_t width, uint32_t height) {
+    VkDeviceSize blocksX = (width + info.blockWidth - 1) / info.blockWidth;
+    VkDeviceSize blocksY = (height + info.blockHeight - 1) / info.blockHeight;
+    return blocksX * blocksY * info.blockBytes;
+}
+
+VkFormat getDecodedFormat(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return VK_FORMAT_R8G8B8A8_SRGB;
+        default:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+void decodeLevel(VkFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba) {
+    std::optional<FormatInfo> info = getFormatInfo(format);
+    if (!info || !info->isCompressed) {
+        throw std::runtime_error("failed to decode texture level, format is not block compressed!");
+    }
+
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    uint8_t texels[16 * 4];
+
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            const uint8_t* block = blocks + (static_cast<size_t>(by) * blocksX + bx) * info->blockBytes;
+
+            switch (format) {
+                case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                    decodeBC1Block(block, texels, false);
+                    break;
+                case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                    decodeBC1Block(block, texels, true);
+                    break;
+                case VK_FORMAT_BC3_UNORM_BLOCK:
+                case VK_FORMAT_BC3_SRGB_BLOCK:
+                    decodeBC3Block(block, texels);
+                    break;
+                default:
+                    decodeBC7Block(block, texels);
+                    break;
+            }
+
+            // edge blocks of levels that are not a multiple of 4 are cropped
+            uint32_t copyWidth = std::min(4u, width - bx * 4);
+            uint32_t copyHeight = std::min(4u, height - by * 4);
+            for (uint32_t y = 0; y < copyHeight; y++) {
+                uint8_t* row = rgba + ((static_cast<size_t>(by) * 4 + y) * width + bx * 4) * 4;
+                memcpy(row, texels + y * 16, copyWidth * 4);
+            }
+        }
+    }
+}
+
+}  // namespace eng
\ No newline at end of file
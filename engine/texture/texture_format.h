@@ -0,0 +1,24 @@
+#pragma once
+
+#include "shared.h"
+
+namespace eng {
+
+struct FormatInfo {
+    uint32_t blockWidth;
+    uint32_t blockHeight;
+    uint32_t blockBytes;
+    bool isCompressed;
+};
+
+// formats the texture pipeline understands, empty for anything else
+std::optional<FormatInfo> getFormatInfo(VkFormat format);
+VkDeviceSize getLevelSize(const FormatInfo& info, uint32_t width, uint32_t height);
+
+// rgba8 format a block compressed format decodes to, keeps the srgb-ness
+VkFormat getDecodedFormat(VkFormat format);
+
+// decodes one level of a block compressed format into tightly packed rgba8 texels
+void decodeLevel(VkFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba);
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,630 @@
+#include "texture/texture_manager.h"
+
+#include "texture/texture_format.h"
+
+namespace eng {
+
+namespace {
+
+constexpr VkDeviceSize STAGING_RING_SIZE = 64 * 1024 * 1024;
+constexpr double MIB = 1024.0 * 1024.0;
+constexpr VkDeviceSize LEVEL_ALIGNMENT = 16;  // multiple of every block size and of 4
+
+// formats a texture may arrive in, kept when the device can sample them
+constexpr VkFormat CANDIDATE_FORMATS[] = {
+    VK_FORMAT_R8G8B8A8_UNORM,
+    VK_FORMAT_R8G8B8A8_SRGB,
+    VK_FORMAT_BC1_RGB_UNORM_BLOCK,
+    VK_FORMAT_BC1_RGB_SRGB_BLOCK,
+    VK_FORMAT_BC1_RGBA_UNORM_BLOCK,
+    VK_FORMAT_BC1_RGBA_SRGB_BLOCK,
+    VK_FORMAT_BC3_UNORM_BLOCK,
+    VK_FORMAT_BC3_SRGB_BLOCK,
+    VK_FORMAT_BC7_UNORM_BLOCK,
+    VK_FORMAT_BC7_SRGB_BLOCK};
+
+VkDeviceSize _alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+VkExtent3D _getLevelExtent(const VkExtent3D& extent, uint32_t level) {
+    return {std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u), 1};
+}
+
+}  // namespace
+
+TextureManager::TextureManager(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const AssetStore& assets, const ShaderLibrary& shaders, LayoutCache& layoutCache, ResidencyManager& residencyManager, SamplerCache& samplerCache, uint32_t frameCount, uint32_t workerCount)
+    : m_device(device),
+      m_physicalDevice(physicalDevice),
+      m_assets(assets),
+      m_residencyManager(residencyManager),
+      m_stagingRing(device, physicalDevice, STAGING_RING_SIZE, frameCount),
+      m_mipGenerator(device, physicalDevice, shaders, layoutCache, samplerCache, frameCount),
+      m_transcodeCache("cache/textures/"),
+      m_retiredImages(frameCount) {
+    VkSamplerCreateInfo samplerInfo = vk::samplerCreateInfo();
+    {
+        samplerInfo.anisotropyEnable = VK_TRUE;
+        samplerInfo.maxAnisotropy = 16.0f;
+    }
+    m_sampler = &samplerCache.get(samplerInfo);
+
+    _querySampledFormats();
+
+    // 2x2 magenta/grey checker, uploaded with the first frame
+    m_placeholderPixels = {
+        255, 0, 255, 255, 64, 64, 64, 255,
+        64, 64, 64, 255, 255, 0, 255, 255};
+    m_placeholder = _createTextureImage(VK_FORMAT_R8G8B8A8_SRGB, 2, 2, 1, true);
+
+    if (workerCount == 0) {
+        workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    }
+
+    m_workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++) {
+        m_workers.emplace_back(&TextureManager::_workerLoop, this);
+    }
+}
+
+TextureManager::~TextureManager() {
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_isStopping = true;
+    }
+    m_jobCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+TextureHandle TextureManager::load(const std::string& filename) {
+    TextureHandle handle = static_cast<TextureHandle>(m_textures.size());
+    m_textures.push_back({.path = filename});
+
+    if (m_inFlight == 0) {
+        m_batchStart = std::chrono::steady_clock::now();
+        m_batchStartStats = m_stats;
+    }
+    m_stats.requested++;
+
+    m_textures[handle].lastUsedFrame = m_residencyManager.getFrame();
+    _queueLoad(handle);
+
+    return handle;
+}
+
+void TextureManager::markUsed(TextureHandle handle) {
+    m_textures[handle].lastUsedFrame = m_residencyManager.getFrame();
+}
+
+void TextureManager::update(const vk::CommandBuffer& cmd, uint32_t frameIndex) {
+    m_stagingRing.retireFrame(frameIndex);
+    m_mipGenerator.retireFrame(frameIndex);
+
+    for (const auto& image : m_retiredImages[frameIndex]) {
+        m_retiredBytes -= image->getMemorySize();
+    }
+    m_retiredImages[frameIndex].clear();
+
+    if (!m_placeholderPixels.empty()) {
+        std::vector<Ktx2Level> levels = {{.offset = 0, .size = m_placeholderPixels.size()}};
+        std::optional<std::vector<VkDeviceSize>> offsets = _stage(m_placeholderPixels.data(), levels);
+        if (!offsets) {
+            throw std::runtime_error("failed to stage placeholder texture!");
+        }
+        _recordUpload(cmd, *m_placeholder, *offsets, true, frameIndex);
+        m_placeholderPixels.clear();
+    }
+
+    // another process may have taken memory, get back within budget before uploading more
+    _makeRoom(cmd, 0, frameIndex);
+    _restoreUsed();
+
+    VkDeviceSize budget = m_frameUploadBudget;
+    while (budget > 0) {
+        DecodedImage decoded;
+        {
+            std::lock_guard<std::mutex> lock(m_decodedMutex);
+            if (m_decoded.empty()) {
+                break;
+            }
+            decoded = std::move(m_decoded.front());
+            m_decoded.pop_front();
+        }
+
+        Texture& texture = m_textures[decoded.handle];
+        VkDeviceSize size = _getStagingSize(decoded.levels);
+
+        if (decoded.levels.empty() || size > m_stagingRing.getSize()) {
+            if (!decoded.levels.empty()) {
+                std::cerr << "texture does not fit into the staging ring: " << texture.path << std::endl;
+            }
+            // a failed restore keeps whatever levels are still resident
+            if (!texture.image) {
+                texture.state = TextureState::Failed;
+                m_stats.failed++;
+            }
+            texture.isStreaming = false;
+            m_inFlight--;
+            continue;
+        }
+
+        // the first upload of a frame may exceed the budget, anything else waits for the next frame
+        if (size > budget && budget != m_frameUploadBudget) {
+            std::lock_guard<std::mutex> lock(m_decodedMutex);
+            m_decoded.push_front(std::move(decoded));
+            break;
+        }
+
+        VkDeviceSize residentSize = decoded.generateMips ? size + size / 3 : size;
+        if (!_makeRoom(cmd, residentSize, frameIndex)) {
+            // evicting was not enough, leave out top levels the file brought along
+            while (decoded.levels.size() > 1 && _getAvailable() < residentSize) {
+                decoded.levels.erase(decoded.levels.begin());
+                decoded.width = std::max(decoded.width >> 1, 1u);
+                decoded.height = std::max(decoded.height >> 1, 1u);
+                decoded.droppedLevels++;
+                size = _getStagingSize(decoded.levels);
+                residentSize = size;
+            }
+        }
+
+        std::optional<std::vector<VkDeviceSize>> offsets = _stage(decoded.getData(), decoded.levels);
+        if (!offsets) {
+            std::lock_guard<std::mutex> lock(m_decodedMutex);
+            m_decoded.push_front(std::move(decoded));
+            break;
+        }
+
+        std::unique_ptr<vk::Image> image;
+        try {
+            uint32_t levelCount = static_cast<uint32_t>(decoded.levels.size());
+            image = _createTextureImage(decoded.format, decoded.width, decoded.height, levelCount, decoded.generateMips);
+        } catch (const std::runtime_error& e) {
+            // out of device memory, tried again once the texture is used and there is room
+            std::cerr << e.what() << " " << texture.path << std::endl;
+            if (!texture.image) {
+                texture.state = TextureState::Evicted;
+            }
+            texture.isStreaming = false;
+            m_inFlight--;
+            continue;
+        }
+        _recordUpload(cmd, *image, *offsets, decoded.generateMips, frameIndex);
+
+        if (texture.fullSize != 0) {
+            m_stats.restored++;
+        }
+        if (texture.image) {
+            _retireImage(texture, frameIndex);
+        }
+        texture.image = std::move(image);
+        texture.state = TextureState::Resident;
+        texture.droppedLevels = decoded.droppedLevels;
+        texture.fullSize = texture.image->getMemorySize() << (2 * decoded.droppedLevels);
+        texture.isStreaming = false;
+        m_version++;
+        m_inFlight--;
+
+        m_stats.decoded++;
+        m_stats.uploaded++;
+        m_stats.decodeSeconds += decoded.decodeSeconds;
+        m_stats.decodedBytes += size;
+        m_stats.uploadedBytes += size;
+        m_stats.residentBytes += texture.image->getMemorySize();
+        m_stats.rgba8Bytes += _getRgba8Size(*texture.image);
+        m_stats.transcoded += decoded.isTranscoded ? 1 : 0;
+        m_stats.transcodeCacheHits += decoded.isCacheHit ? 1 : 0;
+
+        budget = size > budget ? 0 : budget - size;
+    }
+
+    m_stagingRing.endFrame(frameIndex);
+
+    if (m_inFlight == 0 && m_stats.requested != m_batchStartStats.requested) {
+        _reportBatch();
+        m_batchStartStats = m_stats;
+    }
+}
+
+const uint8_t* TextureManager::DecodedImage::getData() const {
+    if (pixels) {
+        return pixels.get();
+    }
+
+    return storage.empty() ? reinterpret_cast<const uint8_t*>(file.getData()) : storage.data();
+}
+
+const vk::Image& TextureManager::getImage(TextureHandle handle) const {
+    const Texture& texture = m_textures[handle];
+    return texture.image ? *texture.image : *m_placeholder;
+}
+
+void TextureManager::_queueLoad(TextureHandle handle) {
+    m_textures[handle].isStreaming = true;
+    m_inFlight++;
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_jobs.emplace_back(handle, m_textures[handle].path);
+    }
+    m_jobCondition.notify_one();
+}
+
+void TextureManager::_workerLoop() {
+    while (true) {
+        std::pair<TextureHandle, std::string> job;
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobCondition.wait(lock, [this] { return m_isStopping || !m_jobs.empty(); });
+            if (m_isStopping) {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        DecodedImage decoded = _decode(job.first, job.second);
+
+        std::lock_guard<std::mutex> lock(m_decodedMutex);
+        m_decoded.push_back(std::move(decoded));
+    }
+}
+
+TextureManager::DecodedImage TextureManager::_decode(TextureHandle handle, const std::string& filename) const {
+    DecodedImage decoded{.handle = handle};
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+        Asset file = m_assets.load(filename);
+
+        if (filename.ends_with(".ktx2")) {
+            _decodeKtx2(decoded, std::move(file));
+        } else {
+            _decodeStb(decoded, file);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "failed to decode texture: " << filename << " (" << e.what() << ")" << std::endl;
+        decoded.levels.clear();
+    }
+
+    decoded.decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return decoded;
+}
+
+void TextureManager::_decodeStb(DecodedImage& decoded, const Asset& file) const {
+    int width, height, channels;
+    decoded.pixels.reset(stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.getData()), static_cast<int>(file.getSize()),
+                                               &width, &height, &channels, STBI_rgb_alpha));
+    if (!decoded.pixels) {
+        throw std::runtime_error(stbi_failure_reason());
+    }
+
+    decoded.width = static_cast<uint32_t>(width);
+    decoded.height = static_cast<uint32_t>(height);
+    decoded.levels = {{.offset = 0, .size = static_cast<size_t>(width) * height * 4}};
+}
+
+void TextureManager::_decodeKtx2(DecodedImage& decoded, Asset&& file) const {
+    Ktx2Image ktx = parseKtx2(file.getSpan());
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(file.getData());
+
+    decoded.width = ktx.width;
+    decoded.height = ktx.height;
+
+    if (m_sampledFormats.contains(ktx.format)) {
+        // block compressed formats can not be blitted, their chain has to come with the file
+        decoded.format = ktx.format;
+        decoded.generateMips = ktx.needsMips && !getFormatInfo(ktx.format)->isCompressed;
+
+        // levels are staged straight from the file, no copy in between
+        decoded.levels = std::move(ktx.levels);
+        decoded.file = std::move(file);
+        return;
+    }
+
+    decoded.format = getDecodedFormat(ktx.format);
+    decoded.generateMips = ktx.needsMips;
+    decoded.isTranscoded = true;
+
+    uint64_t key = TranscodeCache::hash(file.getData(), file.getSize());
+    if (m_transcodeCache.load(key, decoded.storage, decoded.levels) && decoded.levels.size() == ktx.levels.size() &&
+        decoded.levels[0].size == static_cast<size_t>(ktx.width) * ktx.height * 4) {
+        decoded.isCacheHit = true;
+        return;
+    }
+
+    decoded.storage.clear();
+    decoded.levels.clear();
+    for (uint32_t level = 0; level < ktx.levels.size(); level++) {
+        uint32_t width = std::max(ktx.width >> level, 1u);
+        uint32_t height = std::max(ktx.height >> level, 1u);
+        size_t offset = decoded.storage.size();
+
+        decoded.levels.push_back({.offset = offset, .size = static_cast<size_t>(width) * height * 4});
+        decoded.storage.resize(offset + decoded.levels.back().size);
+        decodeLevel(ktx.format, bytes + ktx.levels[level].offset, width, height, decoded.storage.data() + offset);
+    }
+
+    m_transcodeCache.store(key, decoded.storage, decoded.levels);
+}
+
+void TextureManager::_querySampledFormats() {
+    for (VkFormat format : CANDIDATE_FORMATS) {
+        if (getFormatInfo(format)->isCompressed && !m_physicalDevice.getFeatures().textureCompressionBC) {
+            continue;
+        }
+        if (m_physicalDevice.isFormatSupported(format, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
+            m_sampledFormats.insert(format);
+        }
+    }
+}
+
+std::optional<std::vector<VkDeviceSize>> TextureManager::_stage(const uint8_t* data, const std::vector<Ktx2Level>& levels) {
+    std::optional<VkDeviceSize> base = m_stagingRing.allocate(_getStagingSize(levels), LEVEL_ALIGNMENT);
+    if (!base) {
+        return std::nullopt;
+    }
+
+    std::vector<VkDeviceSize> offsets;
+    offsets.reserve(levels.size());
+
+    VkDeviceSize offset = *base;
+    for (const Ktx2Level& level : levels) {
+        m_stagingRing.write(offset, data + level.offset, level.size);
+        offsets.push_back(offset);
+        offset += _alignUp(level.size, LEVEL_ALIGNMENT);
+    }
+
+    return offsets;
+}
+
+void TextureManager::_recordUpload(const vk::CommandBuffer& cmd, const vk::Image& image, const std::vector<VkDeviceSize>& stagingOffsets, bool generateMips, uint32_t frameIndex) {
+    cmd.transitionImageLayout(image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+    for (uint32_t level = 0; level < stagingOffsets.size(); level++) {
+        VkBufferImageCopy region{
+            .bufferOffset = stagingOffsets[level],
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = level,
+                .baseArrayLayer = 0,
+                .layerCount = 1},
+            .imageOffset = {0, 0, 0},
+            .imageExtent = _getLevelExtent(image.getExtent(), level)};
+        cmd.copyBufferToImage(m_stagingRing.getBuffer(), image, region);
+    }
+
+    if (generateMips) {
+        // fills the remaining levels and moves the whole chain to SHADER_READ_ONLY_OPTIMAL
+        m_mipGenerator.generate(cmd, image, frameIndex);
+    } else {
+        cmd.transitionImageLayout(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    }
+}
+
+std::unique_ptr<vk::Image> TextureManager::_createTextureImage(VkFormat format, uint32_t width, uint32_t height, uint32_t levelCount, bool generateMips) {
+    if (generateMips && m_mipGenerator.getMode(format) != MipMode::None) {
+        levelCount = MipGenerator::getMipLevelCount(width, height);
+    }
+
+    VkImageCreateInfo imageInfo = vk::imageCreateInfo();
+    {
+        imageInfo.flags = generateMips ? m_mipGenerator.getRequiredFlags(format) : 0;
+        imageInfo.format = format;
+        imageInfo.extent.width = width;
+        imageInfo.extent.height = height;
+        imageInfo.mipLevels = levelCount;
+        // transfer source to copy the lower levels out when the top level is dropped
+        imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | (generateMips ? m_mipGenerator.getRequiredUsage(format) : 0);
+    }
+
+    return std::make_unique<vk::Image>(m_device, m_physicalDevice, imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+bool TextureManager::_makeRoom(const vk::CommandBuffer& cmd, VkDeviceSize size, uint32_t frameIndex) {
+    uint64_t frame = m_residencyManager.getFrame();
+    uint32_t evicted = m_stats.evicted;
+    uint32_t droppedLevels = m_stats.droppedLevels;
+
+    // size 0 only gets back within budget, memory another process took may have pushed us over it
+    while (_getAvailable() < size || _isOverBudget()) {
+        // least recently used texture holding memory, textures used this frame may only lose levels
+        Texture* victim = nullptr;
+        for (Texture& texture : m_textures) {
+            if (!texture.image || (victim && texture.lastUsedFrame >= victim->lastUsedFrame)) {
+                continue;
+            }
+            if (texture.lastUsedFrame >= frame && !_canDropLevel(*texture.image)) {
+                continue;
+            }
+            victim = &texture;
+        }
+        if (!victim) {
+            break;
+        }
+
+        bool isStale = frame - victim->lastUsedFrame > m_EVICT_AFTER_FRAMES;
+        if (isStale || !_canDropLevel(*victim->image) || !_dropTopLevel(cmd, *victim, frameIndex)) {
+            _evict(*victim, frameIndex);
+        }
+    }
+
+    if (m_stats.evicted != evicted || m_stats.droppedLevels != droppedLevels) {
+        std::cout << "texture budget: evicted " << m_stats.evicted - evicted << " textures, dropped "
+                  << m_stats.droppedLevels - droppedLevels << " mip levels | "
+                  << m_stats.residentBytes / MIB << " MiB resident" << std::endl;
+    }
+
+    return _getAvailable() >= size;
+}
+
+bool TextureManager::_dropTopLevel(const vk::CommandBuffer& cmd, Texture& texture, uint32_t frameIndex) {
+    const vk::Image& source = *texture.image;
+    VkExtent3D extent = _getLevelExtent(source.getExtent(), 1);
+
+    VkImageCreateInfo imageInfo = vk::imageCreateInfo();
+    {
+        imageInfo.format = source.getFormat();
+        imageInfo.extent = extent;
+        imageInfo.mipLevels = source.getMipLevels() - 1;
+        imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    }
+
+    std::unique_ptr<vk::Image> image;
+    try {
+        image = std::make_unique<vk::Image>(m_device, m_physicalDevice, imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+
+    // the remaining levels are copied on the gpu, no need to go back to the file
+    cmd.transitionImageLayout(source, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, 1);
+    cmd.transitionImageLayout(*image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+    for (uint32_t level = 0; level < image->getMipLevels(); level++) {
+        VkImageCopy region{
+            .srcSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = level + 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1},
+            .srcOffset = {0, 0, 0},
+            .dstSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = level,
+                .baseArrayLayer = 0,
+                .layerCount = 1},
+            .dstOffset = {0, 0, 0},
+            .extent = _getLevelExtent(extent, level)};
+        cmd.copyImage(source, *image, region);
+    }
+
+    cmd.transitionImageLayout(*image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+    _retireImage(texture, frameIndex);
+    texture.image = std::move(image);
+    texture.droppedLevels++;
+    m_stats.residentBytes += texture.image->getMemorySize();
+    m_stats.rgba8Bytes += _getRgba8Size(*texture.image);
+    m_stats.droppedLevels++;
+    m_version++;
+
+    return true;
+}
+
+void TextureManager::_evict(Texture& texture, uint32_t frameIndex) {
+    _retireImage(texture, frameIndex);
+    texture.state = TextureState::Evicted;
+    texture.droppedLevels = 0;
+    m_stats.evicted++;
+    m_version++;
+}
+
+// the image may still be read by frames in flight, it is destroyed when this frame index comes around again
+void TextureManager::_retireImage(Texture& texture, uint32_t frameIndex) {
+    m_stats.residentBytes -= texture.image->getMemorySize();
+    m_stats.rgba8Bytes -= _getRgba8Size(*texture.image);
+    m_retiredBytes += texture.image->getMemorySize();
+    m_retiredImages[frameIndex].push_back(std::move(texture.image));
+}
+
+void TextureManager::_restoreUsed() {
+    uint64_t frame = m_residencyManager.getFrame();
+    // headroom keeps a restore from immediately evicting something else
+    VkDeviceSize headroom = m_residencyManager.getHeapBudget(m_residencyManager.getDeviceLocalHeap()).budget / 8;
+
+    for (TextureHandle handle = 0; handle < m_textures.size(); handle++) {
+        Texture& texture = m_textures[handle];
+        bool isReduced = texture.state == TextureState::Evicted || texture.droppedLevels > 0;
+        if (!isReduced || texture.isStreaming || texture.lastUsedFrame < frame) {
+            continue;
+        }
+
+        VkDeviceSize residentSize = texture.image ? texture.image->getMemorySize() : 0;
+        VkDeviceSize missing = texture.fullSize > residentSize ? texture.fullSize - residentSize : 0;
+        if (_getAvailable() < missing + headroom) {
+            continue;
+        }
+
+        if (!texture.image) {
+            texture.state = TextureState::Pending;
+        }
+        _queueLoad(handle);
+        return;  // one per frame, the next is checked once this one is resident
+    }
+}
+
+// frees of retired images already count, they are only waiting on the gpu
+VkDeviceSize TextureManager::_getAvailable() const {
+    uint32_t heap = m_residencyManager.getDeviceLocalHeap();
+    VkDeviceSize budget = m_residencyManager.getHeapBudget(heap).budget;
+    VkDeviceSize usage = m_residencyManager.getUsage(heap);
+    usage = usage > m_retiredBytes ? usage - m_retiredBytes : 0;
+
+    return usage < budget ? budget - usage : 0;
+}
+
+bool TextureManager::_isOverBudget() const {
+    uint32_t heap = m_residencyManager.getDeviceLocalHeap();
+    VkDeviceSize usage = m_residencyManager.getUsage(heap);
+    usage = usage > m_retiredBytes ? usage - m_retiredBytes : 0;
+
+    return usage > m_residencyManager.getHeapBudget(heap).budget;
+}
+
+VkDeviceSize TextureManager::_getStagingSize(const std::vector<Ktx2Level>& levels) {
+    VkDeviceSize size = 0;
+    for (const Ktx2Level& level : levels) {
+        size += _alignUp(level.size, LEVEL_ALIGNMENT);
+    }
+
+    return size;
+}
+
+VkDeviceSize TextureManager::_getRgba8Size(const vk::Image& image) {
+    VkDeviceSize size = 0;
+    for (uint32_t level = 0; level < image.getMipLevels(); level++) {
+        VkExtent3D extent = _getLevelExtent(image.getExtent(), level);
+        size += static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+    }
+
+    return size;
+}
+
+bool TextureManager::_canDropLevel(const vk::Image& image) {
+    return image.getMipLevels() > 1 && std::min(image.getExtent().width, image.getExtent().height) > m_MIN_DROP_SIZE;
+}
+
+void TextureManager::_reportBatch() const {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_batchStart).count();
+    uint32_t uploaded = m_stats.uploaded - m_batchStartStats.uploaded;
+    uint32_t failed = m_stats.failed - m_batchStartStats.failed;
+    double decodedMiB = (m_stats.decodedBytes - m_batchStartStats.decodedBytes) / MIB;
+    double uploadedMiB = (m_stats.uploadedBytes - m_batchStartStats.uploadedBytes) / MIB;
+    double decodeSeconds = m_stats.decodeSeconds - m_batchStartStats.decodeSeconds;
+
+    std::cout << "textures: " << uploaded << " loaded, " << failed << " failed in " << seconds << " s"
+              << " | decode " << (decodeSeconds > 0.0 ? decodedMiB / decodeSeconds : 0.0) << " MiB/s per worker"
+              << " | upload " << (seconds > 0.0 ? uploadedMiB / seconds : 0.0) << " MiB/s" << std::endl;
+    std::cout << "texture memory: " << m_stats.residentBytes / MIB << " MiB resident, "
+              << m_stats.rgba8Bytes / MIB << " MiB as rgba8"
+              << " | " << m_stats.transcoded << " transcoded (" << m_stats.transcodeCacheHits << " from cache)"
+              << " | " << m_stats.evicted << " evicted, " << m_stats.droppedLevels << " levels dropped, " << m_stats.restored << " restored" << std::endl;
+}
+
+}  // namespace eng
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <stb_image.h>
+#include "shared.h"
+#include "resource/asset_store.h"
+#include "resource/residency_manager.h"
+#include "resource/staging_ring.h"
+#include "texture/mip_generator.h"
+#include "texture/ktx2.h"
+#include "texture/sampler_cache.h"
+#include "texture/texture.h"
+#include "texture/transcode_cache.h"
+#include "wrapper/vk/command_buffer.h"
+
+namespace eng {
+
+// decodes textures with stb_image on worker threads and streams them to the gpu
+// through a shared staging ring. until a texture is resident, getImage returns a
+// placeholder so the frame loop never waits on file io or decoding.
+// .ktx2 files upload their block compressed mip chain as is, formats the device
+// can not sample are decoded to rgba8 on the worker and cached on disk.
+// when the device local heap goes over budget, the least recently used textures
+// first lose their top mip levels and are then evicted entirely, textures that
+// are used again are streamed back in once there is room.
+class TextureManager {
+public:
+    TextureManager(const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const AssetStore& assets, const ShaderLibrary& shaders, LayoutCache& layoutCache, ResidencyManager& residencyManager, SamplerCache& samplerCache, uint32_t frameCount, uint32_t workerCount = 0);
+    ~TextureManager();
+
+    TextureHandle load(const std::string& filename);
+    // keeps the texture from being evicted and brings back what was, call for every texture drawn this frame
+    void markUsed(TextureHandle handle);
+
+    // records the uploads that fit into this frame's budget, call after the frame's fence was waited on
+    void update(const vk::CommandBuffer& cmd, uint32_t frameIndex);
+
+    const vk::Image& getImage(TextureHandle handle) const;
+    inline const vk::Sampler& getSampler() const { return *m_sampler; }
+    inline TextureState getState(TextureHandle handle) const { return m_textures[handle].state; }
+    inline const TextureStats& getStats() const { return m_stats; }
+
+    // bumped whenever a texture becomes resident, descriptors referencing textures need a rewrite
+    inline uint32_t getVersion() const { return m_version; }
+
+private:
+    struct DecodedImage {
+        TextureHandle handle;
+        VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<Ktx2Level> levels;  // into getData(), empty if decoding failed
+        bool generateMips = true;
+        uint32_t droppedLevels = 0;  // top levels skipped because they did not fit into the budget
+        bool isTranscoded = false;
+        bool isCacheHit = false;
+
+        // levels point into one of these, checked in order
+        std::unique_ptr<stbi_uc, void (*)(void*)> pixels{nullptr, stbi_image_free};
+        std::vector<uint8_t> storage;  // chains decoded on the cpu
+        Asset file;                    // ktx2 payloads the device samples as is, mapped from the asset pack
+        double decodeSeconds = 0.0;
+
+        const uint8_t* getData() const;
+    };
+
+    const vk::Device& m_device;
+    const vk::PhysicalDevice& m_physicalDevice;
+    const AssetStore& m_assets;
+    ResidencyManager& m_residencyManager;
+
+    StagingRing m_stagingRing;
+    MipGenerator m_mipGenerator;
+    TranscodeCache m_transcodeCache;
+    const vk::Sampler* m_sampler;
+    std::set<VkFormat> m_sampledFormats;  // written once in the constructor, read by the workers
+    std::unique_ptr<vk::Image> m_placeholder;
+    std::vector<uint8_t> m_placeholderPixels;
+
+    std::vector<Texture> m_textures;
+    uint32_t m_version = 0;
+    uint32_t m_inFlight = 0;
+
+    // upload budget per frame, keeps a burst of loads from spiking a single frame
+    VkDeviceSize m_frameUploadBudget = 16 * 1024 * 1024;
+
+    // images replaced or evicted in a frame, destroyed once its fence was waited on
+    std::vector<std::vector<std::unique_ptr<vk::Image>>> m_retiredImages;
+    VkDeviceSize m_retiredBytes = 0;
+
+    static constexpr uint64_t m_EVICT_AFTER_FRAMES = 120;  // unused for longer, evicted instead of losing a level
+    static constexpr uint32_t m_MIN_DROP_SIZE = 64;        // levels are not dropped below this size
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobCondition;
+    std::deque<std::pair<TextureHandle, std::string>> m_jobs;
+    bool m_isStopping = false;
+
+    std::mutex m_decodedMutex;
+    std::deque<DecodedImage> m_decoded;
+
+    TextureStats m_stats;
+    std::chrono::steady_clock::time_point m_batchStart;
+    TextureStats m_batchStartStats;
+
+private:
+    void _queueLoad(TextureHandle handle);
+    void _workerLoop();
+    DecodedImage _decode(TextureHandle handle, const std::string& filename) const;
+    void _decodeStb(DecodedImage& decoded, const Asset& file) const;
+    void _decodeKtx2(DecodedImage& decoded, Asset&& file) const;
+    void _querySampledFormats();
+
+    // stages every level in a single ring allocation, returns the offset of each level
+    std::optional<std::vector<VkDeviceSize>> _stage(const uint8_t* data, const std::vector<Ktx2Level>& levels);
+    void _recordUpload(const vk::CommandBuffer& cmd, const vk::Image& image, const std::vector<VkDeviceSize>& stagingOffsets, bool generateMips, uint32_t frameIndex);
+    std::unique_ptr<vk::Image> _createTextureImage(VkFormat format, uint32_t width, uint32_t height, uint32_t levelCount, bool generateMips);
+
+    // evicts until size more bytes fit into the device local budget, false if it could not free enough
+    bool _makeRoom(const vk::CommandBuffer& cmd, VkDeviceSize size, uint32_t frameIndex);
+    bool _dropTopLevel(const vk::CommandBuffer& cmd, Texture& texture, uint32_t frameIndex);
+    void _evict(Texture& texture, uint32_t frameIndex);
+    void _retireImage(Texture& texture, uint32_t frameIndex);
+    void _restoreUsed();
+    VkDeviceSize _getAvailable() const;
+    bool _isOverBudget() const;
+
+    static VkDeviceSize _getStagingSize(const std::vector<Ktx2Level>& levels);
+    static VkDeviceSize _getRgba8Size(const vk::Image& image);
+    static bool _canDropLevel(const vk::Image& image);
+
+    void _reportBatch() const;
+};
+
+}  // namespace eng
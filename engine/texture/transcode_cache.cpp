@@ -0,0 +1,112 @@
+#include "texture/transcode_cache.h"
+
+#include <filesystem>
+#include <sstream>
+#include <thread>
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t CACHE_MAGIC = 0x43544b56;  // "VKTC"
+constexpr uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t levelCount;
+    uint32_t reserved;
+};
+
+}  // namespace
+
+TranscodeCache::TranscodeCache(const std::string& directory)
+    : m_directory(RESOURCE_DIR + directory) {
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error) {
+        std::cerr << "failed to create texture cache directory: " << m_directory << " (" << error.message() << ")" << std::endl;
+    }
+}
+
+// fnv-1a
+uint64_t TranscodeCache::hash(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t value = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; i++) {
+        value ^= bytes[i];
+        value *= 0x100000001b3ull;
+    }
+
+    return value;
+}
+
+bool TranscodeCache::load(uint64_t key, std::vector<uint8_t>& data, std::vector<Ktx2Level>& levels) const {
+    std::ifstream file(_getPath(key), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.levelCount == 0 || header.levelCount > 32) {
+        return false;
+    }
+
+    std::vector<uint64_t> sizes(header.levelCount);
+    if (!file.read(reinterpret_cast<char*>(sizes.data()), sizes.size() * sizeof(uint64_t))) {
+        return false;
+    }
+
+    levels.clear();
+    size_t total = 0;
+    for (uint64_t size : sizes) {
+        levels.push_back({.offset = total, .size = static_cast<size_t>(size)});
+        total += static_cast<size_t>(size);
+    }
+
+    data.resize(total);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), total));
+}
+
+void TranscodeCache::store(uint64_t key, const std::vector<uint8_t>& data, const std::vector<Ktx2Level>& levels) const {
+    // written under a temporary name so a concurrent reader never sees a partial entry
+    std::string path = _getPath(key);
+    std::ostringstream temporary;
+    temporary << path << "." << std::this_thread::get_id() << ".tmp";
+
+    {
+        std::ofstream file(temporary.str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return;
+        }
+
+        CacheHeader header{
+            .magic = CACHE_MAGIC,
+            .version = CACHE_VERSION,
+            .levelCount = static_cast<uint32_t>(levels.size()),
+            .reserved = 0};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        for (const Ktx2Level& level : levels) {
+            uint64_t size = level.size;
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        }
+        for (const Ktx2Level& level : levels) {
+            file.write(reinterpret_cast<const char*>(data.data() + level.offset), level.size);
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary.str(), path, error);
+    if (error) {
+        std::filesystem::remove(temporary.str(), error);
+    }
+}
+
+std::string TranscodeCache::_getPath(uint64_t key) const {
+    std::ostringstream path;
+    path << m_directory << std::hex << key << ".bin";
+    return path.str();
+}
+
+}  // namespace eng
\ No newline at end of file
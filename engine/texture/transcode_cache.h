@@ -0,0 +1,27 @@
+#pragma once
+
+#include "shared.h"
+#include "texture/ktx2.h"
+
+namespace eng {
+
+// on disk cache for textures the cpu had to decode, keyed by a hash of the source file.
+// a second run loads the decoded chain instead of decoding every block again.
+class TranscodeCache {
+public:
+    explicit TranscodeCache(const std::string& directory);
+
+    static uint64_t hash(const void* data, size_t size);
+
+    // levels index into data, returns false on a miss or a stale entry
+    bool load(uint64_t key, std::vector<uint8_t>& data, std::vector<Ktx2Level>& levels) const;
+    void store(uint64_t key, const std::vector<uint8_t>& data, const std::vector<Ktx2Level>& levels) const;
+
+private:
+    std::string m_directory;
+
+private:
+    std::string _getPath(uint64_t key) const;
+};
+
+}  // namespace eng
\ No newline at end of file
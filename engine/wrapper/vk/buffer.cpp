@@ -11,23 +11,21 @@ Buffer::Buffer(const Device& device, const PhysicalDevice& physicalDevice, const
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(m_device.get(), m_buffer, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo{
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = physicalDevice.findMemoryType(memRequirements.memoryTypeBits, properties)};
-
-    if (vkAllocateMemory(m_device.get(), &allocInfo, nullptr, &m_memory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate buffer memory!");
-    }
+    m_memory = m_device.allocateMemory(memRequirements, properties);
 
     vkBindBufferMemory(m_device.get(), m_buffer, m_memory, 0);
-    vkMapMemory(m_device.get(), m_memory, 0, m_size, 0, &m_data);
+    // device local only memory can't be mapped, it is filled by transfers
+    if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        vkMapMemory(m_device.get(), m_memory, 0, m_size, 0, &m_data);
+    }
 }
 
 Buffer::~Buffer() {
-    vkUnmapMemory(m_device.get(), m_memory); // TODO: check optimal place to call
+    if (m_data != nullptr) {
+        vkUnmapMemory(m_device.get(), m_memory); // TODO: check optimal place to call
+    }
     vkDestroyBuffer(m_device.get(), m_buffer, nullptr);
-    vkFreeMemory(m_device.get(), m_memory, nullptr);
+    m_device.freeMemory(m_memory);
 }
 
 void Buffer::setData(const void* data)
@@ -35,4 +33,26 @@ void Buffer::setData(const void* data)
     memcpy(m_data, data, m_size);
 }
 
+void Buffer::setData(const void* data, VkDeviceSize size, VkDeviceSize offset) {
+    if (m_data == nullptr) {
+        throw std::runtime_error("buffer is not host visible!");
+    }
+    if (offset + size > m_size) {
+        throw std::runtime_error("buffer write out of range!");
+    }
+
+    memcpy(static_cast<char*>(m_data) + offset, data, size);
+}
+
+void Buffer::getData(void* data, VkDeviceSize size, VkDeviceSize offset) const {
+    if (m_data == nullptr) {
+        throw std::runtime_error("buffer is not host visible!");
+    }
+    if (offset + size > m_size) {
+        throw std::runtime_error("buffer read out of range!");
+    }
+
+    memcpy(data, static_cast<const char*>(m_data) + offset, size);
+}
+
 }
\ No newline at end of file
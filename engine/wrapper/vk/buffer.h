@@ -13,13 +13,17 @@ public:
 
     inline const VkBuffer& get() const { return m_buffer; }
     inline const VkDeviceMemory& getMemory () const { return m_memory; }
+    inline VkDeviceSize getSize() const { return m_size; }
     
     void setData(const void* data); // TODO: support different sizes
+    void setData(const void* data, VkDeviceSize size, VkDeviceSize offset = 0);
+    // reads back what the device wrote, after its writes were made visible to the host
+    void getData(void* data, VkDeviceSize size, VkDeviceSize offset = 0) const;
 
 private:
     VkBuffer m_buffer;
     VkDeviceMemory m_memory;
-    void* m_data;
+    void* m_data = nullptr;
     uint32_t m_size;
 
     const Device& m_device;
@@ -16,6 +16,7 @@ CommandBuffer::~CommandBuffer()
 }
 
 void CommandBuffer::begin(const VkCommandBufferBeginInfo& beginInfo) const {
+    _forgetState();
     if (vkBeginCommandBuffer(m_cmd, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("failed to begin recording command buffer!");
     }
@@ -25,21 +26,88 @@ void CommandBuffer::beginRenderPass(const VkRenderPassBeginInfo& renderPassInfo)
     vkCmdBeginRenderPass(m_cmd, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 }
 
-void CommandBuffer::bindPipeline(const VkPipeline& pipeline) const {
-    vkCmdBindPipeline(m_cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+void CommandBuffer::bindPipeline(const VkPipeline& pipeline, VkPipelineBindPoint pipelineBindPoint) const {
+    bool isTracked = pipelineBindPoint < TRACKED_BIND_POINTS;
+    if (isTracked && m_bound.pipelines[pipelineBindPoint] == pipeline) {
+        m_stats.skippedBinds++;
+        return;
+    }
+
+    vkCmdBindPipeline(m_cmd, pipelineBindPoint, pipeline);
+    m_stats.pipelineBinds++;
+    if (isTracked) {
+        m_bound.pipelines[pipelineBindPoint] = pipeline;
+    }
 }
 
-void CommandBuffer::bindVertexBuffers(const VkBuffer (&vertexBuffers)[], const VkDeviceSize (&offsets)[]) const {
-    vkCmdBindVertexBuffers(m_cmd, 0, 1, vertexBuffers, offsets);
+void CommandBuffer::bindVertexBuffers(const VkBuffer (&vertexBuffers)[], const VkDeviceSize (&offsets)[], uint32_t firstBinding, uint32_t bindingCount) const {
+    bool isTracked = firstBinding + bindingCount <= MAX_TRACKED_BINDINGS;
+    bool isBound = isTracked;
+    for (uint32_t i = 0; isBound && i < bindingCount; i++) {
+        isBound = m_bound.vertexBuffers[firstBinding + i] == vertexBuffers[i] && m_bound.vertexOffsets[firstBinding + i] == offsets[i];
+    }
+    if (isBound) {
+        m_stats.skippedBinds++;
+        return;
+    }
+
+    vkCmdBindVertexBuffers(m_cmd, firstBinding, bindingCount, vertexBuffers, offsets);
+    m_stats.vertexBufferBinds++;
+    for (uint32_t i = 0; i < bindingCount && firstBinding + i < MAX_TRACKED_BINDINGS; i++) {
+        m_bound.vertexBuffers[firstBinding + i] = vertexBuffers[i];
+        m_bound.vertexOffsets[firstBinding + i] = offsets[i];
+    }
 }
 
-void CommandBuffer::bindIndexBuffer(const VkBuffer &indexBuffer, VkIndexType type) const
+void CommandBuffer::bindIndexBuffer(const VkBuffer &indexBuffer, VkIndexType type, VkDeviceSize offset) const
 {
-    vkCmdBindIndexBuffer(m_cmd, indexBuffer, 0, type);
+    if (m_bound.indexBuffer == indexBuffer && m_bound.indexOffset == offset && m_bound.indexType == type) {
+        m_stats.skippedBinds++;
+        return;
+    }
+
+    vkCmdBindIndexBuffer(m_cmd, indexBuffer, offset, type);
+    m_stats.indexBufferBinds++;
+    m_bound.indexBuffer = indexBuffer;
+    m_bound.indexOffset = offset;
+    m_bound.indexType = type;
+}
+
+void CommandBuffer::bindIndexBuffer(const IndexBuffer& indexBuffer, VkDeviceSize offset) const {
+    bindIndexBuffer(indexBuffer.get(), indexBuffer.getIndexType(), offset);
 }
 
 void CommandBuffer::bindDescriptorSets(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, const VkDescriptorSet *descriptorSets, uint32_t firstSet, uint32_t descriptorSetCount, uint32_t dynamicOffsetCount, const uint32_t *dynamicOffsets) const {
-    vkCmdBindDescriptorSets(m_cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, firstSet, descriptorSetCount, descriptorSets, dynamicOffsetCount, dynamicOffsets);
+    // sets bound with dynamic offsets aren't compared, the offsets change between draws
+    bool isTracked = pipelineBindPoint < TRACKED_BIND_POINTS && firstSet + descriptorSetCount <= MAX_TRACKED_SETS;
+    bool isBound = isTracked && dynamicOffsetCount == 0 && m_bound.layouts[pipelineBindPoint] == layout;
+    for (uint32_t i = 0; isBound && i < descriptorSetCount; i++) {
+        isBound = m_bound.descriptorSets[pipelineBindPoint][firstSet + i] == descriptorSets[i];
+    }
+    if (isBound) {
+        m_stats.skippedBinds++;
+        return;
+    }
+
+    vkCmdBindDescriptorSets(m_cmd, pipelineBindPoint, layout, firstSet, descriptorSetCount, descriptorSets, dynamicOffsetCount, dynamicOffsets);
+    m_stats.descriptorSetBinds++;
+    if (pipelineBindPoint >= TRACKED_BIND_POINTS) {
+        return;
+    }
+
+    // a different layout may disturb every set bound before
+    VkDescriptorSet (&boundSets)[MAX_TRACKED_SETS] = m_bound.descriptorSets[pipelineBindPoint];
+    if (m_bound.layouts[pipelineBindPoint] != layout) {
+        std::fill(std::begin(boundSets), std::end(boundSets), VK_NULL_HANDLE);
+        m_bound.layouts[pipelineBindPoint] = layout;
+    }
+    for (uint32_t i = 0; i < descriptorSetCount && firstSet + i < MAX_TRACKED_SETS; i++) {
+        boundSets[firstSet + i] = dynamicOffsetCount == 0 ? descriptorSets[i] : VK_NULL_HANDLE;
+    }
+}
+
+void CommandBuffer::pushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* values) const {
+    vkCmdPushConstants(m_cmd, layout, stageFlags, offset, size, values);
 }
 
 void CommandBuffer::setScissor(const VkRect2D& scissor) const {
@@ -51,24 +119,110 @@ void CommandBuffer::setViewport(const VkViewport& viewport) const {
 }
 
 void CommandBuffer::draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) const {
+    m_stats.draws++;
     vkCmdDraw(m_cmd, vertexCount, instanceCount, firstVertex, firstInstance);
 }
 
+void CommandBuffer::drawIndirect(const VkBuffer& buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride) const {
+    m_stats.draws += drawCount;
+    if (m_device.getFeatures().multiDrawIndirect || drawCount <= 1) {
+        vkCmdDrawIndirect(m_cmd, buffer, offset, drawCount, stride);
+        return;
+    }
+
+    for (uint32_t i = 0; i < drawCount; i++) {
+        vkCmdDrawIndirect(m_cmd, buffer, offset + static_cast<VkDeviceSize>(i) * stride, 1, stride);
+    }
+}
+
 void CommandBuffer::drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) const
 {
-    vkCmdDrawIndexed(m_cmd, indexCount, 1, 0, 0, 0);
+    m_stats.draws++;
+    vkCmdDrawIndexed(m_cmd, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+}
+
+void CommandBuffer::drawIndexedIndirect(const VkBuffer& buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride) const {
+    m_stats.draws += drawCount;
+    if (m_device.getFeatures().multiDrawIndirect || drawCount <= 1) {
+        vkCmdDrawIndexedIndirect(m_cmd, buffer, offset, drawCount, stride);
+        return;
+    }
+
+    for (uint32_t i = 0; i < drawCount; i++) {
+        vkCmdDrawIndexedIndirect(m_cmd, buffer, offset + static_cast<VkDeviceSize>(i) * stride, 1, stride);
+    }
+}
+
+void CommandBuffer::dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) const {
+    vkCmdDispatch(m_cmd, groupCountX, groupCountY, groupCountZ);
 }
 
-void CommandBuffer::copyBuffer(const Buffer& src, Buffer& dst, VkDeviceSize size) const {
+void CommandBuffer::dispatchIndirect(const VkBuffer& buffer, VkDeviceSize offset) const {
+    vkCmdDispatchIndirect(m_cmd, buffer, offset);
+}
+
+void CommandBuffer::copyBuffer(const Buffer& src, Buffer& dst, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset) const {
     VkBufferCopy copyRegion{
-        copyRegion.srcOffset = 0,  // Optional
-        copyRegion.dstOffset = 0,  // Optional
+        copyRegion.srcOffset = srcOffset,
+        copyRegion.dstOffset = dstOffset,
         copyRegion.size = size};
 
     vkCmdCopyBuffer(m_cmd, src.get(), dst.get(), 1, &copyRegion);
 }
 
+void CommandBuffer::copyBufferToImage(const Buffer& src, const Image& dst, const VkBufferImageCopy& region) const {
+    vkCmdCopyBufferToImage(m_cmd, src.get(), dst.get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
+
+void CommandBuffer::blitImage(const Image& src, const Image& dst, const VkImageBlit& region, VkFilter filter) const {
+    vkCmdBlitImage(m_cmd, src.get(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst.get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, filter);
+}
+
+void CommandBuffer::blitImage(const Image& src, VkImage dst, const VkImageBlit& region, VkFilter filter) const {
+    vkCmdBlitImage(m_cmd, src.get(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region, filter);
+}
+
+void CommandBuffer::copyImage(const Image& src, const Image& dst, const VkImageCopy& region) const {
+    vkCmdCopyImage(m_cmd, src.get(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst.get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
+
+void CommandBuffer::pipelineBarrier(VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, const VkImageMemoryBarrier& barrier) const {
+    vkCmdPipelineBarrier(m_cmd, srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void CommandBuffer::pipelineBarrier(VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, const VkMemoryBarrier& barrier) const {
+    vkCmdPipelineBarrier(m_cmd, srcStageMask, dstStageMask, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void CommandBuffer::transitionImageLayout(const Image& image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                          VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask,
+                                          VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask,
+                                          uint32_t baseMipLevel, uint32_t levelCount) const {
+    VkImageMemoryBarrier barrier = vk::imageMemoryBarrier();
+    {
+        barrier.srcAccessMask = srcAccessMask;
+        barrier.dstAccessMask = dstAccessMask;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.image = image.get();
+        barrier.subresourceRange.aspectMask = image.getAspectMask();
+        barrier.subresourceRange.baseMipLevel = baseMipLevel;
+        barrier.subresourceRange.levelCount = levelCount;
+    }
+
+    pipelineBarrier(srcStageMask, dstStageMask, barrier);
+}
+
+void CommandBuffer::resetQueryPool(VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount) const {
+    vkCmdResetQueryPool(m_cmd, queryPool, firstQuery, queryCount);
+}
+
+void CommandBuffer::writeTimestamp(VkPipelineStageFlagBits stage, VkQueryPool queryPool, uint32_t query) const {
+    vkCmdWriteTimestamp(m_cmd, stage, queryPool, query);
+}
+
 void CommandBuffer::reset() const {
+    _forgetState();
     vkResetCommandBuffer(m_cmd, 0);
 }
 
@@ -82,4 +236,9 @@ void CommandBuffer::endRenderPass() const {
     vkCmdEndRenderPass(m_cmd);
 }
 
+void CommandBuffer::_forgetState() const {
+    m_bound = BoundState{};
+    m_stats = CommandBufferStats{};
+}
+
 }
\ No newline at end of file
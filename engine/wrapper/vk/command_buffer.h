@@ -3,41 +3,106 @@
 #include "shared.h"
 #include "wrapper/vk/device.h"
 #include "wrapper/vk/buffer.h"
+#include "wrapper/vk/image.h"
+#include "wrapper/vk/index_buffer.h"
 
 namespace vk {
 
+// binds recorded and binds dropped because the state was already bound, since begin
+struct CommandBufferStats {
+    uint32_t pipelineBinds = 0;
+    uint32_t descriptorSetBinds = 0;
+    uint32_t vertexBufferBinds = 0;
+    uint32_t indexBufferBinds = 0;
+    uint32_t skippedBinds = 0;
+    uint32_t draws = 0;  // an indirect call counts each of its commands, culled ones included
+};
+
+// remembers what is bound, so binding the same pipeline, descriptor sets or buffers
+// again records nothing. the state is forgotten on begin and reset.
 class CommandBuffer {
 public:
     CommandBuffer(const Device& device, const VkCommandBufferAllocateInfo& allocInfo);
     ~CommandBuffer();
 
     inline const VkCommandBuffer& get() const { return m_cmd; }
+    inline const CommandBufferStats& getStats() const { return m_stats; }
     
     void begin(const VkCommandBufferBeginInfo& beginInfo) const;
     void beginRenderPass(const VkRenderPassBeginInfo& renderPassInfo) const;
 
-    void bindPipeline(const VkPipeline& pipeline) const;
-    void bindVertexBuffers(const VkBuffer (&vertexBuffers)[], const VkDeviceSize (&offsets)[]) const;
-    void bindIndexBuffer(const VkBuffer &indexBuffer, VkIndexType type) const;
+    void bindPipeline(const VkPipeline& pipeline, VkPipelineBindPoint pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS) const;
+    void bindVertexBuffers(const VkBuffer (&vertexBuffers)[], const VkDeviceSize (&offsets)[], uint32_t firstBinding = 0, uint32_t bindingCount = 1) const;
+    void bindIndexBuffer(const VkBuffer &indexBuffer, VkIndexType type, VkDeviceSize offset = 0) const;
+    void bindIndexBuffer(const IndexBuffer& indexBuffer, VkDeviceSize offset = 0) const;
     void bindDescriptorSets(VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, const VkDescriptorSet *descriptorSets, uint32_t firstSet = 0, uint32_t descriptorSetCount = 1, uint32_t dynamicOffsetCount = 0, const uint32_t *dynamicOffsets = nullptr) const;
 
+    void pushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* values) const;
+    template <typename T>
+    void pushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, const T& values, uint32_t offset = 0) const {
+        pushConstants(layout, stageFlags, offset, sizeof(T), &values);
+    }
+
     void setScissor(const VkRect2D& scissor) const;
     void setViewport(const VkViewport& viewport) const;
 
     void draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) const;
+    void drawIndirect(const VkBuffer& buffer, VkDeviceSize offset, uint32_t drawCount = 1, uint32_t stride = sizeof(VkDrawIndirectCommand)) const;
     void drawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) const;
+    // without multiDrawIndirect the commands are drawn one call at a time
+    void drawIndexedIndirect(const VkBuffer& buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride = sizeof(VkDrawIndexedIndirectCommand)) const;
+    void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) const;
+    // the group counts are a VkDispatchIndirectCommand in the buffer
+    void dispatchIndirect(const VkBuffer& buffer, VkDeviceSize offset = 0) const;
+
+    void copyBuffer(const Buffer& src, Buffer& dst, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0) const;
+    void copyBufferToImage(const Buffer& src, const Image& dst, const VkBufferImageCopy& region) const;
+    void blitImage(const Image& src, const Image& dst, const VkImageBlit& region, VkFilter filter) const;
+    // into an image the wrapper doesn't own, like a swap chain image
+    void blitImage(const Image& src, VkImage dst, const VkImageBlit& region, VkFilter filter) const;
+    void copyImage(const Image& src, const Image& dst, const VkImageCopy& region) const;
+
+    void pipelineBarrier(VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, const VkImageMemoryBarrier& barrier) const;
+    void pipelineBarrier(VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, const VkMemoryBarrier& barrier) const;
+    void transitionImageLayout(const Image& image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                               VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask,
+                               VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask,
+                               uint32_t baseMipLevel = 0, uint32_t levelCount = VK_REMAINING_MIP_LEVELS) const;
 
-    void copyBuffer(const Buffer& src, Buffer& dst, VkDeviceSize size) const;
+    void resetQueryPool(VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount) const;
+    void writeTimestamp(VkPipelineStageFlagBits stage, VkQueryPool queryPool, uint32_t query) const;
 
     void reset() const;
     void end() const;
     void endRenderPass() const;
 
 private:
+    static constexpr uint32_t MAX_TRACKED_SETS = 4;
+    static constexpr uint32_t MAX_TRACKED_BINDINGS = 4;
+    static constexpr uint32_t TRACKED_BIND_POINTS = 2;  // graphics and compute
+
+    struct BoundState {
+        VkPipeline pipelines[TRACKED_BIND_POINTS];
+        VkPipelineLayout layouts[TRACKED_BIND_POINTS];
+        VkDescriptorSet descriptorSets[TRACKED_BIND_POINTS][MAX_TRACKED_SETS];
+        VkBuffer vertexBuffers[MAX_TRACKED_BINDINGS];
+        VkDeviceSize vertexOffsets[MAX_TRACKED_BINDINGS];
+        VkBuffer indexBuffer;
+        VkDeviceSize indexOffset;
+        VkIndexType indexType;
+    };
+
     VkCommandBuffer m_cmd;
 
     const Device& m_device;
     const VkCommandPool& m_commandPool;
+
+    // recording doesn't change the wrapper itself, only what it knows about the command buffer
+    mutable BoundState m_bound{};
+    mutable CommandBufferStats m_stats{};
+
+private:
+    void _forgetState() const;
 };
 
 }
\ No newline at end of file
@@ -2,7 +2,8 @@
 
 namespace vk {
 
-Device::Device(const PhysicalDevice& physicalDevice) {
+Device::Device(const PhysicalDevice& physicalDevice)
+    : m_physicalDevice(physicalDevice) {
     vk::QueueFamilyIndices indices = physicalDevice.getQueueFamilyIndices();
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
@@ -18,14 +19,17 @@ Device::Device(const PhysicalDevice& physicalDevice) {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures{};
+    m_features.samplerAnisotropy = physicalDevice.getFeatures().samplerAnisotropy;
+    m_features.textureCompressionBC = physicalDevice.getFeatures().textureCompressionBC;
+    m_features.multiDrawIndirect = physicalDevice.getFeatures().multiDrawIndirect;
+    m_features.drawIndirectFirstInstance = physicalDevice.getFeatures().drawIndirectFirstInstance;
 
     // create logical device
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
-    createInfo.pEnabledFeatures = &deviceFeatures;
+    createInfo.pEnabledFeatures = &m_features;
 
     createInfo.enabledExtensionCount = static_cast<uint32_t>(physicalDevice.getExtensions().size());
     createInfo.ppEnabledExtensionNames = physicalDevice.getExtensions().data();
@@ -57,4 +61,34 @@ void Device::waitIdle() const {
     vkDeviceWaitIdle(m_device);
 }
 
+VkDeviceMemory Device::allocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties) const {
+    uint32_t memoryTypeIndex = m_physicalDevice.findMemoryType(requirements.memoryTypeBits, properties);
+
+    VkMemoryAllocateInfo allocInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = requirements.size,
+        .memoryTypeIndex = memoryTypeIndex};
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(m_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate device memory!");
+    }
+
+    uint32_t heapIndex = m_physicalDevice.getMemoryProperties().memoryTypes[memoryTypeIndex].heapIndex;
+    m_allocations[memory] = {heapIndex, requirements.size};
+    m_heapUsage[heapIndex] += requirements.size;
+
+    return memory;
+}
+
+void Device::freeMemory(VkDeviceMemory memory) const {
+    auto it = m_allocations.find(memory);
+    if (it != m_allocations.end()) {
+        m_heapUsage[it->second.heapIndex] -= it->second.size;
+        m_allocations.erase(it);
+    }
+
+    vkFreeMemory(m_device, memory, nullptr);
+}
+
 }  // namespace vk
\ No newline at end of file
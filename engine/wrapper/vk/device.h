@@ -1,5 +1,6 @@
 #pragma once
 
+#include <unordered_map>
 #include "shared.h"
 #include "wrapper/vk/physical_device.h"
 
@@ -13,11 +14,29 @@ public:
     inline const VkDevice& get() const { return m_device; }
     const VkQueue& getPresentQueue() const { return m_presentQueue; }
     const VkQueue& getGraphicsQueue() const { return m_graphicsQueue; }
+    // the optional features the physical device had, the rest stay off
+    inline const VkPhysicalDeviceFeatures& getFeatures() const { return m_features; }
 
     void waitIdle() const;
 
+    // all device memory is allocated here so the usage of every heap is known,
+    // also without VK_EXT_memory_budget
+    VkDeviceMemory allocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties) const;
+    void freeMemory(VkDeviceMemory memory) const;
+    inline VkDeviceSize getHeapUsage(uint32_t heapIndex) const { return m_heapUsage[heapIndex]; }
+
 private:
+    struct Allocation {
+        uint32_t heapIndex;
+        VkDeviceSize size;
+    };
+
     VkDevice m_device;
+    const PhysicalDevice& m_physicalDevice;
+    VkPhysicalDeviceFeatures m_features{};
+
+    mutable std::unordered_map<VkDeviceMemory, Allocation> m_allocations;
+    mutable std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> m_heapUsage{};
     
     VkQueue m_presentQueue;
     VkQueue m_graphicsQueue;
@@ -0,0 +1,56 @@
+#include "wrapper/vk/image.h"
+
+namespace vk {
+
+Image::Image(const Device& device, const PhysicalDevice& physicalDevice, const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImageAspectFlags aspectMask)
+    : m_device(device), m_format(imageInfo.format), m_extent(imageInfo.extent), m_mipLevels(imageInfo.mipLevels), m_aspectMask(aspectMask) {
+    if (vkCreateImage(m_device.get(), &imageInfo, nullptr, &m_image) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create image!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(m_device.get(), m_image, &memRequirements);
+    m_memorySize = memRequirements.size;
+
+    try {
+        m_memory = m_device.allocateMemory(memRequirements, properties);
+    } catch (...) {
+        vkDestroyImage(m_device.get(), m_image, nullptr);
+        throw;
+    }
+
+    vkBindImageMemory(m_device.get(), m_image, m_memory, 0);
+
+    // an image with extended usage carries usages only views of other formats support,
+    // the default view leaves out the storage usage its own format lacks
+    VkImageViewUsageCreateInfo usageInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO,
+        .usage = imageInfo.usage};
+    if (!(physicalDevice.getFormatProperties(m_format).optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)) {
+        usageInfo.usage &= ~VK_IMAGE_USAGE_STORAGE_BIT;
+    }
+
+    VkImageViewCreateInfo viewInfo = vk::imageViewCreateInfo();
+    {
+        viewInfo.pNext = (imageInfo.flags & VK_IMAGE_CREATE_EXTENDED_USAGE_BIT) ? &usageInfo : nullptr;
+        viewInfo.image = m_image;
+        viewInfo.format = m_format;
+        viewInfo.subresourceRange.aspectMask = m_aspectMask;
+        viewInfo.subresourceRange.levelCount = m_mipLevels;
+        viewInfo.subresourceRange.layerCount = imageInfo.arrayLayers;
+    }
+
+    if (vkCreateImageView(m_device.get(), &viewInfo, nullptr, &m_view) != VK_SUCCESS) {
+        vkDestroyImage(m_device.get(), m_image, nullptr);
+        m_device.freeMemory(m_memory);
+        throw std::runtime_error("failed to create texture image view!");
+    }
+}
+
+Image::~Image() {
+    vkDestroyImageView(m_device.get(), m_view, nullptr);
+    vkDestroyImage(m_device.get(), m_image, nullptr);
+    m_device.freeMemory(m_memory);
+}
+
+}
\ No newline at end of file
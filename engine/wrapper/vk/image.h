@@ -0,0 +1,37 @@
+#pragma once
+
+#include "shared.h"
+#include "wrapper/vk/device.h"
+#include "wrapper/vk/physical_device.h"
+
+namespace vk {
+
+class Image {
+public:
+    Image(const Device& device, const PhysicalDevice& physicalDevice, const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT);
+    ~Image();
+
+    inline const VkImage& get() const { return m_image; }
+    inline const VkImageView& getView() const { return m_view; }
+    inline const VkDeviceMemory& getMemory() const { return m_memory; }
+    inline const VkFormat& getFormat() const { return m_format; }
+    inline const VkExtent3D& getExtent() const { return m_extent; }
+    inline uint32_t getMipLevels() const { return m_mipLevels; }
+    inline VkImageAspectFlags getAspectMask() const { return m_aspectMask; }
+    inline VkDeviceSize getMemorySize() const { return m_memorySize; }
+
+private:
+    const Device& m_device;
+
+    VkImage m_image;
+    VkImageView m_view;
+    VkDeviceMemory m_memory;
+    VkDeviceSize m_memorySize;
+
+    VkFormat m_format;
+    VkExtent3D m_extent;
+    uint32_t m_mipLevels;
+    VkImageAspectFlags m_aspectMask;
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "wrapper/vk/index_buffer.h"
+
+namespace vk {
+
+namespace {
+
+VkBufferCreateInfo _indexBufferInfo(VkDeviceSize indexCount, VkIndexType indexType, VkBufferUsageFlags usage) {
+    VkBufferCreateInfo bufferInfo = bufferCreateInfo();
+    bufferInfo.size = indexCount * IndexBuffer::getIndexSize(indexType);
+    bufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | usage;
+    return bufferInfo;
+}
+
+}  // namespace
+
+IndexBuffer::IndexBuffer(const Device& device, const PhysicalDevice& physicalDevice, VkDeviceSize indexCount, VkIndexType indexType, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+    : m_indexType(indexType),
+      m_indexCount(indexCount),
+      m_buffer(device, physicalDevice, _indexBufferInfo(indexCount, indexType, usage), properties) {
+}
+
+VkIndexType IndexBuffer::selectIndexType(size_t vertexCount) {
+    return vertexCount <= std::numeric_limits<uint16_t>::max() + size_t(1) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+uint32_t IndexBuffer::getIndexSize(VkIndexType indexType) {
+    switch (indexType) {
+        case VK_INDEX_TYPE_UINT16: return sizeof(uint16_t);
+        case VK_INDEX_TYPE_UINT32: return sizeof(uint32_t);
+        default: throw std::runtime_error("unsupported index type!");
+    }
+}
+
+}
\ No newline at end of file
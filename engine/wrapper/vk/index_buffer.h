@@ -0,0 +1,32 @@
+#pragma once
+
+#include "shared.h"
+#include "wrapper/vk/buffer.h"
+#include "wrapper/vk/device.h"
+#include "wrapper/vk/physical_device.h"
+
+namespace vk {
+
+// buffer of indices that knows their width, so binding can't disagree with the data
+class IndexBuffer {
+public:
+    IndexBuffer(const Device& device, const PhysicalDevice& physicalDevice, VkDeviceSize indexCount, VkIndexType indexType, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+
+    // 16 bit indices whenever every vertex is reachable with them, half the bandwidth
+    static VkIndexType selectIndexType(size_t vertexCount);
+    static uint32_t getIndexSize(VkIndexType indexType);
+
+    inline const Buffer& getBuffer() const { return m_buffer; }
+    inline Buffer& getBuffer() { return m_buffer; }
+    inline const VkBuffer& get() const { return m_buffer.get(); }
+    inline VkIndexType getIndexType() const { return m_indexType; }
+    inline uint32_t getIndexSize() const { return getIndexSize(m_indexType); }
+    inline VkDeviceSize getIndexCount() const { return m_indexCount; }
+
+private:
+    VkIndexType m_indexType;
+    VkDeviceSize m_indexCount;
+    Buffer m_buffer;
+};
+
+}
\ No newline at end of file
@@ -1,5 +1,10 @@
 #include "wrapper/vk/physical_device.h"
 
+#include <cstring>
+#include <memory_resource>
+#include <set>
+#include <string_view>
+
 namespace vk {
 
 PhysicalDevice::PhysicalDevice(const Instance& instance, const VkSurfaceKHR& surface) {
@@ -26,15 +31,24 @@ PhysicalDevice::PhysicalDevice(const Instance& instance, const VkSurfaceKHR& sur
     m_queueFamilyIndices = _findQueueFamilies(m_physicalDevice, surface);
     m_swapChainSupportDetails = _querySwapChainSupport(m_physicalDevice, surface);
 
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &m_properties);
+    vkGetPhysicalDeviceFeatures(m_physicalDevice, &m_features);
+    vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+
+    m_enabledExtensions = m_deviceExtensions;
+    for (const auto& extension : _getAvailableExtensions(m_physicalDevice)) {
+        for (const char* optional : m_optionalDeviceExtensions) {
+            if (strcmp(extension.extensionName, optional) == 0) {
+                m_enabledExtensions.push_back(optional);
+            }
+        }
+    }
 }
 
 uint32_t PhysicalDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
 {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProperties);
-
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
             return i;
         }
     }
@@ -42,6 +56,26 @@ uint32_t PhysicalDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFla
     throw std::runtime_error("failed to find suitable memory type!");
 }
 
+VkFormatProperties PhysicalDevice::getFormatProperties(VkFormat format) const {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(m_physicalDevice, format, &properties);
+    return properties;
+}
+
+bool PhysicalDevice::isExtensionEnabled(const char* extension) const {
+    for (const char* enabled : m_enabledExtensions) {
+        if (strcmp(enabled, extension) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool PhysicalDevice::isFormatSupported(VkFormat format, VkFormatFeatureFlags features) const {
+    return (getFormatProperties(format).optimalTilingFeatures & features) == features;
+}
+
 void PhysicalDevice::updateSwapChainSupportDetails(const VkSurfaceKHR& surface)
 {
     m_swapChainSupportDetails = _querySwapChainSupport(m_physicalDevice, surface);
@@ -62,20 +96,27 @@ bool PhysicalDevice::_isDeviceSuitable(VkPhysicalDevice physicalDevice, const Vk
 }
 
 bool PhysicalDevice::_checkDeviceExtensionSupport(VkPhysicalDevice device) {
-    uint32_t extensionCount;
-    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
-    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
-    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
-
-    std::set<std::string> requiredExtensions(m_deviceExtensions.begin(), m_deviceExtensions.end());
+    // the names stay the literals of m_deviceExtensions, the nodes live on the stack
+    std::array<std::byte, 2048> buffer;
+    std::pmr::monotonic_buffer_resource memory(buffer.data(), buffer.size());
+    std::pmr::set<std::string_view> requiredExtensions(m_deviceExtensions.begin(), m_deviceExtensions.end(), &memory);
 
-    for (const auto& extension : availableExtensions) {
+    for (const auto& extension : _getAvailableExtensions(device)) {
         requiredExtensions.erase(extension.extensionName);
     }
 
     return requiredExtensions.empty();
 }
 
+std::vector<VkExtensionProperties> PhysicalDevice::_getAvailableExtensions(VkPhysicalDevice device) {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    return availableExtensions;
+}
+
 QueueFamilyIndices PhysicalDevice::_findQueueFamilies(VkPhysicalDevice physicalDevice, const VkSurfaceKHR& surface) {
     QueueFamilyIndices indices;
 
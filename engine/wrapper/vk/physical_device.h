@@ -28,9 +28,17 @@ public:
     inline const VkPhysicalDevice& get() const { return m_physicalDevice; }
     inline const QueueFamilyIndices& getQueueFamilyIndices() const { return m_queueFamilyIndices; }
     inline const SwapChainSupportDetails& getSwapChainSupportDetails() const { return m_swapChainSupportDetails; }
-    inline const std::vector<const char*>& getExtensions() const { return m_deviceExtensions; }
+    inline const std::vector<const char*>& getExtensions() const { return m_enabledExtensions; }
+    inline const VkPhysicalDeviceProperties& getProperties() const { return m_properties; }
+    inline const VkPhysicalDeviceFeatures& getFeatures() const { return m_features; }
+    inline const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const { return m_memoryProperties; }
+
+    bool isExtensionEnabled(const char* extension) const;
 
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    VkFormatProperties getFormatProperties(VkFormat format) const;
+    // optimal tiling
+    bool isFormatSupported(VkFormat format, VkFormatFeatureFlags features) const;
 
     // eg: on windows resize
     void updateSwapChainSupportDetails(const VkSurfaceKHR& surface); // TODO: check if this is possible to automate
@@ -39,13 +47,21 @@ private:
     VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
     QueueFamilyIndices m_queueFamilyIndices;
     SwapChainSupportDetails m_swapChainSupportDetails;
+    VkPhysicalDeviceProperties m_properties;
+    VkPhysicalDeviceFeatures m_features;
+    VkPhysicalDeviceMemoryProperties m_memoryProperties;
 
     const std::vector<const char*> m_deviceExtensions = {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    // enabled when the device has them
+    const std::vector<const char*> m_optionalDeviceExtensions = {
+        VK_EXT_MEMORY_BUDGET_EXTENSION_NAME};
+    std::vector<const char*> m_enabledExtensions;
 
 private:
     bool _isDeviceSuitable(VkPhysicalDevice physicalDevice, const VkSurfaceKHR& surface);
     bool _checkDeviceExtensionSupport(VkPhysicalDevice device);
+    std::vector<VkExtensionProperties> _getAvailableExtensions(VkPhysicalDevice device);
     QueueFamilyIndices _findQueueFamilies(VkPhysicalDevice physicalDevice, const VkSurfaceKHR& surface);
     SwapChainSupportDetails _querySwapChainSupport(VkPhysicalDevice physicalDevice, const VkSurfaceKHR& surface);
 
@@ -0,0 +1,16 @@
+#include "wrapper/vk/sampler.h"
+
+namespace vk {
+
+Sampler::Sampler(const Device& device, const VkSamplerCreateInfo& samplerInfo)
+    : m_device(device) {
+    if (vkCreateSampler(m_device.get(), &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture sampler!");
+    }
+}
+
+Sampler::~Sampler() {
+    vkDestroySampler(m_device.get(), m_sampler, nullptr);
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "shared.h"
+#include "wrapper/vk/device.h"
+
+namespace vk {
+
+class Sampler {
+public:
+    Sampler(const Device& device, const VkSamplerCreateInfo& samplerInfo);
+    ~Sampler();
+
+    inline const VkSampler& get() const { return m_sampler; }
+
+private:
+    VkSampler m_sampler;
+
+    const Device& m_device;
+};
+
+}
\ No newline at end of file
@@ -39,6 +39,9 @@ void SwapChain::create() {
     createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
     createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    if (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) {
+        createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;  // the scene is upscaled into it
+    }
 
     vk::QueueFamilyIndices indices = m_physicalDevice.getQueueFamilyIndices();
     uint32_t queueFamilyIndices[] = {indices.graphicsFamily.value(), indices.presentFamily.value()};
@@ -70,6 +73,7 @@ void SwapChain::create() {
 
     m_swapChainImageFormat = surfaceFormat.format;
     m_swapChainExtent = extent;
+    m_swapChainImageUsage = createInfo.imageUsage;
 
     // create image views
     m_swapChainImageViews.resize(m_swapChainImages.size());
@@ -17,6 +17,7 @@ public:
     inline const std::vector<VkImageView>& getImageViews() const { return m_swapChainImageViews; }
     inline const VkFormat& getImageFormat() const { return m_swapChainImageFormat; }
     inline const VkExtent2D& getExtent() const { return m_swapChainExtent; }
+    inline VkImageUsageFlags getImageUsage() const { return m_swapChainImageUsage; }
 
     void create();
     void clean();
@@ -34,6 +35,7 @@ private:
 
     VkFormat m_swapChainImageFormat;
     VkExtent2D m_swapChainExtent;
+    VkImageUsageFlags m_swapChainImageUsage;
 
     const Device& m_device;
     const PhysicalDevice& m_physicalDevice;
@@ -3,4 +3,12 @@ if not exist bin (
 )
 C:/VulkanSDK/1.3.236.0/Bin/glslc.exe default.vert -o bin/default_vert.spv
 C:/VulkanSDK/1.3.236.0/Bin/glslc.exe default.frag -o bin/default_frag.spv
+C:/VulkanSDK/1.3.236.0/Bin/glslc.exe mip_downsample.comp -o bin/mip_downsample_comp.spv
+C:/VulkanSDK/1.3.236.0/Bin/glslc.exe depth_pyramid.comp -o bin/depth_pyramid_comp.spv
+C:/VulkanSDK/1.3.236.0/Bin/glslc.exe occlusion_cull.comp -o bin/occlusion_cull_comp.spv
+C:/VulkanSDK/1.3.236.0/Bin/glslc.exe light_cluster.comp -o bin/light_cluster_comp.spv
+C:/VulkanSDK/1.3.236.0/Bin/glslc.exe particle_update.comp -o bin/particle_update_comp.spv
+C:/VulkanSDK/1.3.236.0/Bin/glslc.exe particle.vert -o bin/particle_vert.spv
+C:/VulkanSDK/1.3.236.0/Bin/glslc.exe particle.frag -o bin/particle_frag.spv
+C:/VulkanSDK/1.3.236.0/Bin/glslc.exe skinning.comp -o bin/skinning_comp.spv
 pause
\ No newline at end of file
@@ -1,8 +1,72 @@
 #version 450
 
+// untextured variants only use the vertex colors, the branch is folded per pipeline
+layout(constant_id = 0) const bool TEXTURED = true;
+
+struct Light {
+    vec4 positionRadius;  // view space
+    vec4 colorIntensity;
+};
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+    vec4 clusterScale;  // clusters per pixel in xy, the slice is log(view depth) * z + w
+    uvec4 clusterGrid;
+    vec4 ambient;
+} ubo;
+
+layout(binding = 1) uniform sampler2D texSampler;
+
+layout(binding = 2, std430) readonly buffer Lights {
+    Light lights[];
+};
+
+// offset and count of every cluster's lights in the index list, from light_cluster.comp
+layout(binding = 3, std430) readonly buffer Clusters {
+    uvec2 clusters[];
+};
+
+layout(binding = 4, std430) readonly buffer LightIndices {
+    uint lightIndices[];
+};
+
 layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) in vec3 fragViewPosition;
+layout(location = 3) in vec3 fragViewNormal;
+
 layout(location = 0) out vec4 outColor;
 
+uint getClusterIndex() {
+    uvec2 tile = min(uvec2(gl_FragCoord.xy * ubo.clusterScale.xy), ubo.clusterGrid.xy - 1u);
+    float slice = log(-fragViewPosition.z) * ubo.clusterScale.z + ubo.clusterScale.w;
+    uint z = uint(clamp(slice, 0.0, float(ubo.clusterGrid.z - 1u)));
+    return tile.x + ubo.clusterGrid.x * (tile.y + ubo.clusterGrid.y * z);
+}
+
 void main() {
-    outColor = vec4(fragColor, 1.0);
+    vec3 normal = normalize(fragViewNormal);
+    vec3 lighting = ubo.ambient.rgb;
+
+    // only the lights reaching the fragment's cluster
+    uvec2 cluster = clusters[getClusterIndex()];
+    for (uint i = 0; i < cluster.y; i++) {
+        Light light = lights[lightIndices[cluster.x + i]];
+        vec3 toLight = light.positionRadius.xyz - fragViewPosition;
+        float distanceSquared = max(dot(toLight, toLight), 1e-6);
+
+        // inverse square falloff windowed to reach zero at the radius
+        float ratio = distanceSquared / (light.positionRadius.w * light.positionRadius.w);
+        float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+        float attenuation = window * window / (distanceSquared + 1.0);
+
+        float diffuse = max(dot(normal, toLight * inversesqrt(distanceSquared)), 0.0);
+        lighting += light.colorIntensity.rgb * (light.colorIntensity.w * attenuation * diffuse);
+    }
+
+    outColor = vec4(fragColor * lighting, 1.0);
+    if (TEXTURED) {
+        outColor *= texture(texSampler, fragTexCoord);
+    }
 }
\ No newline at end of file
@@ -1,17 +1,40 @@
 #version 450
 
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 proj;
+    vec4 clusterScale;
+    uvec4 clusterGrid;
+    vec4 ambient;
 } ubo;
 
-layout(location = 0) in vec2 inPosition;
-layout(location = 1) in vec3 inColor;
+layout(push_constant) uniform DrawConstants {
+    vec4 positionOffset;
+    vec4 positionScale;
+    vec4 uvTransform;
+} draw;
+
+// quantized, position and uv are normalized to the mesh bounds
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec3 inColor;
+
+// per instance, from the instance buffer
+layout(location = 4) in mat4 inModel;
 
 layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) out vec3 fragViewPosition;
+layout(location = 3) out vec3 fragViewNormal;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 0.0, 1.0);
+    vec3 position = draw.positionOffset.xyz + inPosition * draw.positionScale.xyz;
+    mat4 modelView = ubo.view * inModel;
+    vec4 viewPosition = modelView * vec4(position, 1.0);
+    gl_Position = ubo.proj * viewPosition;
+    fragViewPosition = viewPosition.xyz;
+    fragViewNormal = mat3(modelView) * inNormal;  // scaled uniformly, normalized per fragment
     fragColor = inColor;
+    fragTexCoord = draw.uvTransform.xy + inTexCoord * draw.uvTransform.zw;
 }
\ No newline at end of file
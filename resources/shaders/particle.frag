@@ -0,0 +1,13 @@
+#version 450
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragCorner;
+
+layout(location = 0) out vec4 outColor;
+
+// a soft disc, premultiplied for additive blending so the particles need no sorting
+void main() {
+    float falloff = max(1.0 - dot(fragCorner, fragCorner), 0.0);
+    float alpha = fragColor.a * falloff * falloff;
+    outColor = vec4(fragColor.rgb * alpha, alpha);
+}
\ No newline at end of file
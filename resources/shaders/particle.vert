@@ -0,0 +1,43 @@
+#version 450
+
+// a camera facing quad per living particle, drawn without vertex buffers
+
+struct Particle {
+    vec4 positionAge;
+    vec4 velocityLifetime;
+    vec4 color;
+};
+
+layout(push_constant) uniform ParticleDrawConstants {
+    mat4 viewProjection;
+    vec4 cameraRight;  // world space, w is the particle size
+    vec4 cameraUp;
+    uint aliveOffset;  // of the list the simulation compacted into
+} draw;
+
+layout(binding = 0, std430) readonly buffer Particles {
+    Particle particles[];
+};
+
+layout(binding = 1, std430) readonly buffer AliveLists {
+    uint alive[];
+};
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragCorner;
+
+const vec2 CORNERS[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                               vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main() {
+    Particle particle = particles[alive[draw.aliveOffset + gl_InstanceIndex]];
+    vec2 corner = CORNERS[gl_VertexIndex];
+
+    vec3 offset = draw.cameraRight.xyz * corner.x + draw.cameraUp.xyz * corner.y;
+    gl_Position = draw.viewProjection * vec4(particle.positionAge.xyz + offset * draw.cameraRight.w, 1.0);
+
+    // fades out over its lifetime
+    float fade = 1.0 - particle.positionAge.w / particle.velocityLifetime.w;
+    fragColor = vec4(particle.color.rgb, particle.color.a * fade);
+    fragCorner = corner;
+}
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "resource/asset_pack_format.h"
+
+// packs every file below a resource directory into a single asset pack.
+// usage: asset_packer <resource directory> <output pack>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct PackedFile {
+    std::string name;  // relative to the resource directory, forward slashes
+    fs::path path;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+bool _isPacked(const fs::path& relative) {
+    // transcoded textures are machine specific, shader sources and build scripts are not loaded at runtime
+    if (*relative.begin() == "cache") {
+        return false;
+    }
+
+    std::string extension = relative.extension().string();
+    for (const char* skipped : {".pak", ".bat", ".sh", ".vert", ".frag", ".comp"}) {
+        if (extension == skipped) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void _pad(std::ofstream& file, uint64_t& position, uint64_t alignment) {
+    static const char zeros[eng::ASSET_PACK_ALIGNMENT] = {};
+    uint64_t padding = (alignment - position % alignment) % alignment;
+    file.write(zeros, static_cast<std::streamsize>(padding));
+    position += padding;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: asset_packer <resource directory> <output pack>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    fs::path root = argv[1];
+    fs::path output = argv[2];
+
+    std::vector<PackedFile> files;
+    for (const auto& entry : fs::recursive_directory_iterator(root)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+
+        fs::path relative = fs::relative(entry.path(), root);
+        if (_isPacked(relative)) {
+            files.push_back({.name = relative.generic_string(), .path = entry.path()});
+        }
+    }
+
+    // sorted by hash so the runtime can binary search the table without building an index
+    std::sort(files.begin(), files.end(), [](const PackedFile& a, const PackedFile& b) {
+        return eng::hashAssetName(a.name) < eng::hashAssetName(b.name);
+    });
+
+    std::ofstream pack(output, std::ios::binary | std::ios::trunc);
+    if (!pack.is_open()) {
+        std::cerr << "failed to open " << output << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    eng::AssetPackHeader header{};
+    pack.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t position = sizeof(header);
+
+    std::vector<char> buffer;
+    for (PackedFile& file : files) {
+        std::ifstream input(file.path, std::ios::binary | std::ios::ate);
+        if (!input.is_open()) {
+            std::cerr << "failed to read " << file.path << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        buffer.resize(static_cast<size_t>(input.tellg()));
+        input.seekg(0);
+        input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+        _pad(pack, position, eng::ASSET_PACK_ALIGNMENT);
+        file.offset = position;
+        file.size = buffer.size();
+        pack.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        position += buffer.size();
+    }
+
+    _pad(pack, position, alignof(eng::AssetPackEntry));
+    header.entriesOffset = position;
+
+    uint32_t nameOffset = 0;
+    for (const PackedFile& file : files) {
+        eng::AssetPackEntry entry{
+            .nameHash = eng::hashAssetName(file.name),
+            .nameOffset = nameOffset,
+            .nameLength = static_cast<uint32_t>(file.name.size()),
+            .offset = file.offset,
+            .size = file.size};
+        pack.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        nameOffset += entry.nameLength;
+    }
+    position += files.size() * sizeof(eng::AssetPackEntry);
+
+    header.namesOffset = position;
+    for (const PackedFile& file : files) {
+        pack.write(file.name.data(), static_cast<std::streamsize>(file.name.size()));
+    }
+
+    header.magic = eng::ASSET_PACK_MAGIC;
+    header.version = eng::ASSET_PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>(files.size());
+    pack.seekp(0);
+    pack.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (!pack) {
+        std::cerr << "failed to write " << output << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "packed " << files.size() << " files into " << output << std::endl;
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
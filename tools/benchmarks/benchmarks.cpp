@@ -0,0 +1,50 @@
+#include <cstring>
+#include "benchmarks.h"
+
+// runs cpu benchmarks of the engine's systems and logs the results.
+// usage: engine_benchmarks [name...], every benchmark without names
+
+namespace {
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+constexpr Benchmark BENCHMARKS[] = {
+    {"mesh", [] { eng::benchmarkVertexFormats(); }},
+    {"transform", [] { eng::benchmarkTransforms(); }},
+    {"culling", eng::benchmarkCulling},
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        auto found = std::find_if(std::begin(BENCHMARKS), std::end(BENCHMARKS), [&](const Benchmark& benchmark) {
+            return strcmp(benchmark.name, argv[i]) == 0;
+        });
+        if (found == std::end(BENCHMARKS)) {
+            std::cerr << "unknown benchmark " << argv[i] << ", available:";
+            for (const Benchmark& benchmark : BENCHMARKS) {
+                std::cerr << " " << benchmark.name;
+            }
+            std::cerr << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        for (const Benchmark& benchmark : BENCHMARKS) {
+            bool isSelected = argc == 1 || std::any_of(argv + 1, argv + argc, [&](const char* name) { return strcmp(benchmark.name, name) == 0; });
+            if (isSelected) {
+                benchmark.run();
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
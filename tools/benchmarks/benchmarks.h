@@ -0,0 +1,15 @@
+#pragma once
+
+#include "shared.h"
+
+namespace eng {
+
+// streams a synthetic mesh of vertexCount vertices in both layouts and logs the
+// error and the throughput of each, the cpu stand-in for the vertex fetch cost
+void benchmarkVertexFormats(uint32_t vertexCount = 1 << 20);
+// times a full and a sparse update of transformCount nodes and logs the results
+void benchmarkTransforms(uint32_t transformCount = 100000);
+// culls random scenes of growing size with the bvh and with a linear scan, logs both
+void benchmarkCulling();
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+#include "benchmarks.h"
+#include "scene/culling_system.h"
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t BENCHMARK_CULLS = 50;
+constexpr float BENCHMARK_WORLD_SIZE = 1000.0f;
+
+}  // namespace
+
+void benchmarkCulling() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(0.0f, BENCHMARK_WORLD_SIZE);
+    std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+    // standing in the middle of the world looking along x, like a player in an open level
+    glm::vec3 eye(BENCHMARK_WORLD_SIZE * 0.5f);
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, BENCHMARK_WORLD_SIZE * 0.25f);
+    glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    Frustum frustum = Frustum::fromMatrix(projection * view);
+
+    std::cout << "culling benchmark:" << std::endl;
+    for (uint32_t objectCount : {10000u, 100000u, 1000000u}) {
+        std::vector<Aabb> bounds(objectCount);
+        for (Aabb& box : bounds) {
+            glm::vec3 center(position(random), position(random), position(random));
+            glm::vec3 halfExtent(size(random));
+            box = {center - halfExtent, center + halfExtent};
+        }
+
+        auto buildStart = std::chrono::high_resolution_clock::now();
+        Bvh bvh;
+        bvh.build(bounds);
+        auto buildEnd = std::chrono::high_resolution_clock::now();
+
+        std::vector<uint32_t> visible;
+        visible.reserve(objectCount);
+        auto bvhStart = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < BENCHMARK_CULLS; i++) {
+            visible.clear();
+            bvh.cull(frustum, visible);
+        }
+        auto bvhEnd = std::chrono::high_resolution_clock::now();
+        size_t bvhVisible = visible.size();
+
+        auto linearStart = std::chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < BENCHMARK_CULLS; i++) {
+            visible.clear();
+            for (uint32_t object = 0; object < objectCount; object++) {
+                if (frustum.intersects(bounds[object])) {
+                    visible.push_back(object);
+                }
+            }
+        }
+        auto linearEnd = std::chrono::high_resolution_clock::now();
+
+        float bvhMilliseconds = std::chrono::duration<float, std::milli>(bvhEnd - bvhStart).count() / BENCHMARK_CULLS;
+        float linearMilliseconds = std::chrono::duration<float, std::milli>(linearEnd - linearStart).count() / BENCHMARK_CULLS;
+        std::cout << "    " << objectCount << " objects, " << bvhVisible << " visible: bvh " << bvhMilliseconds << " ms ("
+                  << bvh.getNodeCount() << " nodes, built in " << std::chrono::duration<float, std::milli>(buildEnd - buildStart).count()
+                  << " ms), linear " << linearMilliseconds << " ms (" << visible.size() << " visible)" << std::endl;
+    }
+}
+
+}  // namespace eng
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include <numbers>
+#include "benchmarks.h"
+#include "geometry/mesh_encoder.h"
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t BENCHMARK_PASSES = 16;
+
+Mesh _makeBenchmarkMesh(uint32_t vertexCount) {
+    // a uv sphere, so the normals are meaningful and the positions span all three axes
+    uint32_t rings = std::max(2u, static_cast<uint32_t>(std::sqrt(static_cast<float>(vertexCount))));
+    uint32_t segments = std::max(3u, vertexCount / rings);
+
+    Mesh mesh;
+    mesh.vertices.reserve(rings * segments);
+    for (uint32_t ring = 0; ring < rings; ring++) {
+        float v = static_cast<float>(ring) / (rings - 1);
+        float theta = v * std::numbers::pi_v<float>;
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            float u = static_cast<float>(segment) / segments;
+            float phi = u * 2.0f * std::numbers::pi_v<float>;
+
+            glm::vec3 normal(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+            mesh.vertices.push_back({normal * 2.5f, normal, glm::vec2(u, v), glm::vec4(u, v, 1.0f - u, 1.0f)});
+        }
+    }
+    return mesh;
+}
+
+template <typename Vertex, typename Fetch>
+double _measureThroughput(const std::vector<Vertex>& vertices, Fetch fetch) {
+    float sum = 0.0f;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t pass = 0; pass < BENCHMARK_PASSES; pass++) {
+        for (const Vertex& vertex : vertices) {
+            sum += fetch(vertex);
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // keeps the loop from being optimized away
+    volatile float sink = sum;
+    (void)sink;
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return static_cast<double>(vertices.size()) * BENCHMARK_PASSES / seconds;
+}
+
+}  // namespace
+
+void benchmarkVertexFormats(uint32_t vertexCount) {
+    Mesh mesh = _makeBenchmarkMesh(vertexCount);
+    EncodedMesh encoded = encodeMesh(mesh);
+    reportEncoding(mesh, encoded);
+
+    // reads every attribute like a vertex shader would, decoding the packed one on the way
+    double floatRate = _measureThroughput(mesh.vertices, [](const MeshVertex& vertex) {
+        return vertex.position.x + vertex.normal.y + vertex.uv.x + vertex.color.z;
+    });
+    const MeshDequantization& dequantization = encoded.dequantization;
+    double encodedRate = _measureThroughput(encoded.vertices, [&](const EncodedVertex& vertex) {
+        return dequantization.positionOffset.x + vertex.get<0>().get(0) * dequantization.positionScale.x +
+               vertex.get<1>().get(1) +
+               dequantization.uvTransform.x + vertex.get<2>().get(0) * dequantization.uvTransform.z +
+               vertex.get<3>().get(2);
+    });
+
+    auto report = [](const char* name, double rate, size_t stride) {
+        std::cout << "    " << name << ": " << rate / 1e6 << " Mvertices/s, "
+                  << rate * stride / 1e9 << " GB/s at " << stride << " bytes/vertex" << std::endl;
+    };
+    std::cout << "vertex throughput over " << mesh.vertices.size() << " vertices:" << std::endl;
+    report("float", floatRate, sizeof(MeshVertex));
+    report("encoded", encodedRate, sizeof(EncodedVertex));
+}
+
+}  // namespace eng
\ No newline at end of file
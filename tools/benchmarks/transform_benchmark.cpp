@@ -0,0 +1,53 @@
+#include "benchmarks.h"
+#include "scene/transform_system.h"
+
+namespace eng {
+
+namespace {
+
+constexpr uint32_t BENCHMARK_UPDATES = 20;
+constexpr uint32_t BENCHMARK_CHILDREN = 99;  // per root, a shallow hierarchy like a crowd of props
+
+}  // namespace
+
+void benchmarkTransforms(uint32_t transformCount) {
+    TransformSystem transforms(transformCount);
+    TransformHandle root = NO_PARENT;
+    for (uint32_t i = 0; i < transformCount; i++) {
+        glm::vec3 position(static_cast<float>(i % 100), static_cast<float>(i / 100 % 100), static_cast<float>(i / 10000));
+        if (i % (BENCHMARK_CHILDREN + 1) == 0) {
+            root = transforms.create(NO_PARENT, position);
+        } else {
+            transforms.create(root, position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(0.5f));
+        }
+    }
+    transforms.update();
+
+    auto measure = [&](uint32_t first, uint32_t stride) {
+        size_t updated = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t u = 0; u < BENCHMARK_UPDATES; u++) {
+            for (uint32_t node = first; node < transformCount; node += stride) {
+                transforms.setRotation(node, glm::quat(std::cos(u * 0.01f), 0.0f, 0.0f, std::sin(u * 0.01f)));
+            }
+            updated += transforms.update().size();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        float milliseconds = std::chrono::duration<float, std::milli>(end - start).count() / BENCHMARK_UPDATES;
+        std::cout << "    " << updated / BENCHMARK_UPDATES << " dirty: " << milliseconds << " ms per update, "
+                  << updated / BENCHMARK_UPDATES / milliseconds / 1000.0f << " M transforms/s" << std::endl;
+    };
+
+    // the condition transform_system.cpp picks its sse path with
+    std::cout << "transform update over " << transformCount << " nodes"
+#if defined(__SSE2__) || defined(_M_X64)
+              << " (sse)"
+#endif
+              << ":" << std::endl;
+    measure(0, 1);    // everything
+    measure(1, 10);   // every tenth child, roots are skipped
+    measure(1, 997);  // a handful of children
+}
+
+}  // namespace eng
\ No newline at end of file